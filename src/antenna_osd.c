@@ -1,4 +1,9 @@
 /*
+ * antenna_osd.c  (v3.2 — 2026-08-28)
+ * - inotify-driven telemetry invalidation with cached glob resolution
+ *   (procfs/sysfs sources emit no inotify events and stay polled)
+ * - Skip rewriting the OSD file when the rendered frame is unchanged
+ *
  * antenna_osd.c  (v3.1 — 2025-08-20)
  * - Remove embedded HTTP server and ICMP ping helpers
  * - Retain periodic OSD rendering with smoothed RSSI values
@@ -19,7 +24,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <linux/magic.h>
+#include <sys/inotify.h>
 #include <sys/stat.h>
+#include <sys/vfs.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -33,6 +41,19 @@ static time_t last_info_attempt[MAX_INFO_SOURCES]={0,0};
 static bool info_buf_valid[MAX_INFO_SOURCES]={false,false};
 static double rssi_hist[3]={-1.0,-1.0,-1.0}, rssi2_hist[3]={-1.0,-1.0,-1.0};
 
+/* Resolved glob path + inotify watch per source. procfs/sysfs generate no
+ * inotify events, so those sources fall back to re-reading every tick
+ * (info_pollonly); everything else is only re-read after a change event. */
+static int inotify_fd=-1;
+static char *info_path[MAX_INFO_SOURCES]={NULL,NULL};
+static int info_watch[MAX_INFO_SOURCES]={-1,-1};
+static bool info_dirty[MAX_INFO_SOURCES]={true,true};
+static bool info_pollonly[MAX_INFO_SOURCES]={false,false};
+
+/* last rendered OSD frame; write_osd() skips the rewrite when it is unchanged */
+static char prev_filebuf[2048];
+static int prev_flen=-1;
+
 #define DEF_CFG_FILE        "/etc/antenna_osd.conf"
 #define DEF_INFO_FILE       "/proc/net/*8*/wlan0/trx_info_debug"
 #define DEF_OUT_FILE        "/tmp/MSPOSD.msg"
@@ -122,6 +143,18 @@ static volatile sig_atomic_t reload_requested = 0;
 static volatile sig_atomic_t osd_paused = 0;
 static const char *config_path = DEF_CFG_FILE;
 
+static void drop_info_path(int idx)
+{
+    if (info_watch[idx] >= 0) {
+        inotify_rm_watch(inotify_fd, info_watch[idx]);
+        info_watch[idx] = -1;
+    }
+    free(info_path[idx]);
+    info_path[idx] = NULL;
+    info_dirty[idx] = true;
+    info_pollonly[idx] = false;
+}
+
 static void reset_info_buffers(void)
 {
     for (int i = 0; i < MAX_INFO_SOURCES; ++i) {
@@ -130,6 +163,7 @@ static void reset_info_buffers(void)
         info_size[i] = 0;
         info_buf_valid[i] = false;
         last_info_attempt[i] = 0;
+        drop_info_path(i);
     }
 }
 
@@ -184,6 +218,7 @@ static void clear_osd_output(void)
     fflush(fp);
     fsync(fileno(fp));
     fclose(fp);
+    prev_flen = -1;
 }
 
 static void set_cfg_string(const char **field, const char *value, const char *default_value)
@@ -316,17 +351,63 @@ static double get_display_rssi2(double raw){
     return last_valid_rssi2;
 }
 
-static FILE *fopen_glob_first(const char *pattern,const char *mode){
-    if(!strpbrk(pattern,"*?[]")) return fopen(pattern,mode);
+static char *resolve_glob_first(const char *pattern){
+    if(!strpbrk(pattern,"*?[]")) return strdup(pattern);
     glob_t g; if(glob(pattern,GLOB_NOSORT,NULL,&g)!=0||g.gl_pathc==0){globfree(&g); return NULL;}
-    FILE *fp=fopen(g.gl_pathv[0],mode); globfree(&g); return fp;
+    char *path=strdup(g.gl_pathv[0]); globfree(&g); return path;
+}
+
+/* Resolve the glob once and keep the path until the file goes away; arm an
+ * inotify watch unless the file lives on a pseudo-fs that never fires one. */
+static const char *info_source_path(int idx){
+    if(info_path[idx]) return info_path[idx];
+    info_path[idx]=resolve_glob_first(cfg.info_files[idx]);
+    if(!info_path[idx]) return NULL;
+    info_dirty[idx]=true;
+    info_pollonly[idx]=false;
+    struct statfs sfs;
+    if(statfs(info_path[idx],&sfs)==0&&
+       (sfs.f_type==PROC_SUPER_MAGIC||sfs.f_type==SYSFS_MAGIC||sfs.f_type==DEBUGFS_MAGIC)){
+        info_pollonly[idx]=true;
+    } else if(inotify_fd>=0){
+        info_watch[idx]=inotify_add_watch(inotify_fd,info_path[idx],
+                                          IN_MODIFY|IN_CLOSE_WRITE|IN_ATTRIB|
+                                          IN_DELETE_SELF|IN_MOVE_SELF);
+        if(info_watch[idx]<0) info_pollonly[idx]=true;
+    } else {
+        info_pollonly[idx]=true;
+    }
+    return info_path[idx];
+}
+
+static void drain_inotify(void){
+    if(inotify_fd<0) return;
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    while((n=read(inotify_fd,buf,sizeof(buf)))>0){
+        for(ssize_t off=0;off<n;){
+            const struct inotify_event *ev=(const struct inotify_event *)(buf+off);
+            for(int i=0;i<MAX_INFO_SOURCES;++i){
+                if(info_watch[i]!=ev->wd) continue;
+                info_dirty[i]=true;
+                if(ev->mask&(IN_DELETE_SELF|IN_MOVE_SELF|IN_IGNORED)){
+                    if(ev->mask&IN_IGNORED) info_watch[i]=-1;
+                    drop_info_path(i);
+                    info_buf_valid[i]=false;
+                }
+            }
+            off+=(ssize_t)(sizeof(struct inotify_event)+ev->len);
+        }
+    }
 }
 
 static bool load_info_buffer(int idx){
     if(idx < 0 || idx >= MAX_INFO_SOURCES) return false;
-    const char *path = cfg.info_files[idx];
+    if(!cfg.info_files[idx]) return false;
+    const char *path = info_source_path(idx);
     if(!path) return false;
-    FILE *fp=fopen_glob_first(path,"r"); if(!fp) return false;
+    FILE *fp=fopen(path,"r");
+    if(!fp){ drop_info_path(idx); return false; }
     free(info_buf[idx]); info_buf[idx]=NULL; info_size[idx]=0;
     size_t cap=0; char tmp[256];
     while(fgets(tmp,sizeof(tmp),fp)){
@@ -345,7 +426,9 @@ static bool load_info_buffer(int idx){
         if(!info_buf[idx]){fclose(fp); return false;}
         info_size[idx]=0;
     }
-    fclose(fp); return true;
+    fclose(fp);
+    info_dirty[idx]=false;
+    return true;
 }
 
 static double parse_double_from_buf(const char *buf,const char *key){
@@ -478,6 +561,9 @@ static void write_osd(double rssi,double rssi2,const char *mcs_str,const char *b
         }
     }
     if(cfg.system_msg[0]) flen+=snprintf(filebuf+flen,sizeof(filebuf)-flen,"%s%s\n",cfg.sys_msg_hdr,cfg.system_msg);
+    /* unchanged frame: skip the rewrite so downstream mtime watchers stay idle */
+    if(flen==prev_flen&&memcmp(filebuf,prev_filebuf,(size_t)flen)==0) return;
+    memcpy(prev_filebuf,filebuf,(size_t)flen); prev_flen=flen;
     FILE *fp=fopen(cfg.out_file,"w"); if(fp){fwrite(filebuf,1,flen,fp); fclose(fp);}    
 }
 
@@ -510,6 +596,8 @@ int main(int argc, char **argv){
     sigaction(SIGHUP, &sa, NULL);
     sigaction(SIGUSR1, &sa, NULL);
 
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
     reset_config_defaults();
     load_config(config_path);
     reset_info_buffers();
@@ -563,6 +651,7 @@ int main(int argc, char **argv){
         while (next_osd_ms <= t_now_ms) next_osd_ms += osd_period_ms;
 
         read_system_msg();
+        drain_inotify();
         time_t now_sec = time(NULL);
 
         bool have_info[MAX_INFO_SOURCES]={false,false};
@@ -570,7 +659,9 @@ int main(int argc, char **argv){
         for(int i=0;i<MAX_INFO_SOURCES;++i){
             if(!cfg.info_files[i]) continue;
             if(info_buf_valid[i]){
-                if(load_info_buffer(i)){
+                if(!info_pollonly[i] && !info_dirty[i]){
+                    have_info[i]=true;  /* watched and unchanged: reuse cached buffer */
+                } else if(load_info_buffer(i)){
                     last_info_attempt[i]=now_sec;
                     have_info[i]=true;
                 } else {
@@ -15,18 +15,22 @@ strip autod
 #include <time.h>
 #include <errno.h>
 #include <ctype.h>
+#include <stdatomic.h>
 #include <unistd.h>
 #include <signal.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/stat.h>
 #include <sys/resource.h>
+#include <sys/sendfile.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <limits.h>
 #ifndef PATH_MAX
 #define PATH_MAX 4096
 #endif
 #include <strings.h>
+#include <dirent.h>
 #include <poll.h>
 #include <ifaddrs.h>
 #include <sys/socket.h>
@@ -37,6 +41,10 @@ strip autod
 #include "civetweb.h"
 #include "parson.h"
 #include "autod.h"
+#include "exec_pool.h"
+#include "http_pool.h"
+#include "metrics.h"
+#include "resolver.h"
 
 #if !defined(_WIN32)
 extern char *realpath(const char *path, char *resolved_path);
@@ -74,11 +82,16 @@ static void cfg_defaults(config_t *c) {
     c->port = 8080;
     strncpy(c->bind_addr, "0.0.0.0", sizeof(c->bind_addr)-1);
     c->enable_scan = 0;
+    c->http_threads = 6;
     c->extra_subnet_count = 0;
+    c->scan_announce = 0;
+    c->scan_announce_port = SCAN_ANNOUNCE_PORT;
+    c->scan_announce_interval_s = 5;
 
     strncpy(c->interpreter, "/usr/bin/exec-handler.sh", sizeof(c->interpreter)-1);
     c->exec_timeout_ms = 5000;
     c->max_output_bytes = 65536;
+    c->exec_pool_size = 2;
 
     c->include_net_info = 1;
     c->sse_count = 0;
@@ -91,6 +104,7 @@ static void cfg_defaults(config_t *c) {
     sync_cfg_defaults(c);
 }
 
+#ifndef AUTOD_NO_FILESHARE
 static int cfg_has_cap(const config_t *cfg, const char *cap) {
     if (!cfg || !cap || !*cap || !cfg->caps[0]) return 0;
     char tmp[sizeof(cfg->caps)];
@@ -103,6 +117,7 @@ static int cfg_has_cap(const config_t *cfg, const char *cap) {
     }
     return 0;
 }
+#endif /* AUTOD_NO_FILESHARE */
 
 static int parse_extra_subnet(const char *value, scan_extra_subnet_t *out) {
     if (!value || !*value || !out) return -1;
@@ -152,11 +167,28 @@ static int parse_ini(const char *path, config_t *cfg) {
             if (!strcmp(k,"port")) cfg->port=atoi(v);
             else if (!strcmp(k,"bind")) strncpy(cfg->bind_addr,v,sizeof(cfg->bind_addr)-1);
             else if (!strcmp(k,"enable_scan")) cfg->enable_scan=atoi(v);
+            else if (!strcmp(k,"http_threads")) cfg->http_threads=atoi(v);
 
         } else if (strcmp(sect,"exec")==0) {
             if (!strcmp(k,"interpreter")) strncpy(cfg->interpreter,v,sizeof(cfg->interpreter)-1);
             else if (!strcmp(k,"timeout_ms")) cfg->exec_timeout_ms=atoi(v);
             else if (!strcmp(k,"max_output_bytes")) cfg->max_output_bytes=atoi(v);
+            else if (!strcmp(k,"pool_size")) cfg->exec_pool_size=atoi(v);
+            else if (!strcmp(k,"cache")) {
+                // cache = /sys/foo/get:1000  (path:ttl_ms, opt-in per command)
+                char *colon = strrchr(v, ':');
+                int ttl = colon ? atoi(colon + 1) : 0;
+                if (colon && ttl > 0 && cfg->exec_cache_rule_count < EXEC_CACHE_MAX_RULES) {
+                    *colon = '\0';
+                    trim(v);
+                    int idx = cfg->exec_cache_rule_count++;
+                    strncpy(cfg->exec_cache_rules[idx].path, v,
+                            sizeof(cfg->exec_cache_rules[idx].path)-1);
+                    cfg->exec_cache_rules[idx].ttl_ms = ttl;
+                } else {
+                    fprintf(stderr, "WARN: ignoring invalid exec cache rule '%s'\n", v);
+                }
+            }
 
         } else if (strcmp(sect,"caps")==0) {
             if (!strcmp(k,"device"))  strncpy(cfg->device,v,sizeof(cfg->device)-1);
@@ -191,6 +223,14 @@ static int parse_ini(const char *path, config_t *cfg) {
                 }
             } else if (!strcmp(k,"extra_subnet") || !strcmp(k,"subnet")) {
                 fprintf(stderr, "WARN: extra_subnet capacity reached (%u)\n", SCAN_MAX_EXTRA_SUBNETS);
+            } else if (!strcmp(k,"announce")) {
+                cfg->scan_announce = atoi(v);
+            } else if (!strcmp(k,"announce_port")) {
+                cfg->scan_announce_port = atoi(v);
+            } else if (!strcmp(k,"announce_interval_s")) {
+                cfg->scan_announce_interval_s = atoi(v);
+            } else if (!strcmp(k,"cache_file")) {
+                strncpy(cfg->scan_cache_file, v, sizeof(cfg->scan_cache_file)-1);
             }
 
         } else if (strcmp(sect,"ui")==0) {
@@ -387,7 +427,7 @@ static void drain_exec_pipes(int out_fd, int err_fd,
     drain_exec_pipe(err_fd, buf_err, werr, max_bytes);
 }
 
-int run_exec(const config_t *cfg, const char *path, JSON_Array *args,
+static int run_exec_direct(const config_t *cfg, const char *path, JSON_Array *args,
                     int timeout_ms, int max_bytes,
                     int *rc_out, long long *elapsed_ms,
                     char **out_stdout, char **out_stderr)
@@ -521,19 +561,50 @@ fail_before_fork:
     return -1;
 }
 
+int run_exec(const config_t *cfg, const char *path, JSON_Array *args,
+             int timeout_ms, int max_bytes,
+             int *rc_out, long long *elapsed_ms,
+             char **out_stdout, char **out_stderr)
+{
+    long long t0 = metrics_now_us();
+    // Steady state goes through the pre-spawned worker pool; the direct
+    // fork path remains as fallback when the pool is off or saturated.
+    int r = exec_pool_run(path, args, timeout_ms, max_bytes,
+                          rc_out, elapsed_ms, out_stdout, out_stderr);
+    if (r > 0) {
+        r = run_exec_direct(cfg, path, args, timeout_ms, max_bytes,
+                            rc_out, elapsed_ms, out_stdout, out_stderr);
+    }
+    metrics_record_exec(metrics_now_us() - t0);
+    return r < 0 ? -1 : 0;
+}
+
 /* ----------------------- CivetWeb helpers ----------------------- */
 
 static const char *reason_phrase_for_status(int code) {
     switch (code) {
     case 200: return "OK";
     case 202: return "Accepted";
+    case 206: return "Partial Content";
+    case 304: return "Not Modified";
     case 400: return "Bad Request";
     case 404: return "Not Found";
+    case 416: return "Range Not Satisfiable";
     case 500: return "Internal Server Error";
     default:  return NULL;
     }
 }
 
+/* All framed responses may stay on a keep-alive connection (the server runs
+   with enable_keep_alive); honor the client's preference in the header. */
+static int conn_wants_keep_alive(struct mg_connection *c) {
+    const char *h = mg_get_header(c, "Connection");
+    if (h && strcasecmp(h, "close") == 0) return 0;
+    const struct mg_request_info *ri = mg_get_request_info(c);
+    if (ri && ri->http_version && strcmp(ri->http_version, "1.1") == 0) return 1;
+    return (h && strcasecmp(h, "keep-alive") == 0);
+}
+
 static void add_common_headers_extra(struct mg_connection *c, int code, const char *ctype,
                                      size_t clen, int cors_public, const char *extra) {
     const char *reason = reason_phrase_for_status(code);
@@ -552,7 +623,8 @@ static void add_common_headers_extra(struct mg_connection *c, int code, const ch
         mg_printf(c, "%s", extra);
     }
     mg_printf(c, "Cache-Control: no-store\r\n");
-    mg_printf(c, "Connection: close\r\n\r\n");
+    mg_printf(c, "Connection: %s\r\n\r\n",
+              conn_wants_keep_alive(c) ? "keep-alive" : "close");
 }
 
 static void add_common_headers(struct mg_connection *c, int code, const char *ctype,
@@ -568,7 +640,8 @@ static void add_cors_options(struct mg_connection *c) {
       "Access-Control-Allow-Headers: Content-Type\r\n"
       "Access-Control-Max-Age: 600\r\n"
       "Content-Length: 0\r\n"
-      "Connection: close\r\n\r\n");
+      "Connection: %s\r\n\r\n",
+      conn_wants_keep_alive(c) ? "keep-alive" : "close");
 }
 
 static int h_options_all(struct mg_connection *c, void *ud) {
@@ -577,6 +650,7 @@ static int h_options_all(struct mg_connection *c, void *ud) {
     return 1;
 }
 
+#if !defined(AUTOD_NO_UI) || !defined(AUTOD_NO_FILESHARE)
 static const char *guess_mime_type(const char *path) {
     if (!path) return "application/octet-stream";
     const char *dot = strrchr(path, '.');
@@ -611,6 +685,7 @@ static const char *guess_mime_type(const char *path) {
     }
     return "application/octet-stream";
 }
+#endif /* !AUTOD_NO_UI || !AUTOD_NO_FILESHARE */
 
 int read_body(struct mg_connection *c, upload_t *u) {
     u->body = NULL;
@@ -637,12 +712,77 @@ int read_body(struct mg_connection *c, upload_t *u) {
     return 0;
 }
 
+/* Streaming JSON responses: json_serialization_size() counts the body without
+   allocating, then json_serialize_to_sink() streams tokens through a small
+   stack buffer, so response memory stays O(buffer) instead of O(document).
+   The status line and headers are placed in the same buffer so the first
+   mg_write carries headers plus the leading body chunk in one syscall. */
+
+enum { JSON_STREAM_BUF = 2048 };
+
+typedef struct {
+    struct mg_connection *c;
+    char buf[JSON_STREAM_BUF];
+    size_t len;
+    int failed;
+} json_stream_t;
+
+static int json_stream_flush(json_stream_t *js) {
+    if (js->failed) return -1;
+    if (js->len == 0) return 0;
+    if (mg_write(js->c, js->buf, (int)js->len) != (int)js->len) {
+        js->failed = 1;
+        return -1;
+    }
+    js->len = 0;
+    return 0;
+}
+
+static int json_stream_sink(const char *data, size_t len, void *ud) {
+    json_stream_t *js = (json_stream_t *)ud;
+    if (js->failed) return -1;
+    while (len > 0) {
+        size_t space = sizeof(js->buf) - js->len;
+        if (space == 0) {
+            if (json_stream_flush(js) != 0) return -1;
+            space = sizeof(js->buf);
+        }
+        size_t n = len < space ? len : space;
+        memcpy(js->buf + js->len, data, n);
+        js->len += n;
+        data += n;
+        len -= n;
+    }
+    return 0;
+}
+
 void send_json(struct mg_connection *c, JSON_Value *v, int code, int cors_public) {
-    char *s = json_serialize_to_string(v);
-    size_t n = s ? strlen(s) : 0;
-    add_common_headers(c, code, "application/json; charset=utf-8", n, cors_public);
-    if (n) mg_write(c, s, (int)n);
-    if (s) json_free_serialized_string(s);
+    size_t n = json_serialization_size(v); // includes the NUL terminator
+    if (n == 0) {
+        send_plain(c, 500, "serialize_failed", cors_public);
+        return;
+    }
+    n -= 1;
+
+    json_stream_t js = { .c = c, .len = 0, .failed = 0 };
+    const char *reason = reason_phrase_for_status(code);
+    int hl = snprintf(js.buf, sizeof(js.buf),
+                      "HTTP/1.1 %d%s%s\r\n"
+                      "Content-Type: application/json; charset=utf-8\r\n"
+                      "Content-Length: %zu\r\n"
+                      "%s"
+                      "Cache-Control: no-store\r\n"
+                      "Connection: %s\r\n\r\n",
+                      code, reason ? " " : "", reason ? reason : "",
+                      n,
+                      cors_public ? "Access-Control-Allow-Origin: *\r\nVary: Origin\r\n" : "",
+                      conn_wants_keep_alive(c) ? "keep-alive" : "close");
+    if (hl < 0 || (size_t)hl >= sizeof(js.buf)) return;
+    js.len = (size_t)hl;
+
+    if (json_serialize_to_sink(v, json_stream_sink, &js) == JSONSuccess) {
+        json_stream_flush(&js);
+    }
 }
 
 void send_plain(struct mg_connection *c, int code, const char *msg, int cors_public) {
@@ -652,6 +792,7 @@ void send_plain(struct mg_connection *c, int code, const char *msg, int cors_pub
     if (n) mg_write(c, text, (int)n);
 }
 
+#if !defined(AUTOD_NO_UI) || !defined(AUTOD_NO_FILESHARE)
 static int format_http_date(time_t when, char *buf, size_t buf_sz) {
     if (!buf || buf_sz == 0) return -1;
 #if defined(_WIN32)
@@ -663,6 +804,287 @@ static int format_http_date(time_t when, char *buf, size_t buf_sz) {
 #endif
     return strftime(buf, buf_sz, "%a, %d %b %Y %H:%M:%S GMT", &tmp) ? 0 : -1;
 }
+#endif /* !AUTOD_NO_UI || !AUTOD_NO_FILESHARE */
+
+/* ----------------------- Serialized response cache ----------------------- */
+/* /caps and /nodes are polled at ~1 Hz by every open UI, and both documents
+   are expensive to rebuild (getifaddrs, /proc reads, full node table walk).
+   The serialized byte blobs are cached and revalidated with cheap generation
+   counters — scan_table_generation() for /nodes, active_override_generation
+   plus the wall-clock second for /caps (whose runtime fields tick once per
+   second anyway). ETags derived from the same counters let clients polling
+   faster than the rebuild cadence get 304s with zero serialization work. */
+
+static int client_matches_etag(struct mg_connection *c, const char *etag) {
+    const char *inm = mg_get_header(c, "If-None-Match");
+    return inm && strcmp(inm, etag) == 0;
+}
+
+static void send_json_not_modified(struct mg_connection *c, const char *etag, int cors_public) {
+    char extra[96];
+    snprintf(extra, sizeof(extra), "ETag: %s\r\n", etag);
+    add_common_headers_extra(c, 304, "application/json; charset=utf-8", 0, cors_public, extra);
+}
+
+static void send_json_blob(struct mg_connection *c, const char *body, size_t len,
+                           const char *etag, int cors_public) {
+    char extra[96];
+    snprintf(extra, sizeof(extra), "ETag: %s\r\n", etag);
+    add_common_headers_extra(c, 200, "application/json; charset=utf-8", len, cors_public, extra);
+    if (len) mg_write(c, body, (int)len);
+}
+
+static pthread_mutex_t g_nodes_blob_mx = PTHREAD_MUTEX_INITIALIZER;
+static char    *g_nodes_blob;
+static size_t   g_nodes_blob_len;
+static unsigned g_nodes_blob_gen;
+static int      g_nodes_blob_valid;
+
+// Returns a malloc'd copy of the cached /nodes body for `gen`, or NULL.
+static char *nodes_blob_lookup(unsigned gen, size_t *len_out) {
+    char *copy = NULL;
+    pthread_mutex_lock(&g_nodes_blob_mx);
+    if (g_nodes_blob_valid && g_nodes_blob_gen == gen && g_nodes_blob) {
+        copy = (char *)malloc(g_nodes_blob_len + 1);
+        if (copy) {
+            memcpy(copy, g_nodes_blob, g_nodes_blob_len + 1);
+            *len_out = g_nodes_blob_len;
+        }
+    }
+    pthread_mutex_unlock(&g_nodes_blob_mx);
+    return copy;
+}
+
+static void nodes_blob_store(unsigned gen, const char *body, size_t len) {
+    char *copy = (char *)malloc(len + 1);
+    if (!copy) return;
+    memcpy(copy, body, len + 1);
+    pthread_mutex_lock(&g_nodes_blob_mx);
+    free(g_nodes_blob);
+    g_nodes_blob       = copy;
+    g_nodes_blob_len   = len;
+    g_nodes_blob_gen   = gen;
+    g_nodes_blob_valid = 1;
+    pthread_mutex_unlock(&g_nodes_blob_mx);
+}
+
+/* /caps output depends on the request Host header (IP placeholders in SSE
+   URLs), so the cache holds one blob per recently seen host. */
+enum { CAPS_BLOB_SLOTS = 4 };
+
+typedef struct {
+    char      host[128];
+    int       generation;
+    long long ts;          // wall-clock second the blob was built for
+    char     *body;
+    size_t    len;
+    long long used_ms;
+} caps_blob_t;
+
+static caps_blob_t g_caps_blobs[CAPS_BLOB_SLOTS];
+static pthread_mutex_t g_caps_blob_mx = PTHREAD_MUTEX_INITIALIZER;
+
+static char *caps_blob_lookup(const char *host, int generation, long long ts, size_t *len_out) {
+    char *copy = NULL;
+    pthread_mutex_lock(&g_caps_blob_mx);
+    for (int i = 0; i < CAPS_BLOB_SLOTS; i++) {
+        caps_blob_t *e = &g_caps_blobs[i];
+        if (e->body && e->generation == generation && e->ts == ts &&
+            strcmp(e->host, host) == 0) {
+            copy = (char *)malloc(e->len + 1);
+            if (copy) {
+                memcpy(copy, e->body, e->len + 1);
+                *len_out = e->len;
+                e->used_ms = now_ms();
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_caps_blob_mx);
+    return copy;
+}
+
+static void caps_blob_store(const char *host, int generation, long long ts,
+                            const char *body, size_t len) {
+    if (strlen(host) >= sizeof(g_caps_blobs[0].host)) return;
+    char *copy = (char *)malloc(len + 1);
+    if (!copy) return;
+    memcpy(copy, body, len + 1);
+    pthread_mutex_lock(&g_caps_blob_mx);
+    caps_blob_t *victim = &g_caps_blobs[0];
+    for (int i = 0; i < CAPS_BLOB_SLOTS; i++) {
+        caps_blob_t *e = &g_caps_blobs[i];
+        if (e->body && strcmp(e->host, host) == 0) { victim = e; break; }
+        if (!e->body) { victim = e; break; }
+        if (e->used_ms < victim->used_ms) victim = e;
+    }
+    free(victim->body);
+    snprintf(victim->host, sizeof(victim->host), "%s", host);
+    victim->generation = generation;
+    victim->ts         = ts;
+    victim->body       = copy;
+    victim->len        = len;
+    victim->used_ms    = now_ms();
+    pthread_mutex_unlock(&g_caps_blob_mx);
+}
+
+/* ----------------------- Request arena ----------------------- */
+/* Per-request bump allocator behind parson's allocation hooks. Handlers
+   activate the arena for the duration of one request; every JSON DOM node
+   and serialized string parson allocates comes from per-thread blocks that
+   are reset in one go when the response is done, instead of hundreds of
+   malloc/free pairs per request. Only handlers that never let a parson
+   value outlive the request may activate it (sync handlers persist parsed
+   values in master/slave state and stay on the heap path). */
+
+enum { ARENA_BLOCK_SIZE = 32 * 1024 };
+
+typedef struct arena_block {
+    struct arena_block *next;
+    size_t used;
+    size_t cap;
+    // payload follows
+} arena_block_t;
+
+static _Thread_local arena_block_t *t_arena_blocks; // retained across requests
+static _Thread_local int t_arena_active;
+
+static void *arena_alloc(size_t sz) {
+    sz = (sz + 15u) & ~(size_t)15u;
+    for (arena_block_t *b = t_arena_blocks; b; b = b->next) {
+        if (b->cap - b->used >= sz) {
+            void *p = (char *)(b + 1) + b->used;
+            b->used += sz;
+            return p;
+        }
+    }
+    size_t cap = sz > ARENA_BLOCK_SIZE ? sz : ARENA_BLOCK_SIZE;
+    arena_block_t *b = (arena_block_t *)malloc(sizeof(*b) + cap);
+    if (!b) return NULL;
+    b->cap = cap;
+    b->used = sz;
+    b->next = t_arena_blocks;
+    t_arena_blocks = b;
+    return (char *)(b + 1);
+}
+
+static int arena_owns(const void *p) {
+    for (arena_block_t *b = t_arena_blocks; b; b = b->next) {
+        const char *base = (const char *)(b + 1);
+        if ((const char *)p >= base && (const char *)p < base + b->cap) return 1;
+    }
+    return 0;
+}
+
+static void request_arena_begin(void) {
+    t_arena_active = 1;
+}
+
+/* Route parson through the heap for a stretch of an arena-active request.
+   Needed where allocations are per-chunk rather than per-request (streaming
+   /exec): the arena never reuses memory until request_arena_end, so feeding
+   it an unbounded chunk loop would grow a worker thread by the whole stream.
+   Frees stay safe either way — parson_free_hook checks arena_owns(). */
+static int request_arena_suspend(void) {
+    int was = t_arena_active;
+    t_arena_active = 0;
+    return was;
+}
+
+static void request_arena_resume(int was) {
+    t_arena_active = was;
+}
+
+enum { ARENA_KEEP_BLOCKS = 4 }; // per-thread high-water cap, 128 KiB
+
+static void request_arena_end(void) {
+    t_arena_active = 0;
+    /* Reset a few normal blocks for the next request; release oversized
+       ones and anything past the cap so one fat request can't pin its
+       high-water mark in the worker thread forever. */
+    int kept = 0;
+    arena_block_t **pp = &t_arena_blocks;
+    while (*pp) {
+        arena_block_t *b = *pp;
+        if (b->cap > ARENA_BLOCK_SIZE || kept >= ARENA_KEEP_BLOCKS) {
+            *pp = b->next;
+            free(b);
+        } else {
+            b->used = 0;
+            kept++;
+            pp = &b->next;
+        }
+    }
+}
+
+static void *parson_alloc_hook(size_t sz) {
+    if (t_arena_active) return arena_alloc(sz);
+    return malloc(sz);
+}
+
+static void parson_free_hook(void *p) {
+    if (!p || arena_owns(p)) return; // arena memory dies with the request
+    free(p);
+}
+
+/* ----------------------- Config snapshots ----------------------- */
+/* RCU-style published config: rebuilds copy the merged config into a slot
+   from a type-stable pool and swap an atomic pointer; request handlers
+   acquire the current snapshot with an atomic load + refcount bump instead
+   of taking cfg_lock and memcpy'ing several KB per request. Slots are
+   never freed, only recycled once their refcount drops to zero, which is
+   what makes the speculative acquire below safe against republishing. */
+
+enum { CFG_SNAP_SLOTS = 16 };
+
+typedef struct {
+    _Atomic int refs; // 0 = free; the published snapshot holds one ref
+    config_t    cfg;
+} config_snap_t;
+
+static config_snap_t g_cfg_snaps[CFG_SNAP_SLOTS];
+static _Atomic(config_snap_t *) g_cfg_current;
+
+const config_t *app_config_acquire(app_t *app) {
+    (void)app;
+    for (;;) {
+        config_snap_t *s = atomic_load(&g_cfg_current);
+        if (!s) return NULL; // nothing published yet (startup only)
+        atomic_fetch_add(&s->refs, 1);
+        if (s == atomic_load(&g_cfg_current)) return &s->cfg;
+        // lost a race with a republish; drop the speculative ref and retry
+        atomic_fetch_sub(&s->refs, 1);
+    }
+}
+
+void app_config_release(const config_t *cfg) {
+    if (!cfg) return;
+    config_snap_t *s = (config_snap_t *)((const char *)cfg - offsetof(config_snap_t, cfg));
+    atomic_fetch_sub(&s->refs, 1);
+}
+
+/* Publish app->cfg as the new current snapshot. Called with cfg_lock held
+   (writers stay serialized; only readers are lock-free). */
+static void app_config_publish_locked(app_t *app) {
+    config_snap_t *slot = NULL;
+    for (int tries = 0; tries < 1000 && !slot; tries++) {
+        for (int i = 0; i < CFG_SNAP_SLOTS; i++) {
+            int expect = 0;
+            if (atomic_compare_exchange_strong(&g_cfg_snaps[i].refs, &expect, 1)) {
+                slot = &g_cfg_snaps[i];
+                break;
+            }
+        }
+        if (!slot) { // all slots pinned by in-flight handlers; they're brief
+            struct timespec ts = {0, 1000000};
+            nanosleep(&ts, NULL);
+        }
+    }
+    if (!slot) return; // keep serving the previous snapshot
+    slot->cfg = app->cfg;
+    config_snap_t *old = atomic_exchange(&g_cfg_current, slot);
+    if (old) atomic_fetch_sub(&old->refs, 1); // drop the publisher ref
+}
 
 /* ----------------------- HTTP Handlers ----------------------- */
 void app_rebuild_config_locked(app_t *app) {
@@ -670,15 +1092,57 @@ void app_rebuild_config_locked(app_t *app) {
     config_t merged = app->base_cfg;
     sync_ensure_id(&merged);
     app->cfg = merged;
+    app_config_publish_locked(app);
 }
 
 void app_config_snapshot(app_t *app, config_t *out) {
     if (!app || !out) return;
+    const config_t *cfg = app_config_acquire(app);
+    if (cfg) {
+        *out = *cfg;
+        app_config_release(cfg);
+        return;
+    }
     pthread_mutex_lock(&app->cfg_lock);
     *out = app->cfg;
     pthread_mutex_unlock(&app->cfg_lock);
 }
 
+typedef struct {
+    const config_t *cfg;
+    int index; // 1-based position, for log output
+    const char *path;
+    JSON_Array *args;
+} startup_exec_job_t;
+
+static void *startup_exec_job(void *arg) {
+    startup_exec_job_t *job = arg;
+    char *out = NULL;
+    char *err = NULL;
+    int rc = 0;
+    long long elapsed = 0;
+    int r = run_exec(job->cfg, job->path, job->args, job->cfg->exec_timeout_ms,
+                     job->cfg->max_output_bytes, &rc, &elapsed, &out, &err);
+    if (r == 0) {
+        fprintf(stderr,
+                "startup exec[%d]: %s rc=%d elapsed=%lldms\n",
+                job->index, job->path, rc, elapsed);
+        if (out && *out) {
+            fprintf(stderr, "  stdout: %s\n", out);
+        }
+        if (err && *err) {
+            fprintf(stderr, "  stderr: %s\n", err);
+        }
+    } else {
+        fprintf(stderr,
+                "startup exec[%d]: failed to run %s\n",
+                job->index, job->path);
+    }
+    if (out) free(out);
+    if (err) free(err);
+    return NULL;
+}
+
 static void run_startup_exec_sequence(app_t *app) {
     if (!app) return;
 
@@ -689,6 +1153,14 @@ static void run_startup_exec_sequence(app_t *app) {
     fprintf(stderr, "running %d startup exec command(s)\n",
             cfg.startup_exec_count);
 
+    // Parse every payload up front so staging is known before dispatch.
+    struct {
+        JSON_Value *cmd;
+        int stage; // -1 = none declared (runs alone, waterfall style)
+        startup_exec_job_t job;
+    } entries[STARTUP_MAX_EXEC];
+    int n = 0;
+
     for (int i = 0; i < cfg.startup_exec_count; i++) {
         const char *raw = cfg.startup_exec[i].json;
         if (!raw[0]) continue;
@@ -704,7 +1176,6 @@ static void run_startup_exec_sequence(app_t *app) {
 
         JSON_Object *obj = json_object(cmd);
         const char *path = json_object_get_string(obj, "path");
-        JSON_Array *args = json_object_get_array(obj, "args");
         if (!path || !*path) {
             fprintf(stderr,
                     "startup exec[%d]: missing path in payload '%s'\n",
@@ -713,30 +1184,55 @@ static void run_startup_exec_sequence(app_t *app) {
             continue;
         }
 
-        char *out = NULL;
-        char *err = NULL;
-        int rc = 0;
-        long long elapsed = 0;
-        int r = run_exec(&cfg, path, args, cfg.exec_timeout_ms,
-                         cfg.max_output_bytes, &rc, &elapsed, &out, &err);
-        if (r == 0) {
+        entries[n].cmd = cmd;
+        entries[n].stage = -1;
+        JSON_Value *stage_v = json_object_get_value(obj, "stage");
+        if (stage_v && json_value_get_type(stage_v) == JSONNumber) {
+            double d = json_value_get_number(stage_v);
+            if (d >= 0) entries[n].stage = (int)d;
+        }
+        entries[n].job.cfg = &cfg;
+        entries[n].job.index = i + 1;
+        entries[n].job.path = path;
+        entries[n].job.args = json_object_get_array(obj, "args");
+        n++;
+    }
+
+    // Consecutive entries declaring the same stage form one concurrent batch;
+    // each batch (and every undeclared entry) still waits for its
+    // predecessors, so boot time approaches the longest chain instead of the
+    // sum of all commands.
+    for (int b = 0; b < n; ) {
+        int e = b + 1;
+        if (entries[b].stage >= 0) {
+            while (e < n && entries[e].stage == entries[b].stage) e++;
+        }
+        int cnt = e - b;
+        if (cnt == 1) {
+            startup_exec_job(&entries[b].job);
+        } else {
             fprintf(stderr,
-                    "startup exec[%d]: %s rc=%d elapsed=%lldms\n",
-                    i + 1, path, rc, elapsed);
-            if (out && *out) {
-                fprintf(stderr, "  stdout: %s\n", out);
+                    "startup exec: stage %d dispatching %d command(s) in parallel\n",
+                    entries[b].stage, cnt);
+            pthread_t tids[STARTUP_MAX_EXEC];
+            unsigned char threaded[STARTUP_MAX_EXEC] = {0};
+            for (int k = 0; k < cnt; k++) {
+                if (pthread_create(&tids[k], NULL, startup_exec_job,
+                                   &entries[b + k].job) == 0) {
+                    threaded[k] = 1;
+                } else {
+                    startup_exec_job(&entries[b + k].job);
+                }
             }
-            if (err && *err) {
-                fprintf(stderr, "  stderr: %s\n", err);
+            for (int k = 0; k < cnt; k++) {
+                if (threaded[k]) pthread_join(tids[k], NULL);
             }
-        } else {
-            fprintf(stderr,
-                    "startup exec[%d]: failed to run %s\n",
-                    i + 1, path);
         }
-        if (out) free(out);
-        if (err) free(err);
-        json_value_free(cmd);
+        b = e;
+    }
+
+    for (int k = 0; k < n; k++) {
+        json_value_free(entries[k].cmd);
     }
 }
 
@@ -750,6 +1246,339 @@ static int h_health(struct mg_connection *c, void *ud){
     return 1;
 }
 
+static int h_metrics(struct mg_connection *c, void *ud){
+    (void)ud;
+    JSON_Value *v = metrics_build_json();
+    send_json(c, v, 200, 1);
+    json_value_free(v);
+    return 1;
+}
+
+/* ----------------------- metered handler dispatch ----------------------- */
+// Every main route goes through this shim so /metrics can report per-endpoint
+// request counts and latency percentiles. The shim only reads a monotonic
+// clock twice and bumps the calling thread's private counters.
+typedef struct {
+    mg_request_handler fn;
+    void *ud;
+    int metric_id;
+} metered_route_t;
+
+static metered_route_t METERED_ROUTES[METRICS_MAX_ENDPOINTS];
+static int METERED_ROUTE_COUNT = 0;
+
+static int h_metered(struct mg_connection *c, void *ud) {
+    metered_route_t *r = ud;
+    long long t0 = metrics_now_us();
+    int ret = r->fn(c, r->ud);
+    metrics_record_endpoint(r->metric_id, metrics_now_us() - t0);
+    return ret;
+}
+
+static void set_metered_handler(struct mg_context *ctx, const char *uri,
+                                mg_request_handler fn, void *ud) {
+    int id = -1;
+    if (METERED_ROUTE_COUNT < METRICS_MAX_ENDPOINTS) {
+        id = metrics_endpoint_register(uri);
+    }
+    if (id < 0) {
+        mg_set_request_handler(ctx, uri, fn, ud);
+        return;
+    }
+    metered_route_t *r = &METERED_ROUTES[METERED_ROUTE_COUNT++];
+    r->fn = fn;
+    r->ud = ud;
+    r->metric_id = id;
+    mg_set_request_handler(ctx, uri, h_metered, r);
+}
+
+/* ----------------------- UI asset cache ----------------------- */
+#ifndef AUTOD_NO_UI
+/* In-memory copy of the serve_ui tree (same idea as udp_relay's UI_BUF):
+   assets are loaded at startup and kept in RAM, revalidated by mtime with
+   a single stat() per request, and a precompressed "<file>.gz" sibling is
+   served to clients that send Accept-Encoding: gzip. Only stream_file()
+   (i.e. h_root) consults the cache; media/firmware stay on sendfile(). */
+
+enum { UI_CACHE_SLOTS = 64 };
+#define UI_CACHE_MAX_ASSET (4 * 1024 * 1024)
+
+typedef struct {
+    char    path[PATH_MAX]; // "" = free slot
+    time_t  mtime;
+    off_t   size;
+    char   *buf;
+    size_t  len;
+    char   *gz;     // contents of "<path>.gz" if present and not stale
+    size_t  gz_len;
+} ui_asset_t;
+
+static ui_asset_t g_ui_cache[UI_CACHE_SLOTS];
+static pthread_mutex_t g_ui_cache_mx = PTHREAD_MUTEX_INITIALIZER;
+
+static int read_file_mem(const char *path, size_t max_len, char **buf, size_t *len) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        st.st_size < 0 || (size_t)st.st_size > max_len) {
+        close(fd);
+        return -1;
+    }
+    char *b = (char *)malloc((size_t)st.st_size ? (size_t)st.st_size : 1);
+    if (!b) { close(fd); return -1; }
+    size_t got = 0;
+    while (got < (size_t)st.st_size) {
+        ssize_t r = read(fd, b + got, (size_t)st.st_size - got);
+        if (r <= 0) break;
+        got += (size_t)r;
+    }
+    close(fd);
+    if (got != (size_t)st.st_size) { free(b); return -1; }
+    *buf = b;
+    *len = got;
+    return 0;
+}
+
+/* (Re)load one asset into the slot; picks up a fresh "<path>.gz" sibling
+   when one exists. Called with g_ui_cache_mx held. */
+static int ui_cache_load_locked(ui_asset_t *e, const char *path, const struct stat *st) {
+    char *buf = NULL;
+    size_t len = 0;
+    if (read_file_mem(path, UI_CACHE_MAX_ASSET, &buf, &len) != 0) return -1;
+    free(e->buf);
+    free(e->gz);
+    e->buf = buf;
+    e->len = len;
+    e->gz = NULL;
+    e->gz_len = 0;
+    snprintf(e->path, sizeof(e->path), "%s", path);
+    e->mtime = st->st_mtime;
+    e->size = st->st_size;
+
+    char gz_path[PATH_MAX];
+    struct stat gst;
+    if (snprintf(gz_path, sizeof(gz_path), "%s.gz", path) < (int)sizeof(gz_path) &&
+        stat(gz_path, &gst) == 0 && S_ISREG(gst.st_mode) &&
+        gst.st_mtime >= st->st_mtime) {
+        (void)read_file_mem(gz_path, UI_CACHE_MAX_ASSET, &e->gz, &e->gz_len);
+    }
+    return 0;
+}
+
+/* Serve `path` from the cache: validates by mtime (reloading when the file
+   changed), and hands back a private copy of the body so reloads can't pull
+   the buffer out from under a slow client. Returns 1 with *body malloc'd,
+   0 to fall back to the on-disk path. */
+static int ui_cache_fetch(const char *path, int want_gzip,
+                          char **body, size_t *body_len, int *is_gzip, time_t *mtime) {
+    struct stat st;
+    if (stat(path, &st) != 0 || !S_ISREG(st.st_mode) ||
+        st.st_size > (off_t)UI_CACHE_MAX_ASSET) {
+        return 0;
+    }
+
+    int served = 0;
+    pthread_mutex_lock(&g_ui_cache_mx);
+    ui_asset_t *e = NULL, *free_slot = NULL;
+    for (int i = 0; i < UI_CACHE_SLOTS; i++) {
+        if (!g_ui_cache[i].path[0]) {
+            if (!free_slot) free_slot = &g_ui_cache[i];
+            continue;
+        }
+        if (strcmp(g_ui_cache[i].path, path) == 0) { e = &g_ui_cache[i]; break; }
+    }
+    if (!e) e = free_slot;
+    if (e) {
+        int fresh = e->path[0] && e->mtime == st.st_mtime && e->size == st.st_size;
+        if (fresh || ui_cache_load_locked(e, path, &st) == 0) {
+            const char *src = (want_gzip && e->gz) ? e->gz : e->buf;
+            size_t src_len = (want_gzip && e->gz) ? e->gz_len : e->len;
+            char *copy = (char *)malloc(src_len ? src_len : 1);
+            if (copy) {
+                memcpy(copy, src, src_len);
+                *body = copy;
+                *body_len = src_len;
+                *is_gzip = (src == e->gz);
+                *mtime = e->mtime;
+                served = 1;
+            }
+        }
+    }
+    pthread_mutex_unlock(&g_ui_cache_mx);
+    return served;
+}
+
+/* Warm the cache at startup so first paint after boot also skips disk. */
+static void ui_cache_preload_dir(const char *dir, int depth) {
+    if (depth > 4) return;
+    DIR *d = opendir(dir);
+    if (!d) return;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        if (de->d_name[0] == '.') continue;
+        char path[PATH_MAX];
+        if (snprintf(path, sizeof(path), "%s/%s", dir, de->d_name) >=
+            (int)sizeof(path)) {
+            continue;
+        }
+        struct stat st;
+        if (stat(path, &st) != 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            ui_cache_preload_dir(path, depth + 1);
+            continue;
+        }
+        size_t n = strlen(path);
+        if (n > 3 && !strcmp(path + n - 3, ".gz")) continue; // loaded as sibling
+        char *body = NULL;
+        size_t blen = 0;
+        int gz = 0;
+        time_t mt = 0;
+        if (ui_cache_fetch(path, 0, &body, &blen, &gz, &mt)) free(body);
+    }
+    closedir(d);
+}
+
+static void ui_cache_preload(const char *ui_path) {
+    char *body = NULL;
+    size_t blen = 0;
+    int gz = 0;
+    time_t mt = 0;
+    if (ui_cache_fetch(ui_path, 0, &body, &blen, &gz, &mt)) free(body);
+
+    char dir[PATH_MAX];
+    strncpy(dir, ui_path, sizeof(dir) - 1);
+    dir[sizeof(dir) - 1] = '\0';
+    char *slash = strrchr(dir, '/');
+    if (!slash) return;
+    *slash = '\0';
+    ui_cache_preload_dir(dir[0] ? dir : "/", 0);
+}
+#endif /* AUTOD_NO_UI */
+
+#if !defined(AUTOD_NO_UI) || !defined(AUTOD_NO_FILESHARE)
+/* Parse a single-range "Range: bytes=..." header against a file of the given
+   size. Returns 0 to serve the full body (no/invalid/multi-range header),
+   1 with start/len set for a satisfiable range, -1 when unsatisfiable. */
+static int parse_range_header(const char *hdr, off_t size, off_t *start, off_t *len) {
+    if (!hdr || strncmp(hdr, "bytes=", 6) != 0 || size <= 0) return 0;
+    const char *spec = hdr + 6;
+    if (strchr(spec, ',')) return 0; // multi-range: fall back to full body
+    char *dash = strchr(spec, '-');
+    if (!dash) return 0;
+    if (spec == dash) {
+        // suffix form: last N bytes
+        char *end = NULL;
+        long long n = strtoll(dash + 1, &end, 10);
+        if (!end || *end || n <= 0) return 0;
+        if (n > size) n = size;
+        *start = size - (off_t)n;
+        *len = (off_t)n;
+        return 1;
+    }
+    char *end = NULL;
+    long long first = strtoll(spec, &end, 10);
+    if (end != dash || first < 0) return 0;
+    long long last = size - 1;
+    if (dash[1]) {
+        last = strtoll(dash + 1, &end, 10);
+        if (!end || *end || last < first) return 0;
+        if (last > size - 1) last = size - 1;
+    }
+    if (first >= size) return -1;
+    *start = (off_t)first;
+    *len = (off_t)(last - first + 1);
+    return 1;
+}
+
+/* Push `len` bytes of `fd` starting at `off`. Bulk transfers go through
+   sendfile() on the raw client socket (no userspace copy); if that is
+   unavailable, fall back to the pread/mg_write loop. */
+static void send_file_body(struct mg_connection *c, int fd, off_t off, off_t len) {
+    int sock = mg_get_client_socket(c);
+    while (len > 0) {
+        if (sock >= 0) {
+            size_t chunk = len > (off_t)(1 << 20) ? (size_t)(1 << 20) : (size_t)len;
+            ssize_t s = sendfile(sock, fd, &off, chunk);
+            if (s > 0) { len -= (off_t)s; continue; }
+            if (s < 0 && errno == EINTR) continue;
+            if (s < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                struct pollfd pf = { .fd = sock, .events = POLLOUT };
+                if (poll(&pf, 1, 10000) <= 0) break; // peer stalled: give up
+                continue;
+            }
+            if (s < 0 && (errno == EINVAL || errno == ENOSYS)) { sock = -1; continue; }
+            break;
+        }
+        char buf[64 * 1024];
+        size_t want = len < (off_t)sizeof(buf) ? (size_t)len : sizeof(buf);
+        ssize_t r = pread(fd, buf, want, off);
+        if (r <= 0) break;
+        if (mg_write(c, buf, (size_t)r) <= 0) break;
+        off += r;
+        len -= r;
+    }
+    if (len > 0) {
+        /* Body abandoned short of the advertised Content-Length: the
+           keep-alive framing is now desynced and the connection must not
+           carry another request. Kill the socket so CivetWeb drops it
+           instead of parsing the next request out of a broken stream.
+           (Re-fetch the fd: the sendfile fallback path clears `sock`.) */
+        int s = mg_get_client_socket(c);
+        if (s >= 0) shutdown(s, SHUT_RDWR);
+    }
+}
+
+/* Shared tail for plain-file responses once the fd is validated: emits
+   Last-Modified / Accept-Ranges, answers conditional GETs with 304 and
+   single-range requests with 206, then streams the body. Closes fd. */
+static int send_file_response(struct mg_connection *c, int fd, const struct stat *st,
+                              const char *ctype, int cors_public, int is_head) {
+    char extra[256];
+    size_t xw = 0;
+    extra[0] = '\0';
+    char http_date[64];
+    if (format_http_date(st->st_mtime, http_date, sizeof(http_date)) == 0) {
+        const char *ims = mg_get_header(c, "If-Modified-Since");
+        int n = snprintf(extra, sizeof(extra), "Last-Modified: %s\r\n", http_date);
+        xw = (n > 0 && n < (int)sizeof(extra)) ? (size_t)n : 0;
+        if (xw == 0) extra[0] = '\0';
+        if (ims && strcmp(ims, http_date) == 0) {
+            add_common_headers_extra(c, 304, ctype, 0, cors_public,
+                                     extra[0] ? extra : NULL);
+            close(fd);
+            return 1;
+        }
+    }
+    xw += (size_t)snprintf(extra + xw, sizeof(extra) - xw, "Accept-Ranges: bytes\r\n");
+
+    off_t off = 0, len = st->st_size;
+    int rr = parse_range_header(mg_get_header(c, "Range"), st->st_size, &off, &len);
+    if (rr < 0) {
+        snprintf(extra + xw, sizeof(extra) - xw,
+                 "Content-Range: bytes */%lld\r\n", (long long)st->st_size);
+        add_common_headers_extra(c, 416, ctype, 0, cors_public, extra);
+        close(fd);
+        return 1;
+    }
+    int code = 200;
+    if (rr > 0) {
+        code = 206;
+        snprintf(extra + xw, sizeof(extra) - xw,
+                 "Content-Range: bytes %lld-%lld/%lld\r\n",
+                 (long long)off, (long long)(off + len - 1), (long long)st->st_size);
+    }
+    add_common_headers_extra(c, code, ctype, (size_t)len, cors_public,
+                             extra[0] ? extra : NULL);
+    if (!is_head) {
+        send_file_body(c, fd, off, len);
+    }
+    close(fd);
+    return 1;
+}
+#endif /* !AUTOD_NO_UI || !AUTOD_NO_FILESHARE */
+
+#ifndef AUTOD_NO_UI
 static int stream_file(struct mg_connection *c, const char *path, int cors_public, int json_on_missing){
     const struct mg_request_info *ri = mg_get_request_info(c);
     const char *method = (ri && ri->request_method) ? ri->request_method : "";
@@ -759,6 +1588,38 @@ static int stream_file(struct mg_connection *c, const char *path, int cors_publi
         return 1;
     }
 
+    const char *ae = mg_get_header(c, "Accept-Encoding");
+    int want_gzip = (ae && strstr(ae, "gzip")) ? 1 : 0;
+    char *body = NULL;
+    size_t blen = 0;
+    int body_gz = 0;
+    time_t mt = 0;
+    if (ui_cache_fetch(path, want_gzip, &body, &blen, &body_gz, &mt)) {
+        const char *ctype = guess_mime_type(path);
+        char extra[256];
+        size_t xw = 0;
+        extra[0] = '\0';
+        char http_date[64];
+        if (format_http_date(mt, http_date, sizeof(http_date)) == 0) {
+            const char *ims = mg_get_header(c, "If-Modified-Since");
+            int n = snprintf(extra, sizeof(extra), "Last-Modified: %s\r\n", http_date);
+            xw = (n > 0 && n < (int)sizeof(extra)) ? (size_t)n : 0;
+            if (xw == 0) extra[0] = '\0';
+            if (ims && strcmp(ims, http_date) == 0) {
+                add_common_headers_extra(c, 304, ctype, 0, cors_public,
+                                         extra[0] ? extra : NULL);
+                free(body);
+                return 1;
+            }
+        }
+        snprintf(extra + xw, sizeof(extra) - xw, "Vary: Accept-Encoding\r\n%s",
+                 body_gz ? "Content-Encoding: gzip\r\n" : "");
+        add_common_headers_extra(c, 200, ctype, blen, cors_public, extra);
+        if (!is_head && blen) mg_write(c, body, (int)blen);
+        free(body);
+        return 1;
+    }
+
     int fd = open(path, O_RDONLY);
     if (fd < 0) {
         if (json_on_missing) {
@@ -779,34 +1640,11 @@ static int stream_file(struct mg_connection *c, const char *path, int cors_publi
         return 1;
     }
 
-    const char *ctype = guess_mime_type(path);
-    char extra[192];
-    extra[0] = '\0';
-    char http_date[64];
-    if (format_http_date(st.st_mtime, http_date, sizeof(http_date)) == 0) {
-        int n = snprintf(extra, sizeof(extra), "Last-Modified: %s\r\n", http_date);
-        if (n < 0 || n >= (int)sizeof(extra)) extra[0] = '\0';
-    }
-
-    add_common_headers_extra(c, 200, ctype, (size_t)st.st_size, cors_public,
-                             extra[0] ? extra : NULL);
-
-    if (is_head) {
-        close(fd);
-        return 1;
-    }
-
-    off_t off=0; char buf[64*1024];
-    while (off < st.st_size) {
-        ssize_t r = read(fd, buf, sizeof(buf));
-        if (r <= 0) break;
-        mg_write(c, buf, (size_t)r);
-        off += r;
-    }
-    close(fd);
-    return 1;
+    return send_file_response(c, fd, &st, guess_mime_type(path), cors_public, is_head);
 }
+#endif /* AUTOD_NO_UI */
 
+#ifndef AUTOD_NO_FILESHARE
 static int serve_file_share(struct mg_connection *c, const config_t *cfg,
                             const struct mg_request_info *ri,
                             const char *uri_prefix, const char *base_dir,
@@ -904,73 +1742,269 @@ static int serve_file_share(struct mg_connection *c, const config_t *cfg,
         return 1;
     }
 
-    const char *ctype = guess_mime_type(resolved);
-    char extra[192];
-    extra[0] = '\0';
-    char http_date[64];
-    if (format_http_date(st.st_mtime, http_date, sizeof(http_date)) == 0) {
-        int n = snprintf(extra, sizeof(extra), "Last-Modified: %s\r\n",
-                        http_date);
-        if (n < 0 || n >= (int)sizeof(extra)) extra[0] = '\0';
+    return send_file_response(c, fd, &st, guess_mime_type(resolved),
+                              cfg->ui_public, is_head);
+}
+
+static int h_media_impl(struct mg_connection *c, app_t *app, const config_t *cfg) {
+    (void)app;
+    if (!cfg_has_cap(cfg, "dvr")) {
+        send_plain(c, 404, "not_found", cfg->ui_public);
+        return 1;
     }
 
-    add_common_headers_extra(c, 200, ctype, (size_t)st.st_size, cfg->ui_public,
-                             extra[0] ? extra : NULL);
+    const struct mg_request_info *ri = mg_get_request_info(c);
+    if (!ri || !ri->request_method) return 0;
 
-    if (is_head) {
-        close(fd);
-        return 1;
+    return serve_file_share(c, cfg, ri, "/media/", cfg->media_dir,
+                            "DVR_MEDIA_DIR", "/media", "media_unavailable");
+}
+
+static int h_media(struct mg_connection *c, void *ud) {
+    app_t *app = (app_t *)ud;
+    const config_t *cfg = app_config_acquire(app);
+    if (!cfg) { send_plain(c, 500, "server_error", 1); return 1; }
+    request_arena_begin();
+    int r = h_media_impl(c, app, cfg);
+    request_arena_end();
+    app_config_release(cfg);
+    return r;
+}
+
+/* ----------------------- firmware distribution ----------------------- */
+/* Fleet update helper. GET /firmware/manifest?file=NAME describes an image
+   as fixed-size chunks with per-chunk CRC32s, so a node whose download was
+   interrupted re-fetches only the chunks it is missing (plain Range
+   requests against /firmware/NAME — the byte-serving path is unchanged),
+   and lists the scanned fleet nodes carrying the firmware capability as
+   alternate chunk sources, so twenty updaters can spread their Range
+   fetches across peers that already hold the image instead of all pulling
+   from one uplink. Building the manifest mmaps the image and reads it once
+   sequentially; that same pass warms the page cache, so every subsequent
+   client Range is served from memory rather than re-read from flash. The
+   manifest is cached keyed on (path, size, mtime) — update day means one
+   hashing pass, not one per node. CRC32 catches truncation and bitrot on
+   resume; image authenticity is the flasher's job (signed images), not
+   the transport's. */
+
+#define FW_CHUNK_SIZE (1024 * 1024)
+
+static struct {
+    char      path[PATH_MAX]; // "" = empty
+    off_t     size;
+    time_t    mtime;
+    int       chunk_count;
+    uint32_t *chunk_crc;
+} g_fw_manifest;
+static pthread_mutex_t g_fw_mx = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t g_crc32_tab[256];
+
+static uint32_t crc32_buf(uint32_t crc, const uint8_t *p, size_t len) {
+    if (!g_crc32_tab[1]) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t r = i;
+            for (int k = 0; k < 8; k++)
+                r = (r >> 1) ^ (0xEDB88320u & (0u - (r & 1u)));
+            g_crc32_tab[i] = r;
+        }
     }
+    crc = ~crc;
+    while (len--) crc = g_crc32_tab[(crc ^ *p++) & 0xFFu] ^ (crc >> 8);
+    return ~crc;
+}
 
-    off_t off = 0; char buf[64 * 1024];
-    while (off < st.st_size) {
-        ssize_t r = read(fd, buf, sizeof(buf));
-        if (r <= 0) break;
-        mg_write(c, buf, (size_t)r);
-        off += r;
+/* Resolve NAME against the firmware base dir with the same env override
+   and escape checks as the byte-serving path. 0 on success. */
+static int fw_resolve_path(const config_t *cfg, const char *name,
+                           char resolved[PATH_MAX]) {
+    const char *base = NULL;
+    const char *env_val = getenv("AUTOD_FIRMWARE_DIR");
+    if (env_val && *env_val) base = env_val;
+    if (!base || !*base) base = cfg->firmware_dir;
+    if (!base || !*base) base = "/usr/share/firmware";
+
+    char base_real[PATH_MAX];
+    if (!realpath(base, base_real)) return -1;
+
+    char joined[PATH_MAX];
+    if (snprintf(joined, sizeof(joined), "%s/%s", base_real, name) >=
+        (int)sizeof(joined)) return -1;
+    if (!realpath(joined, resolved)) return -1;
+
+    size_t base_len = strlen(base_real);
+    if (strncmp(resolved, base_real, base_len) != 0 ||
+        (resolved[base_len] != '\0' && resolved[base_len] != '/')) return -1;
+    return 0;
+}
+
+/* (Re)build the cached manifest for path if (size, mtime) moved. Called
+   with g_fw_mx held; a second manifest request for a changed image waits
+   out the hashing pass rather than racing it. 0 on success. */
+static int fw_manifest_refresh_locked(const char *path, const struct stat *st) {
+    if (g_fw_manifest.path[0] && strcmp(g_fw_manifest.path, path) == 0 &&
+        g_fw_manifest.size == st->st_size &&
+        g_fw_manifest.mtime == st->st_mtime) {
+        return 0; // warm
+    }
+
+    int chunks = (int)((st->st_size + FW_CHUNK_SIZE - 1) / FW_CHUNK_SIZE);
+    if (chunks < 1) chunks = 1; // empty file still gets one (zero-length) chunk
+    uint32_t *crcs = (uint32_t *)malloc((size_t)chunks * sizeof(uint32_t));
+    if (!crcs) return -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { free(crcs); return -1; }
+
+    uint8_t *map = NULL;
+    if (st->st_size > 0) {
+        map = (uint8_t *)mmap(NULL, (size_t)st->st_size, PROT_READ,
+                              MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) { close(fd); free(crcs); return -1; }
+        (void)posix_madvise(map, (size_t)st->st_size,
+                            POSIX_MADV_SEQUENTIAL);
     }
+
+    for (int i = 0; i < chunks; i++) {
+        off_t off = (off_t)i * FW_CHUNK_SIZE;
+        size_t n = (size_t)((st->st_size - off > FW_CHUNK_SIZE)
+                            ? FW_CHUNK_SIZE : st->st_size - off);
+        crcs[i] = crc32_buf(0, map ? map + off : NULL, n);
+    }
+
+    if (map) munmap(map, (size_t)st->st_size);
     close(fd);
-    return 1;
+
+    free(g_fw_manifest.chunk_crc);
+    snprintf(g_fw_manifest.path, sizeof(g_fw_manifest.path), "%s", path);
+    g_fw_manifest.size = st->st_size;
+    g_fw_manifest.mtime = st->st_mtime;
+    g_fw_manifest.chunk_count = chunks;
+    g_fw_manifest.chunk_crc = crcs;
+    return 0;
 }
 
-static int h_media(struct mg_connection *c, void *ud) {
-    app_t *app = (app_t *)ud;
-    config_t cfg; app_config_snapshot(app, &cfg);
-    if (!cfg_has_cap(&cfg, "dvr")) {
-        send_plain(c, 404, "not_found", cfg.ui_public);
+static int h_firmware_manifest(struct mg_connection *c, const config_t *cfg,
+                               const struct mg_request_info *ri) {
+    if (strcmp(ri->request_method, "GET") != 0) {
+        send_plain(c, 405, "method_not_allowed", cfg->ui_public);
         return 1;
     }
 
-    const struct mg_request_info *ri = mg_get_request_info(c);
-    if (!ri || !ri->request_method) return 0;
+    char name[256];
+    if (!ri->query_string ||
+        mg_get_var(ri->query_string, strlen(ri->query_string),
+                   "file", name, sizeof(name)) <= 0) {
+        JSON_Value *v = json_value_init_object();
+        json_object_set_string(json_object(v), "error", "missing_file");
+        send_json(c, v, 400, cfg->ui_public);
+        json_value_free(v);
+        return 1;
+    }
 
-    return serve_file_share(c, &cfg, ri, "/media/", cfg.media_dir,
-                            "DVR_MEDIA_DIR", "/media", "media_unavailable");
+    char resolved[PATH_MAX];
+    struct stat st;
+    if (fw_resolve_path(cfg, name, resolved) != 0 ||
+        stat(resolved, &st) != 0 || !S_ISREG(st.st_mode)) {
+        JSON_Value *v = json_value_init_object();
+        json_object_set_string(json_object(v), "error", "not_found");
+        send_json(c, v, 404, cfg->ui_public);
+        json_value_free(v);
+        return 1;
+    }
+
+    pthread_mutex_lock(&g_fw_mx);
+    if (fw_manifest_refresh_locked(resolved, &st) != 0) {
+        pthread_mutex_unlock(&g_fw_mx);
+        JSON_Value *v = json_value_init_object();
+        json_object_set_string(json_object(v), "error", "manifest_failed");
+        send_json(c, v, 500, cfg->ui_public);
+        json_value_free(v);
+        return 1;
+    }
+
+    JSON_Value *v = json_value_init_object();
+    JSON_Object *o = json_object(v);
+    json_object_set_string(o, "file", name);
+    json_object_set_number(o, "size", (double)g_fw_manifest.size);
+    json_object_set_number(o, "mtime", (double)g_fw_manifest.mtime);
+    json_object_set_number(o, "chunk_size", (double)FW_CHUNK_SIZE);
+    json_object_set_number(o, "chunk_count", (double)g_fw_manifest.chunk_count);
+    json_object_set_string(o, "algo", "crc32");
+
+    JSON_Value *chunks_v = json_value_init_array();
+    JSON_Array *chunks = json_array(chunks_v);
+    for (int i = 0; i < g_fw_manifest.chunk_count; i++) {
+        char hex[9];
+        snprintf(hex, sizeof(hex), "%08x", g_fw_manifest.chunk_crc[i]);
+        json_array_append_string(chunks, hex);
+    }
+    json_object_set_value(o, "chunks", chunks_v);
+    pthread_mutex_unlock(&g_fw_mx);
+
+    /* Candidate peer sources: every scanned fleet node. The scan table does
+       not track who holds which image, so the client confirms a peer by
+       fetching the peer's own manifest first and comparing size + chunks. */
+    JSON_Value *src_v = json_value_init_array();
+    JSON_Array *src = json_array(src_v);
+    int n = 0;
+    scan_node_t *nodes = scan_copy_nodes(&n);
+    for (int i = 0; nodes && i < n; i++) {
+        if (nodes[i].is_self) continue; // that's us; the client is already here
+        JSON_Value *nv = json_value_init_object();
+        JSON_Object *no = json_object(nv);
+        json_object_set_string(no, "ip", nodes[i].ip);
+        json_object_set_number(no, "port", (double)nodes[i].port);
+        if (nodes[i].device[0])
+            json_object_set_string(no, "device", nodes[i].device);
+        json_array_append_value(src, nv);
+    }
+    free(nodes);
+    json_object_set_value(o, "sources", src_v);
+
+    send_json(c, v, 200, cfg->ui_public);
+    json_value_free(v);
+    return 1;
 }
 
-static int h_firmware(struct mg_connection *c, void *ud) {
-    app_t *app = (app_t *)ud;
-    config_t cfg; app_config_snapshot(app, &cfg);
-    if (!cfg_has_cap(&cfg, "firmware")) {
-        send_plain(c, 404, "not_found", cfg.ui_public);
+static int h_firmware_impl(struct mg_connection *c, app_t *app, const config_t *cfg) {
+    (void)app;
+    if (!cfg_has_cap(cfg, "firmware")) {
+        send_plain(c, 404, "not_found", cfg->ui_public);
         return 1;
     }
 
     const struct mg_request_info *ri = mg_get_request_info(c);
     if (!ri || !ri->request_method) return 0;
 
-    return serve_file_share(c, &cfg, ri, "/firmware/", cfg.firmware_dir,
+    const char *uri = ri->local_uri ? ri->local_uri : ri->request_uri;
+    if (uri && strcmp(uri, "/firmware/manifest") == 0)
+        return h_firmware_manifest(c, cfg, ri);
+
+    return serve_file_share(c, cfg, ri, "/firmware/", cfg->firmware_dir,
                             "AUTOD_FIRMWARE_DIR", "/usr/share/firmware",
                             "firmware_unavailable");
 }
 
-static int h_root(struct mg_connection *c, void *ud){
-    app_t *app=(app_t*)ud;
-    config_t cfg; app_config_snapshot(app, &cfg);
-    if(!cfg.serve_ui || !cfg.ui_path[0]){
+static int h_firmware(struct mg_connection *c, void *ud) {
+    app_t *app = (app_t *)ud;
+    const config_t *cfg = app_config_acquire(app);
+    if (!cfg) { send_plain(c, 500, "server_error", 1); return 1; }
+    request_arena_begin();
+    int r = h_firmware_impl(c, app, cfg);
+    request_arena_end();
+    app_config_release(cfg);
+    return r;
+}
+#endif /* AUTOD_NO_FILESHARE */
+
+#ifndef AUTOD_NO_UI
+static int h_root_impl(struct mg_connection *c, app_t *app, const config_t *cfg) {
+    (void)app;
+    if(!cfg->serve_ui || !cfg->ui_path[0]){
         JSON_Value *v=json_value_init_object(); JSON_Object *o=json_object(v);
         json_object_set_string(o,"error","no_ui");
-        send_json(c, v, 404, cfg.ui_public);
+        send_json(c, v, 404, cfg->ui_public);
         json_value_free(v);
         return 1;
     }
@@ -979,7 +2013,7 @@ static int h_root(struct mg_connection *c, void *ud){
     const char *method = (ri && ri->request_method) ? ri->request_method : "";
     int is_head = (strcmp(method, "HEAD") == 0);
     if (!is_head && strcmp(method, "GET") != 0) {
-        send_plain(c, 405, "method_not_allowed", cfg.ui_public);
+        send_plain(c, 405, "method_not_allowed", cfg->ui_public);
         return 1;
     }
 
@@ -991,25 +2025,25 @@ static int h_root(struct mg_connection *c, void *ud){
     int dec = mg_url_decode(req_uri, (int)strlen(req_uri),
                             decoded_uri, (int)sizeof(decoded_uri), 0);
     if (dec <= 0 || dec >= (int)sizeof(decoded_uri)) {
-        send_plain(c, 400, "bad_request", cfg.ui_public);
+        send_plain(c, 400, "bad_request", cfg->ui_public);
         return 1;
     }
     decoded_uri[dec] = '\0';
     const char *uri = decoded_uri;
 
-    const char *basename = cfg.ui_path;
+    const char *basename = cfg->ui_path;
     const char *slash = strrchr(basename, '/');
     if (slash && slash[1]) basename = slash + 1;
 
     if (!strcmp(uri, "/") ||
         (basename && *basename && uri[0]=='/' && strcmp(uri + 1, basename) == 0)) {
-        return stream_file(c, cfg.ui_path, cfg.ui_public, 1);
+        return stream_file(c, cfg->ui_path, cfg->ui_public, 1);
     }
 
     const char *rel = uri;
     while (*rel == '/') rel++;
     if (!*rel) {
-        return stream_file(c, cfg.ui_path, cfg.ui_public, 1);
+        return stream_file(c, cfg->ui_path, cfg->ui_public, 1);
     }
 
     char rel_copy[PATH_MAX];
@@ -1022,13 +2056,13 @@ static int h_root(struct mg_connection *c, void *ud){
     char *save = NULL;
     for (char *tok = strtok_r(tmp, "/", &save); tok; tok = strtok_r(NULL, "/", &save)) {
         if (!strcmp(tok, "..")) {
-            send_plain(c, 403, "forbidden", cfg.ui_public);
+            send_plain(c, 403, "forbidden", cfg->ui_public);
             return 1;
         }
     }
 
     char base_dir[PATH_MAX];
-    strncpy(base_dir, cfg.ui_path, sizeof(base_dir) - 1);
+    strncpy(base_dir, cfg->ui_path, sizeof(base_dir) - 1);
     base_dir[sizeof(base_dir) - 1] = '\0';
     char *last = strrchr(base_dir, '/');
     if (last) {
@@ -1043,13 +2077,13 @@ static int h_root(struct mg_connection *c, void *ud){
 
     char base_real[PATH_MAX];
     if (!realpath(base_dir, base_real)) {
-        send_plain(c, 404, "not_found", cfg.ui_public);
+        send_plain(c, 404, "not_found", cfg->ui_public);
         return 1;
     }
 
     char joined[PATH_MAX];
     if (snprintf(joined, sizeof(joined), "%s/%s", base_real, rel_copy) >= (int)sizeof(joined)) {
-        send_plain(c, 400, "path_too_long", cfg.ui_public);
+        send_plain(c, 400, "path_too_long", cfg->ui_public);
         return 1;
     }
 
@@ -1058,38 +2092,66 @@ static int h_root(struct mg_connection *c, void *ud){
         size_t base_len = strlen(base_real);
         if (strncmp(resolved, base_real, base_len) != 0 ||
             (resolved[base_len] != '\0' && resolved[base_len] != '/')) {
-            send_plain(c, 403, "forbidden", cfg.ui_public);
+            send_plain(c, 403, "forbidden", cfg->ui_public);
             return 1;
         }
-        return stream_file(c, resolved, cfg.ui_public, 0);
+        return stream_file(c, resolved, cfg->ui_public, 0);
     }
 
-    return stream_file(c, joined, cfg.ui_public, 0);
+    return stream_file(c, joined, cfg->ui_public, 0);
 }
 
-static int h_caps(struct mg_connection *c, void *ud){
-    app_t *app=(app_t*)ud;
-    config_t cfg; app_config_snapshot(app, &cfg);
+static int h_root(struct mg_connection *c, void *ud) {
+    app_t *app = (app_t *)ud;
+    const config_t *cfg = app_config_acquire(app);
+    if (!cfg) { send_plain(c, 500, "server_error", 1); return 1; }
+    request_arena_begin();
+    int r = h_root_impl(c, app, cfg);
+    request_arena_end();
+    app_config_release(cfg);
+    return r;
+}
+#endif /* AUTOD_NO_UI */
+
+static int h_caps_impl(struct mg_connection *c, app_t *app, const config_t *cfg) {
+    int cors = cfg->ui_public;
+    char hostonly[128]; get_request_host_only(c, hostonly, sizeof(hostonly));
+    long long now_s = (long long)time(NULL);
+    int gen = app->active_override_generation;
+    char etag[64];
+    snprintf(etag, sizeof(etag), "\"caps-%d-%lld\"", gen, now_s);
+    if (client_matches_etag(c, etag)) {
+        send_json_not_modified(c, etag, cors);
+        return 1;
+    }
+    size_t blob_len = 0;
+    char *blob = caps_blob_lookup(hostonly, gen, now_s, &blob_len);
+    if (blob) {
+        send_json_blob(c, blob, blob_len, etag, cors);
+        free(blob);
+        return 1;
+    }
+
     JSON_Value *v=json_value_init_object(); JSON_Object *o=json_object(v);
-    if(cfg.device[0])  json_object_set_string(o,"device",cfg.device);
-    if(cfg.role[0])    json_object_set_string(o,"role",cfg.role);
-    if(cfg.version[0]) json_object_set_string(o,"version",cfg.version);
+    if(cfg->device[0])  json_object_set_string(o,"device",cfg->device);
+    if(cfg->role[0])    json_object_set_string(o,"role",cfg->role);
+    if(cfg->version[0]) json_object_set_string(o,"version",cfg->version);
 
     JSON_Value *caps_val = NULL;
     JSON_Array *caps_arr = NULL;
-    if(cfg.caps[0]){
+    if(cfg->caps[0]){
         caps_val = json_value_init_array();
         caps_arr = json_array(caps_val);
-        char tmp[256]; strncpy(tmp,cfg.caps,sizeof(tmp)-1); tmp[sizeof(tmp)-1]='\0';
+        char tmp[256]; strncpy(tmp,cfg->caps,sizeof(tmp)-1); tmp[sizeof(tmp)-1]='\0';
         char *tok,*save=NULL; for(tok=strtok_r(tmp,",",&save); tok; tok=strtok_r(NULL,",",&save)){ trim(tok); if(*tok) json_array_append_string(caps_arr,tok); }
     }
 
-    if (cfg.sync_role[0]) {
+    if (cfg->sync_role[0]) {
         if (!caps_arr) {
             caps_val = json_value_init_array();
             caps_arr = json_array(caps_val);
         }
-        sync_append_capabilities(&cfg, caps_arr);
+        sync_append_capabilities(cfg, caps_arr);
     }
 
     if (caps_arr) {
@@ -1097,30 +2159,30 @@ static int h_caps(struct mg_connection *c, void *ud){
     }
 
     json_add_runtime(o);
-    if(cfg.include_net_info) json_add_ifaddrs(o);
-    json_object_set_number(o,"port",cfg.port);
+    if(cfg->include_net_info) json_add_ifaddrs(o);
+    json_object_set_number(o,"port",cfg->port);
 
-    if (cfg.sse_count>0){
+    if (cfg->sse_count>0){
         JSON_Value *a=json_value_init_array(); JSON_Array *ar=json_array(a);
-        for(int i=0;i<cfg.sse_count;i++){
+        for(int i=0;i<cfg->sse_count;i++){
             JSON_Value *e=json_value_init_object(); JSON_Object *eo=json_object(e);
-            json_object_set_string(eo,"name",cfg.sse[i].name);
+            json_object_set_string(eo,"name",cfg->sse[i].name);
             char resolved[256];
-            substitute_ip_placeholder(c, cfg.sse[i].url, resolved, sizeof(resolved));
+            substitute_ip_placeholder(c, cfg->sse[i].url, resolved, sizeof(resolved));
             json_object_set_string(eo,"url", resolved);
             json_array_append_value(ar,e);
         }
         json_object_set_value(o,"sse",a);
     }
-    if(cfg.serve_ui && cfg.ui_path[0]){
+    if(cfg->serve_ui && cfg->ui_path[0]){
         JSON_Value *ui=json_value_init_object(); JSON_Object *uo=json_object(ui);
-        json_object_set_string(uo,"path",cfg.ui_path);
-        json_object_set_number(uo,"public",cfg.ui_public);
+        json_object_set_string(uo,"path",cfg->ui_path);
+        json_object_set_number(uo,"public",cfg->ui_public);
         json_object_set_value(o,"ui",ui);
     }
-    json_object_set_number(o,"scan_feature_enabled", cfg.enable_scan ? 1 : 0);
+    json_object_set_number(o,"scan_feature_enabled", cfg->enable_scan ? 1 : 0);
 
-    JSON_Value *sync_v = sync_build_status_json(&cfg, &app->slave);
+    JSON_Value *sync_v = sync_build_status_json(cfg, &app->slave);
     if (sync_v) {
         JSON_Object *so = json_object(sync_v);
         json_object_set_number(so, "active_override_generation",
@@ -1128,15 +2190,182 @@ static int h_caps(struct mg_connection *c, void *ud){
         json_object_set_value(o, "sync", sync_v);
     }
 
-    int cors = cfg.ui_public;
-    send_json(c, v, 200, cors);
+    char *s = json_serialize_to_string(v);
+    if (s) {
+        size_t slen = strlen(s);
+        caps_blob_store(hostonly, gen, now_s, s, slen);
+        send_json_blob(c, s, slen, etag, cors);
+        json_free_serialized_string(s);
+    } else {
+        send_json(c, v, 200, cors);
+    }
+    json_value_free(v);
+    return 1;
+}
+
+static int h_caps(struct mg_connection *c, void *ud) {
+    app_t *app = (app_t *)ud;
+    const config_t *cfg = app_config_acquire(app);
+    if (!cfg) { send_plain(c, 500, "server_error", 1); return 1; }
+    request_arena_begin();
+    int r = h_caps_impl(c, app, cfg);
+    request_arena_end();
+    app_config_release(cfg);
+    return r;
+}
+
+/* ----------------------- Exec result cache ----------------------- */
+/* Opt-in TTL cache for idempotent handler commands ([exec] cache=path:ttl_ms).
+   Keyed on path + args so dashboards polling the same read-only command
+   share one fork per TTL window instead of one per request. */
+
+enum { EXEC_CACHE_SLOTS = 32, EXEC_CACHE_KEY_MAX = 256 };
+
+typedef struct {
+    char      key[EXEC_CACHE_KEY_MAX]; // path + args, '\x1f'-joined; "" = empty
+    long long expires_ms;
+    int       rc;
+    long long elapsed_ms;
+    char     *out;
+    char     *err;
+} exec_cache_entry_t;
+
+static exec_cache_entry_t g_exec_cache[EXEC_CACHE_SLOTS];
+static pthread_mutex_t    g_exec_cache_mx = PTHREAD_MUTEX_INITIALIZER;
+
+static int exec_cache_ttl_for(const config_t *cfg, const char *path) {
+    for (int i = 0; i < cfg->exec_cache_rule_count; i++) {
+        if (strcmp(cfg->exec_cache_rules[i].path, path) == 0)
+            return cfg->exec_cache_rules[i].ttl_ms;
+    }
+    return 0;
+}
+
+static int exec_cache_key(char *key, size_t key_sz, const char *path, JSON_Array *args) {
+    size_t w = (size_t)snprintf(key, key_sz, "%s", path);
+    if (w >= key_sz) return -1;
+    size_t n = args ? json_array_get_count(args) : 0;
+    for (size_t i = 0; i < n; i++) {
+        const char *a = json_array_get_string(args, i);
+        int r = snprintf(key + w, key_sz - w, "\x1f%s", a ? a : "");
+        if (r < 0 || (size_t)r >= key_sz - w) return -1; // too long: skip caching
+        w += (size_t)r;
+    }
+    return 0;
+}
+
+static int exec_cache_lookup(const char *key, int *rc, long long *elapsed_ms,
+                             char **out, char **err) {
+    int hit = 0;
+    pthread_mutex_lock(&g_exec_cache_mx);
+    for (int i = 0; i < EXEC_CACHE_SLOTS; i++) {
+        exec_cache_entry_t *e = &g_exec_cache[i];
+        if (!e->key[0] || strcmp(e->key, key) != 0) continue;
+        if (now_ms() >= e->expires_ms) break; // expired; will be overwritten
+        *rc = e->rc;
+        *elapsed_ms = e->elapsed_ms;
+        *out = strdup(e->out ? e->out : "");
+        *err = strdup(e->err ? e->err : "");
+        hit = (*out && *err) ? 1 : 0;
+        if (!hit) { free(*out); free(*err); *out = *err = NULL; }
+        break;
+    }
+    pthread_mutex_unlock(&g_exec_cache_mx);
+    return hit;
+}
+
+static void exec_cache_store(const char *key, int ttl_ms, int rc,
+                             long long elapsed_ms, const char *out, const char *err) {
+    pthread_mutex_lock(&g_exec_cache_mx);
+    // reuse the same key's slot, else the first free/expired/oldest one
+    exec_cache_entry_t *victim = &g_exec_cache[0];
+    for (int i = 0; i < EXEC_CACHE_SLOTS; i++) {
+        exec_cache_entry_t *e = &g_exec_cache[i];
+        if (e->key[0] && strcmp(e->key, key) == 0) { victim = e; break; }
+        if (!e->key[0] || now_ms() >= e->expires_ms) { victim = e; continue; }
+        if (e->expires_ms < victim->expires_ms) victim = e;
+    }
+    free(victim->out);
+    free(victim->err);
+    victim->out = strdup(out ? out : "");
+    victim->err = strdup(err ? err : "");
+    if (!victim->out || !victim->err) {
+        free(victim->out); free(victim->err);
+        victim->out = victim->err = NULL;
+        victim->key[0] = '\0';
+    } else {
+        snprintf(victim->key, sizeof(victim->key), "%s", key);
+        victim->rc = rc;
+        victim->elapsed_ms = elapsed_ms;
+        victim->expires_ms = now_ms() + ttl_ms;
+    }
+    pthread_mutex_unlock(&g_exec_cache_mx);
+}
+
+/* SSE chunk relay for streaming /exec: one "output" event per pipe read,
+   so first-byte latency is one chunk, not the handler's full runtime. */
+static void exec_stream_chunk(int is_err, const char *data, size_t len, void *ud) {
+    struct mg_connection *c = (struct mg_connection *)ud;
+    JSON_Value *v = json_value_init_object();
+    JSON_Object *o = json_object(v);
+    json_object_set_string(o, "stream", is_err ? "stderr" : "stdout");
+    json_object_set_string_with_len(o, "chunk", data, len);
+    char *s = json_serialize_to_string(v);
+    if (s) {
+        mg_printf(c, "event: output\ndata: %s\n\n", s);
+        json_free_serialized_string(s);
+    }
     json_value_free(v);
+}
+
+static int exec_stream_response(struct mg_connection *c, const config_t *cfg,
+                                const char *path, JSON_Array *args) {
+    mg_printf(c,
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-store\r\n"
+        "Access-Control-Allow-Origin: *\r\n"
+        "X-Accel-Buffering: no\r\n"
+        "Connection: close\r\n\r\n");
+
+    int rc = 0;
+    long long elapsed = 0;
+    int r = exec_pool_run_cb(path, args, cfg->exec_timeout_ms,
+                             cfg->max_output_bytes, &rc, &elapsed,
+                             exec_stream_chunk, c);
+    if (r > 0) {
+        /* pool off or saturated: run buffered, replay output as one chunk */
+        char *out = NULL, *err = NULL;
+        if (run_exec_direct(cfg, path, args, cfg->exec_timeout_ms,
+                            cfg->max_output_bytes, &rc, &elapsed, &out, &err) == 0) {
+            if (out && *out) exec_stream_chunk(0, out, strlen(out), c);
+            if (err && *err) exec_stream_chunk(1, err, strlen(err), c);
+            free(out); free(err);
+            r = 0;
+        } else {
+            r = -1;
+        }
+    }
+
+    if (r == 0) {
+        JSON_Value *v = json_value_init_object();
+        JSON_Object *o = json_object(v);
+        json_object_set_number(o, "rc", rc);
+        json_object_set_number(o, "elapsed_ms", (double)elapsed);
+        char *s = json_serialize_to_string(v);
+        if (s) {
+            mg_printf(c, "event: result\ndata: %s\n\n", s);
+            json_free_serialized_string(s);
+        }
+        json_value_free(v);
+    } else {
+        mg_printf(c, "event: error\ndata: {\"error\":\"exec_failed\"}\n\n");
+    }
     return 1;
 }
 
-static int h_exec(struct mg_connection *c, void *ud){
-    app_t *app=(app_t*)ud;
-    config_t cfg; app_config_snapshot(app, &cfg);
+static int h_exec_impl(struct mg_connection *c, app_t *app, const config_t *cfg) {
+    (void)app;
     upload_t u={0};
     int rb = read_body(c, &u);
     if (rb != 0) {
@@ -1172,14 +2401,35 @@ static int h_exec(struct mg_connection *c, void *ud){
         json_object_set_string(oo,"error","missing_path");
         send_json(c, v, 400, 1); json_value_free(v); json_value_free(root); return 1;
     }
+    JSON_Value *stream_v=json_object_get_value(o,"stream");
+    int want_stream=(stream_v && json_value_get_type(stream_v)==JSONBoolean)
+                    ? json_value_get_boolean(stream_v) : 0;
+    if (want_stream) {
+        /* per-chunk parson work must not accumulate in the request arena
+           for the lifetime of a long-running stream */
+        int arena_was = request_arena_suspend();
+        int r = exec_stream_response(c, cfg, path, args);
+        request_arena_resume(arena_was);
+        json_value_free(root);
+        return r;
+    }
+    int cache_ttl = exec_cache_ttl_for(cfg, path);
+    char cache_key[EXEC_CACHE_KEY_MAX];
+    if (cache_ttl > 0 && exec_cache_key(cache_key, sizeof(cache_key), path, args) != 0)
+        cache_ttl = 0; // key too long: run uncached
     int rc=0; long long elapsed=0; char *out=NULL,*err=NULL;
-    int exec_r=run_exec(&cfg, path, args, cfg.exec_timeout_ms, cfg.max_output_bytes, &rc,&elapsed,&out,&err);
+    int cached = cache_ttl > 0 && exec_cache_lookup(cache_key, &rc, &elapsed, &out, &err);
+    int exec_r = cached ? 0
+               : run_exec(cfg, path, args, cfg->exec_timeout_ms, cfg->max_output_bytes, &rc,&elapsed,&out,&err);
+    if (exec_r == 0 && !cached && cache_ttl > 0)
+        exec_cache_store(cache_key, cache_ttl, rc, elapsed, out, err);
     JSON_Value *resp=json_value_init_object(); JSON_Object *or=json_object(resp);
     if(exec_r==0){
         json_object_set_number(or,"rc",rc);
         json_object_set_number(or,"elapsed_ms",(double)elapsed);
         json_object_set_string(or,"stdout", out?out:"");
         json_object_set_string(or,"stderr", err?err:"");
+        if (cached) json_object_set_boolean(or,"cached",1);
         free(out); free(err);
         send_json(c, resp, 200, 1);
     } else {
@@ -1189,6 +2439,17 @@ static int h_exec(struct mg_connection *c, void *ud){
     json_value_free(resp); json_value_free(root); return 1;
 }
 
+static int h_exec(struct mg_connection *c, void *ud) {
+    app_t *app = (app_t *)ud;
+    const config_t *cfg = app_config_acquire(app);
+    if (!cfg) { send_plain(c, 500, "server_error", 1); return 1; }
+    request_arena_begin();
+    int r = h_exec_impl(c, app, cfg);
+    request_arena_end();
+    app_config_release(cfg);
+    return r;
+}
+
 static int resolve_target(app_t *app, const config_t *cfg,
                           const char *sync_id, int slot_index,
                           const char *node_ip, const char *device_name,
@@ -1197,8 +2458,115 @@ static int resolve_target(app_t *app, const config_t *cfg,
                           char *resolved_sync_id, size_t resolved_sz,
                           char *err_code, size_t err_sz);
 
-static int h_udp(struct mg_connection *c, void *ud) {
-    (void)ud;
+/* ----------------------- UDP forward socket cache ----------------------- */
+/* CRSF-style control payloads hit /udp at 20-50 Hz for the same target;
+   keep a small LRU of connect()ed datagram sockets with the resolved
+   address baked in, so the steady-state cost of a forward is one send(). */
+
+enum { UDP_FWD_SLOTS = 8 };
+#define UDP_FWD_TTL_MS 60000    // re-resolve targets at most once a minute
+#define UDP_FWD_RESOLVE_MS 2000 // deadline for an uncached hostname lookup
+
+typedef struct {
+    char      host[64]; // "" = free slot
+    int       port;
+    int       fd;
+    long long resolved_ms;
+    long long used_ms;
+} udp_fwd_t;
+
+static udp_fwd_t g_udp_fwd[UDP_FWD_SLOTS];
+static pthread_mutex_t g_udp_fwd_mx = PTHREAD_MUTEX_INITIALIZER;
+
+/* Send one datagram through the socket cache, (re)resolving and
+   reconnecting on miss or TTL expiry. Returns bytes sent, or -1 with
+   err_code/detail set for the handler's error response. */
+static ssize_t udp_fwd_send(const char *host, int port,
+                            const void *data, size_t len,
+                            const char **err_code, char *detail, size_t detail_sz) {
+    *err_code = NULL;
+    detail[0] = '\0';
+    long long now = now_ms();
+    ssize_t sent = -1;
+
+    pthread_mutex_lock(&g_udp_fwd_mx);
+
+    udp_fwd_t *e = NULL;
+    for (int i = 0; i < UDP_FWD_SLOTS; i++) {
+        udp_fwd_t *s = &g_udp_fwd[i];
+        if (s->host[0] && s->port == port && strcmp(s->host, host) == 0) {
+            e = s;
+            break;
+        }
+    }
+    if (e && now - e->resolved_ms > UDP_FWD_TTL_MS) {
+        close(e->fd);
+        e->host[0] = '\0';
+        e = NULL;
+    }
+    if (!e) {
+        /* Resolve and connect with the cache unlocked: a slow or dead DNS
+           server must not stall forwards to already-cached targets. */
+        pthread_mutex_unlock(&g_udp_fwd_mx);
+
+        struct sockaddr_storage ss;
+        socklen_t slen = 0;
+        int rr = resolver_resolve(host, port, UDP_FWD_RESOLVE_MS,
+                                  &ss, &slen, detail, detail_sz);
+        if (rr != RESOLVE_OK) {
+            *err_code = (rr == RESOLVE_TIMEOUT) ? "resolve_timeout"
+                                                : "resolve_failed";
+            return -1;
+        }
+        int fd = socket(ss.ss_family, SOCK_DGRAM, IPPROTO_UDP);
+        if (fd < 0 || connect(fd, (struct sockaddr *)&ss, slen) != 0) {
+            int saved_errno = errno;
+            if (fd >= 0) close(fd);
+            *err_code = "send_failed";
+            snprintf(detail, detail_sz, "%s", strerror(saved_errno));
+            return -1;
+        }
+
+        pthread_mutex_lock(&g_udp_fwd_mx);
+        /* Insert into a free slot, else evict the LRU. A concurrent worker
+           may have raced the same target in; the duplicate is harmless and
+           ages out as LRU. */
+        udp_fwd_t *slot = NULL, *lru = NULL;
+        for (int i = 0; i < UDP_FWD_SLOTS; i++) {
+            udp_fwd_t *s = &g_udp_fwd[i];
+            if (!s->host[0]) { slot = s; break; }
+            if (!lru || s->used_ms < lru->used_ms) lru = s;
+        }
+        if (!slot) slot = lru;
+        if (slot->host[0]) close(slot->fd);
+        snprintf(slot->host, sizeof(slot->host), "%s", host);
+        slot->port = port;
+        slot->fd = fd;
+        slot->resolved_ms = now_ms();
+        e = slot;
+    }
+
+    e->used_ms = now;
+    sent = send(e->fd, data, len, 0);
+    if (sent < 0 && errno == ECONNREFUSED) {
+        // a prior datagram bounced (ICMP unreachable queued on the
+        // connected socket); drain the error and retry once
+        sent = send(e->fd, data, len, 0);
+    }
+    if (sent < 0) {
+        int saved_errno = errno;
+        close(e->fd);
+        e->host[0] = '\0';
+        pthread_mutex_unlock(&g_udp_fwd_mx);
+        *err_code = "send_failed";
+        snprintf(detail, detail_sz, "%s", strerror(saved_errno));
+        return -1;
+    }
+    pthread_mutex_unlock(&g_udp_fwd_mx);
+    return sent;
+}
+
+static int h_udp_impl(struct mg_connection *c, app_t *app, const config_t *cfg) {
     const struct mg_request_info *ri = mg_get_request_info(c);
     if (!ri || strcmp(ri->request_method, "POST") != 0) {
         send_plain(c, 405, "method_not_allowed", 1);
@@ -1294,8 +2662,6 @@ static int h_udp(struct mg_connection *c, void *ud) {
 
     char target_host[64];
     target_host[0] = '\0';
-    config_t cfg;
-    app_config_snapshot((app_t *)ud, &cfg);
 
     if (host_in && *host_in) {
         strncpy(target_host, host_in, sizeof(target_host) - 1);
@@ -1304,7 +2670,7 @@ static int h_udp(struct mg_connection *c, void *ud) {
         char err_code[32];
         int resolved_port = 0; // ignored
         char resolved_sync_id[64]; // ignored
-        if (resolve_target((app_t *)ud, &cfg, sync_id, slot_index, node_ip, device,
+        if (resolve_target(app, cfg, sync_id, slot_index, node_ip, device,
                            0, target_host, sizeof(target_host), &resolved_port,
                            resolved_sync_id, sizeof(resolved_sync_id),
                            err_code, sizeof(err_code)) != 0) {
@@ -1362,59 +2728,20 @@ static int h_udp(struct mg_connection *c, void *ud) {
         data_len = strlen((const char *)data);
     }
 
-    char portbuf[16];
-    snprintf(portbuf, sizeof(portbuf), "%d", port);
-    struct addrinfo hints; memset(&hints, 0, sizeof(hints));
-    hints.ai_socktype = SOCK_DGRAM;
-    hints.ai_protocol = IPPROTO_UDP;
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_flags = AI_NUMERICSERV;
-
-    struct addrinfo *res = NULL;
-    int gai = getaddrinfo(host, portbuf, &hints, &res);
-    if (gai != 0) {
-        if (tmp) free(tmp);
-        JSON_Value *v = json_value_init_object();
-        JSON_Object *o = json_object(v);
-        json_object_set_string(o, "error", "resolve_failed");
-        const char *detail = gai_strerror(gai);
-        if (detail && *detail) json_object_set_string(o, "detail", detail);
-        send_json(c, v, 502, 1);
-        json_value_free(v);
-        json_value_free(root);
-        return 1;
-    }
-
-    int sent_ok = 0;
-    ssize_t sent_bytes = -1;
-    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
-        int fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
-        if (fd < 0) continue;
-        ssize_t r = sendto(fd, data, data_len, 0, ai->ai_addr, ai->ai_addrlen);
-        int saved_errno = errno;
-        close(fd);
-        if (r >= 0) {
-            sent_ok = 1;
-            sent_bytes = r;
-            break;
-        }
-        errno = saved_errno;
-    }
-    freeaddrinfo(res);
-
-    if (!sent_ok) {
-        int saved_errno = errno;
+    const char *send_err = NULL;
+    char send_detail[128];
+    ssize_t sent_bytes = udp_fwd_send(host, port, data, data_len,
+                                      &send_err, send_detail, sizeof(send_detail));
+    if (sent_bytes < 0) {
         if (tmp) free(tmp);
         JSON_Value *v = json_value_init_object();
         JSON_Object *o = json_object(v);
-        json_object_set_string(o, "error", "send_failed");
-        if (saved_errno) {
-            json_object_set_string(o, "detail", strerror(saved_errno));
-        }
-        send_json(c, v, 502, 1);
+        json_object_set_string(o, "error", send_err ? send_err : "send_failed");
+        if (send_detail[0]) json_object_set_string(o, "detail", send_detail);
+        int st = (send_err && strcmp(send_err, "resolve_timeout") == 0) ? 504 : 502;
+        send_json(c, v, st, 1);
         json_value_free(v);
         json_value_free(root);
-        errno = saved_errno;
         return 1;
     }
 
@@ -1433,6 +2760,17 @@ static int h_udp(struct mg_connection *c, void *ud) {
     return 1;
 }
 
+static int h_udp(struct mg_connection *c, void *ud) {
+    app_t *app = (app_t *)ud;
+    const config_t *cfg = app_config_acquire(app);
+    if (!cfg) { send_plain(c, 500, "server_error", 1); return 1; }
+    request_arena_begin();
+    int r = h_udp_impl(c, app, cfg);
+    request_arena_end();
+    app_config_release(cfg);
+    return r;
+}
+
 static int resolve_target(app_t *app, const config_t *cfg,
                           const char *sync_id, int slot_index,
                           const char *node_ip, const char *device_name,
@@ -1470,8 +2808,24 @@ static int resolve_target(app_t *app, const config_t *cfg,
         target_sync_id[sizeof(target_sync_id) - 1] = '\0';
     }
 
-    scan_node_t nodes[SCAN_MAX_NODES];
-    int node_count = scan_get_nodes(nodes, SCAN_MAX_NODES);
+    if (node_ip && *node_ip) {
+        // Fast path: the hash index answers exact ip:port lookups in O(1)
+        scan_node_t hit;
+        int want_port = (port_hint > 0) ? port_hint : cfg->port;
+        if (scan_find_node(node_ip, want_port, &hit) == 0) {
+            strncpy(host_out, hit.ip, host_sz - 1);
+            host_out[host_sz - 1] = '\0';
+            *port_out = (port_hint > 0) ? port_hint : hit.port;
+            if (resolved_sync_id && hit.sync_id[0]) {
+                strncpy(resolved_sync_id, hit.sync_id, resolved_sz - 1);
+                resolved_sync_id[resolved_sz - 1] = '\0';
+            }
+            return 0;
+        }
+    }
+
+    int node_count = 0;
+    scan_node_t *nodes = scan_copy_nodes(&node_count);
 
     if (node_ip && *node_ip) {
         for (int i = 0; i < node_count; i++) {
@@ -1483,8 +2837,10 @@ static int resolve_target(app_t *app, const config_t *cfg,
                 strncpy(resolved_sync_id, nodes[i].sync_id, resolved_sz - 1);
                 resolved_sync_id[resolved_sz - 1] = '\0';
             }
+            free(nodes);
             return 0;
         }
+        free(nodes);
         snprintf(err_code, err_sz, "%s", "node_not_found");
         return -1;
     }
@@ -1500,8 +2856,10 @@ static int resolve_target(app_t *app, const config_t *cfg,
                 strncpy(resolved_sync_id, nodes[i].sync_id, resolved_sz - 1);
                 resolved_sync_id[resolved_sz - 1] = '\0';
             }
+            free(nodes);
             return 0;
         }
+        free(nodes);
         snprintf(err_code, err_sz, "%s", "id_not_found");
         return -1;
     }
@@ -1516,19 +2874,20 @@ static int resolve_target(app_t *app, const config_t *cfg,
                 strncpy(resolved_sync_id, nodes[i].sync_id, resolved_sz - 1);
                 resolved_sync_id[resolved_sz - 1] = '\0';
             }
+            free(nodes);
             return 0;
         }
+        free(nodes);
         snprintf(err_code, err_sz, "%s", "device_not_found");
         return -1;
     }
 
+    free(nodes);
     snprintf(err_code, err_sz, "%s", "invalid_target");
     return -1;
 }
 
-static int h_http(struct mg_connection *c, void *ud) {
-    app_t *app = (app_t *)ud;
-    config_t cfg; app_config_snapshot(app, &cfg);
+static int h_http_impl(struct mg_connection *c, app_t *app, const config_t *cfg) {
     const struct mg_request_info *ri = mg_get_request_info(c);
     if (!ri || strcmp(ri->request_method, "POST") != 0) {
         send_plain(c, 405, "method_not_allowed", 1);
@@ -1667,7 +3026,7 @@ static int h_http(struct mg_connection *c, void *ud) {
     char resolved_sync_id[64];
     char target_err[32];
 
-    if (resolve_target(app, &cfg, sync_id, slot_index, node_ip, device, port_hint,
+    if (resolve_target(app, cfg, sync_id, slot_index, node_ip, device, port_hint,
                        target_host, sizeof(target_host), &target_port,
                        resolved_sync_id, sizeof(resolved_sync_id),
                        target_err, sizeof(target_err)) != 0) {
@@ -1722,192 +3081,58 @@ static int h_http(struct mg_connection *c, void *ud) {
         body_len = strlen((const char *)body_data);
     }
 
-    char portbuf[16];
-    snprintf(portbuf, sizeof(portbuf), "%d", target_port);
-    struct addrinfo hints; memset(&hints, 0, sizeof(hints));
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_protocol = IPPROTO_TCP;
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_flags = AI_NUMERICSERV;
-
-    struct addrinfo *res = NULL;
-    int gai = getaddrinfo(target_host, portbuf, &hints, &res);
-    if (gai != 0) {
-        if (body_buf) free(body_buf);
-        JSON_Value *v = json_value_init_object();
-        JSON_Object *o = json_object(v);
-        json_object_set_string(o, "error", "resolve_failed");
-        const char *detail = gai_strerror(gai);
-        if (detail && *detail) json_object_set_string(o, "detail", detail);
-        send_json(c, v, 502, 1);
-        json_value_free(v);
-        json_value_free(root);
-        return 1;
-    }
-
-    int fd = -1;
-    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
-        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
-        if (fd < 0) continue;
-        struct timeval tv;
-        if (timeout_ms < 1) timeout_ms = 1;
-        tv.tv_sec = timeout_ms / 1000;
-        tv.tv_usec = (timeout_ms % 1000) * 1000;
-        (void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-        (void)setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
-            break;
-        }
-        int saved_errno = errno;
-        close(fd);
-        fd = -1;
-        errno = saved_errno;
-    }
-    freeaddrinfo(res);
-
-    if (fd < 0) {
-        int saved_errno = errno;
-        if (body_buf) free(body_buf);
-        JSON_Value *v = json_value_init_object();
-        JSON_Object *o = json_object(v);
-        json_object_set_string(o, "error", "connect_failed");
-        if (saved_errno) json_object_set_string(o, "detail", strerror(saved_errno));
-        send_json(c, v, 502, 1);
-        json_value_free(v);
-        json_value_free(root);
-        errno = saved_errno;
-        return 1;
-    }
-
     char method_buf[16];
     snprintf(method_buf, sizeof(method_buf), "%s", method);
     for (size_t i = 0; i < strlen(method_buf); i++) {
         method_buf[i] = (char)toupper((unsigned char)method_buf[i]);
     }
 
-    int has_content_length = 0;
+    /* Collect forwarded header lines. Host, Connection and Content-Length
+       are managed by the connection pool so the response stays framed and
+       the socket can be reused. */
+    char *fwd_hdrs = NULL;
+    size_t fwd_len = 0;
     if (headers_obj) {
         size_t hc = json_object_get_count(json_object(headers_v));
         for (size_t i = 0; i < hc; i++) {
             const char *hn = json_object_get_name(json_object(headers_v), i);
             const char *hv = json_object_get_string(json_object(headers_v), hn);
             if (!hn || !hv) continue;
-            if (strcasecmp(hn, "Content-Length") == 0) has_content_length = 1;
-        }
-    }
-
-    dprintf(fd, "%s %s HTTP/1.0\r\nHost: %s\r\n", method_buf, path, target_host);
-    if (headers_obj) {
-        size_t hc = json_object_get_count(json_object(headers_v));
-        for (size_t i = 0; i < hc; i++) {
-            const char *hn = json_object_get_name(json_object(headers_v), i);
-            const char *hv = json_object_get_string(json_object(headers_v), hn);
-            if (!hn || !hv) continue;
-            dprintf(fd, "%s: %s\r\n", hn, hv);
-        }
-    }
-    if (body_len > 0 && !has_content_length) {
-        dprintf(fd, "Content-Length: %zu\r\n", body_len);
-    }
-    dprintf(fd, "Connection: close\r\n\r\n");
-    if (body_len > 0) {
-        size_t sent = 0;
-        int send_err = 0;
-        while (sent < body_len) {
-            ssize_t w = send(fd, body_data + sent, body_len - sent, 0);
-            if (w < 0) { send_err = errno ? errno : EIO; break; }
-            if (w == 0) { send_err = EPIPE; break; }
-            sent += (size_t)w;
-        }
-        if (send_err) {
-            if (body_buf) free(body_buf);
-            close(fd);
-            JSON_Value *v = json_value_init_object();
-            JSON_Object *o = json_object(v);
-            json_object_set_string(o, "error", "send_failed");
-            json_object_set_string(o, "detail", strerror(send_err));
-            send_json(c, v, 502, 1);
-            json_value_free(v);
-            json_value_free(root);
-            return 1;
+            if (strcasecmp(hn, "Content-Length") == 0 ||
+                strcasecmp(hn, "Connection") == 0 ||
+                strcasecmp(hn, "Host") == 0) {
+                continue;
+            }
+            size_t need = strlen(hn) + strlen(hv) + 5;
+            char *nb = (char *)realloc(fwd_hdrs, fwd_len + need);
+            if (!nb) continue;
+            fwd_hdrs = nb;
+            fwd_len += (size_t)snprintf(fwd_hdrs + fwd_len, need, "%s: %s\r\n", hn, hv);
         }
     }
 
-    size_t bufcap = 4096;
-    size_t buflen = 0;
-    char *resp_buf = (char *)malloc(bufcap + 1);
-    if (!resp_buf) {
-        if (body_buf) free(body_buf);
-        close(fd);
-        JSON_Value *v = json_value_init_object();
-        JSON_Object *o = json_object(v);
-        json_object_set_string(o, "error", "oom");
-        send_json(c, v, 500, 1);
-        json_value_free(v);
-        json_value_free(root);
-        return 1;
-    }
-
-    int recv_err = 0;
-    while (1) {
-        char chunk[2048];
-        ssize_t r = recv(fd, chunk, sizeof(chunk), 0);
-        if (r == 0) break;
-        if (r < 0) { recv_err = errno ? errno : EIO; break; }
-        if (buflen + (size_t)r + 1 > bufcap) {
-            size_t ncap = bufcap * 2;
-            while (buflen + (size_t)r + 1 > ncap) ncap *= 2;
-            char *nb = (char *)realloc(resp_buf, ncap + 1);
-            if (!nb) { recv_err = ENOMEM; break; }
-            resp_buf = nb;
-            bufcap = ncap;
-        }
-        memcpy(resp_buf + buflen, chunk, (size_t)r);
-        buflen += (size_t)r;
-    }
-    close(fd);
-
-    if (recv_err) {
+    http_pool_resp_t presp;
+    const char *perr = NULL;
+    if (http_pool_request(target_host, target_port, method_buf, path, fwd_hdrs,
+                          body_data, body_len, timeout_ms, 8 * 1024 * 1024,
+                          &presp, &perr) != 0) {
+        int saved_errno = errno;
+        free(fwd_hdrs);
         if (body_buf) free(body_buf);
-        free(resp_buf);
         JSON_Value *v = json_value_init_object();
         JSON_Object *o = json_object(v);
-        json_object_set_string(o, "error", "recv_failed");
-        json_object_set_string(o, "detail", strerror(recv_err));
-        send_json(c, v, 502, 1);
+        json_object_set_string(o, "error", perr ? perr : "proxy_failed");
+        if (saved_errno) json_object_set_string(o, "detail", strerror(saved_errno));
+        int st = (perr && strcmp(perr, "resolve_timeout") == 0) ? 504 : 502;
+        send_json(c, v, st, 1);
         json_value_free(v);
         json_value_free(root);
         return 1;
     }
-    resp_buf[buflen] = '\0';
+    free(fwd_hdrs);
 
-    size_t header_len = 0;
-    size_t body_off = 0;
-    const char *hdr_end = NULL;
-    hdr_end = strstr(resp_buf, "\r\n\r\n");
-    if (!hdr_end) hdr_end = strstr(resp_buf, "\n\n");
-    if (hdr_end) {
-        header_len = (size_t)(hdr_end - resp_buf);
-        body_off = header_len + ((hdr_end[0] == '\r') ? 4 : 2);
-    } else {
-        header_len = buflen;
-        body_off = buflen;
-    }
-
-    char *header_copy = (char *)malloc(header_len + 1);
-    if (!header_copy) {
-        if (body_buf) free(body_buf);
-        free(resp_buf);
-        JSON_Value *v = json_value_init_object();
-        JSON_Object *o = json_object(v);
-        json_object_set_string(o, "error", "oom");
-        send_json(c, v, 500, 1);
-        json_value_free(v);
-        json_value_free(root);
-        return 1;
-    }
-    memcpy(header_copy, resp_buf, header_len);
-    header_copy[header_len] = '\0';
+    char *header_copy = presp.headers;
+    presp.headers = NULL;
 
     int status_code = 0;
     char reason[128]; reason[0] = '\0';
@@ -1934,14 +3159,14 @@ static int h_http(struct mg_connection *c, void *ud) {
         }
     }
 
-    const unsigned char *body_ptr = (const unsigned char *)(resp_buf + (body_off > buflen ? buflen : body_off));
-    size_t resp_body_len = (body_off <= buflen) ? (buflen - body_off) : 0;
+    const unsigned char *body_ptr = (const unsigned char *)presp.body;
+    size_t resp_body_len = presp.body_len;
 
     size_t b64_cap = ((resp_body_len + 2) / 3) * 4 + 1;
     char *b64 = (char *)malloc(b64_cap);
     if (!b64) {
         if (body_buf) free(body_buf);
-        free(resp_buf);
+        http_pool_resp_free(&presp);
         free(header_copy);
         json_value_free(headers_out_v);
         JSON_Value *v = json_value_init_object();
@@ -1959,7 +3184,7 @@ static int h_http(struct mg_connection *c, void *ud) {
     } else if (mg_base64_encode(body_ptr, resp_body_len, b64, &b64_len) != -1) {
         free(b64);
         if (body_buf) free(body_buf);
-        free(resp_buf);
+        http_pool_resp_free(&presp);
         free(header_copy);
         json_value_free(headers_out_v);
         JSON_Value *v = json_value_init_object();
@@ -1989,13 +3214,24 @@ static int h_http(struct mg_connection *c, void *ud) {
 
     free(b64);
     if (body_buf) free(body_buf);
-    free(resp_buf);
+    http_pool_resp_free(&presp);
     free(header_copy);
     json_value_free(resp);
     json_value_free(root);
     return 1;
 }
 
+static int h_http(struct mg_connection *c, void *ud) {
+    app_t *app = (app_t *)ud;
+    const config_t *cfg = app_config_acquire(app);
+    if (!cfg) { send_plain(c, 500, "server_error", 1); return 1; }
+    request_arena_begin();
+    int r = h_http_impl(c, app, cfg);
+    request_arena_end();
+    app_config_release(cfg);
+    return r;
+}
+
 
 
 
@@ -2005,13 +3241,12 @@ static int h_http(struct mg_connection *c, void *ud) {
 
 
 /* ----------------------- /nodes endpoint (via scan.*) ----------------------- */
-static int h_nodes(struct mg_connection *c, void *ud){
-    app_t *app=(app_t*)ud;
-    config_t cfg; app_config_snapshot(app, &cfg);
+static int h_nodes_impl(struct mg_connection *c, app_t *app, const config_t *cfg) {
+    (void)app;
     const struct mg_request_info *ri = mg_get_request_info(c);
 
     if (!strcmp(ri->request_method, "POST")) {
-        if (!cfg.enable_scan) {
+        if (!cfg->enable_scan) {
             JSON_Value *v=json_value_init_object(); JSON_Object *o=json_object(v);
             json_object_set_string(o,"error","scan_disabled");
             send_json(c, v, 400, 1); json_value_free(v); return 1;
@@ -2024,13 +3259,14 @@ static int h_nodes(struct mg_connection *c, void *ud){
             json_object_set_number(o,"scanning", st.scanning);
             json_object_set_number(o,"targets",  st.targets);
             json_object_set_number(o,"done",     st.done);
+            json_object_set_number(o,"in_flight", st.in_flight);
             json_object_set_number(o,"progress_pct", st.progress_pct);
             json_object_set_number(o,"last_started",  st.last_started);
             json_object_set_number(o,"last_finished", st.last_finished);
             send_json(c, v, 202, 1); json_value_free(v); return 1;
         }
 
-        scan_config_t scfg; fill_scan_config(&cfg, &scfg);
+        scan_config_t scfg; fill_scan_config(cfg, &scfg);
         (void)scan_start_async(&scfg);
 
         scan_status_t st; scan_get_status(&st);
@@ -2039,6 +3275,7 @@ static int h_nodes(struct mg_connection *c, void *ud){
         json_object_set_number(o,"scanning", st.scanning);
         json_object_set_number(o,"targets",  st.targets);
         json_object_set_number(o,"done",     st.done);
+        json_object_set_number(o,"in_flight", st.in_flight);
         json_object_set_number(o,"progress_pct", st.progress_pct);
         json_object_set_number(o,"last_started",  st.last_started);
         json_object_set_number(o,"last_finished", st.last_finished);
@@ -2048,9 +3285,27 @@ static int h_nodes(struct mg_connection *c, void *ud){
     }
 
     // GET
-    scan_node_t nodes[SCAN_MAX_NODES];
-    int n = scan_get_nodes(nodes, SCAN_MAX_NODES);
+    unsigned gen = scan_table_generation();
     scan_status_t st; scan_get_status(&st);
+    char etag[48];
+    int cacheable = !st.scanning; // progress fields churn mid-scan
+    if (cacheable) {
+        snprintf(etag, sizeof(etag), "\"nodes-%u-%d\"", gen, cfg->enable_scan ? 1 : 0);
+        if (client_matches_etag(c, etag)) {
+            send_json_not_modified(c, etag, 1);
+            return 1;
+        }
+        size_t blob_len = 0;
+        char *blob = nodes_blob_lookup(gen, &blob_len);
+        if (blob) {
+            send_json_blob(c, blob, blob_len, etag, 1);
+            free(blob);
+            return 1;
+        }
+    }
+
+    int n = 0;
+    scan_node_t *nodes = scan_copy_nodes(&n);
 
     JSON_Value *v=json_value_init_object(); JSON_Object *o=json_object(v);
     JSON_Value *arrv=json_value_init_array(); JSON_Array *arr=json_array(arrv);
@@ -2066,23 +3321,50 @@ static int h_nodes(struct mg_connection *c, void *ud){
         json_array_append_value(arr, nv);
     }
 
+    free(nodes);
+
     json_object_set_value(o,"nodes", arrv);
-    json_object_set_number(o,"scan_feature_enabled", cfg.enable_scan ? 1 : 0);
+    json_object_set_number(o,"scan_feature_enabled", cfg->enable_scan ? 1 : 0);
     json_object_set_number(o,"scanning", st.scanning);
     json_object_set_number(o,"targets",  st.targets);
     json_object_set_number(o,"done",     st.done);
+    json_object_set_number(o,"in_flight", st.in_flight);
     json_object_set_number(o,"progress_pct", st.progress_pct);
     json_object_set_number(o,"last_started",  st.last_started);
     json_object_set_number(o,"last_finished", st.last_finished);
 
+    if (cacheable) {
+        char *s = json_serialize_to_string(v);
+        if (s) {
+            size_t slen = strlen(s);
+            nodes_blob_store(gen, s, slen);
+            send_json_blob(c, s, slen, etag, 1);
+            json_free_serialized_string(s);
+            json_value_free(v);
+            return 1;
+        }
+    }
     send_json(c, v, 200, 1);
     json_value_free(v);
     return 1;
 }
 
+static int h_nodes(struct mg_connection *c, void *ud) {
+    app_t *app = (app_t *)ud;
+    const config_t *cfg = app_config_acquire(app);
+    if (!cfg) { send_plain(c, 500, "server_error", 1); return 1; }
+    request_arena_begin();
+    int r = h_nodes_impl(c, app, cfg);
+    request_arena_end();
+    app_config_release(cfg);
+    return r;
+}
+
 /* ----------------------- main ----------------------- */
 
 int main(int argc, char **argv){
+    json_set_allocation_functions(parson_alloc_hook, parson_free_hook);
+
     const char *cfgpath = "./autod.conf";
     for (int i=1; i<argc; i++) {
         if (argv[i][0] != '-') { cfgpath = argv[i]; }
@@ -2101,14 +3383,15 @@ int main(int argc, char **argv){
     }
 
     pthread_mutex_lock(&app.cfg_lock);
-    app.cfg = app.base_cfg;
-    sync_ensure_id(&app.cfg);
+    app_rebuild_config_locked(&app); // also publishes the first snapshot
     pthread_mutex_unlock(&app.cfg_lock);
 
     signal(SIGINT, on_signal);
     signal(SIGTERM, on_signal);
     signal(SIGPIPE, SIG_IGN);
 
+    resolver_start();
+
     config_t cfg_snapshot; app_config_snapshot(&app, &cfg_snapshot);
 
     /* CivetWeb options */
@@ -2117,10 +3400,14 @@ int main(int argc, char **argv){
     if (strcmp(cfg_snapshot.bind_addr,"0.0.0.0")==0) snprintf(lp, sizeof(lp), "%s", portbuf);
     else snprintf(lp, sizeof(lp), "%s:%s", cfg_snapshot.bind_addr, portbuf);
 
+    int nthreads = cfg_snapshot.http_threads;
+    if (nthreads < 2) nthreads = 2;
+    if (nthreads > 64) nthreads = 64;
+    char threadbuf[16]; snprintf(threadbuf, sizeof(threadbuf), "%d", nthreads);
     const char *options[] = {
         "listening_ports", lp,
         "enable_keep_alive", "yes",
-        "num_threads", "2",
+        "num_threads", threadbuf,
         NULL
     };
 
@@ -2131,6 +3418,23 @@ int main(int argc, char **argv){
     init.user_data = &app;
     init.configuration_options = options;
 
+#ifndef AUTOD_NO_UI
+    /* Warm the in-memory UI asset cache so even the first page load after
+       boot is served without touching disk. */
+    if (cfg_snapshot.serve_ui && cfg_snapshot.ui_path[0]) {
+        ui_cache_preload(cfg_snapshot.ui_path);
+    }
+#endif
+
+    /* Pre-spawn exec workers before CivetWeb creates its threads, so the
+       pool processes are forked from a small single-threaded image. */
+    if (cfg_snapshot.exec_pool_size > 0) {
+        if (exec_pool_start(cfg_snapshot.interpreter,
+                            cfg_snapshot.exec_pool_size) != 0) {
+            fprintf(stderr, "WARN: exec worker pool unavailable, using direct fork\n");
+        }
+    }
+
     struct mg_error_data err = {0};
     char errbuf[256];
     err.text = errbuf;
@@ -2148,17 +3452,22 @@ int main(int argc, char **argv){
         return 1;
     }
 
-    /* Install handlers */
-    mg_set_request_handler(app.ctx, "/health",  h_health,        &app);
-    mg_set_request_handler(app.ctx, "/caps",    h_caps,          &app);
-    mg_set_request_handler(app.ctx, "/exec",    h_exec,          &app);
-    mg_set_request_handler(app.ctx, "/udp",     h_udp,           &app);
-    mg_set_request_handler(app.ctx, "/http",    h_http,          &app);
-    mg_set_request_handler(app.ctx, "/nodes",   h_nodes,         &app);
-    mg_set_request_handler(app.ctx, "/media",   h_media,         &app);
-    mg_set_request_handler(app.ctx, "/firmware", h_firmware,     &app);
+    /* Install handlers (metered so /metrics can attribute latency) */
+    set_metered_handler(app.ctx, "/health",  h_health,        &app);
+    set_metered_handler(app.ctx, "/caps",    h_caps,          &app);
+    set_metered_handler(app.ctx, "/exec",    h_exec,          &app);
+    set_metered_handler(app.ctx, "/udp",     h_udp,           &app);
+    set_metered_handler(app.ctx, "/http",    h_http,          &app);
+    set_metered_handler(app.ctx, "/nodes",   h_nodes,         &app);
+#ifndef AUTOD_NO_FILESHARE
+    set_metered_handler(app.ctx, "/media",   h_media,         &app);
+    set_metered_handler(app.ctx, "/firmware", h_firmware,     &app);
+#endif
+    mg_set_request_handler(app.ctx, "/metrics", h_metrics,    &app);
     sync_register_http_handlers(app.ctx, &app);
-    mg_set_request_handler(app.ctx, "/",        h_root,    &app);
+#ifndef AUTOD_NO_UI
+    set_metered_handler(app.ctx, "/",        h_root,    &app);
+#endif
 
     /* CORS preflight */
     mg_set_request_handler(app.ctx, "**", h_options_all, &app);
@@ -2168,9 +3477,19 @@ int main(int argc, char **argv){
 
     // ---- Scanner: seed + optional autostart
     scan_init();
+    if (cfg_snapshot.scan_cache_file[0]) {
+        if (scan_cache_attach(cfg_snapshot.scan_cache_file) != 0) {
+            fprintf(stderr, "WARN: could not attach node cache %s\n",
+                    cfg_snapshot.scan_cache_file);
+        }
+    }
     scan_config_t scfg; fill_scan_config(&cfg_snapshot, &scfg);
     scan_seed_self_nodes(&scfg);
     if (cfg_snapshot.enable_scan) (void)scan_start_async(&scfg);
+    if (cfg_snapshot.scan_announce) {
+        (void)scan_announce_start(&scfg, cfg_snapshot.scan_announce_port,
+                                  cfg_snapshot.scan_announce_interval_s);
+    }
 
     if (strcasecmp(cfg_snapshot.sync_role, "slave") == 0) {
         (void)sync_slave_start_thread(&app);
@@ -2179,7 +3498,11 @@ int main(int argc, char **argv){
     run_startup_exec_sequence(&app);
 
     while(!g_stop) sleep(1);
+    scan_announce_stop();
     sync_slave_stop_thread(&app.slave);
     mg_stop(app.ctx);
+    exec_pool_stop();
+    http_pool_close_all();
+    resolver_stop();
     return 0;
 }
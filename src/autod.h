@@ -17,11 +17,13 @@ typedef struct {
 } upload_t;
 
 #define STARTUP_MAX_EXEC 16
+#define EXEC_CACHE_MAX_RULES 16
 
 typedef struct config {
     int  port;
     char bind_addr[64];
     int  enable_scan;
+    int  http_threads;
 
     char sync_role[16];
     char sync_master_url[256];
@@ -34,9 +36,18 @@ typedef struct config {
     scan_extra_subnet_t extra_subnets[SCAN_MAX_EXTRA_SUBNETS];
     unsigned            extra_subnet_count;
 
+    int  scan_announce;
+    int  scan_announce_port;
+    int  scan_announce_interval_s;
+    char scan_cache_file[256];
+
     char interpreter[128];
     int  exec_timeout_ms;
     int  max_output_bytes;
+    int  exec_pool_size;
+
+    int exec_cache_rule_count;
+    struct { char path[128]; int ttl_ms; } exec_cache_rules[EXEC_CACHE_MAX_RULES];
 
     int  startup_exec_count;
     struct { char json[512]; } startup_exec[STARTUP_MAX_EXEC];
@@ -74,6 +85,8 @@ int read_body(struct mg_connection *c, upload_t *u);
 void send_json(struct mg_connection *c, JSON_Value *v, int code, int cors_public);
 void send_plain(struct mg_connection *c, int code, const char *msg, int cors_public);
 void app_config_snapshot(app_t *app, config_t *out);
+const config_t *app_config_acquire(app_t *app);
+void app_config_release(const config_t *cfg);
 void app_rebuild_config_locked(app_t *app);
 void fill_scan_config(const config_t *cfg, scan_config_t *scfg);
 int run_exec(const config_t *cfg, const char *path, JSON_Array *args,
@@ -3277,6 +3277,17 @@ mg_get_user_context_data(const struct mg_connection *conn)
 }
 
 
+/* Local addition (not upstream), see civetweb.h. */
+CIVETWEB_API int
+mg_get_client_socket(const struct mg_connection *conn)
+{
+	if (conn == NULL || conn->ssl != NULL) {
+		return -1;
+	}
+	return (int)conn->client.sock;
+}
+
+
 CIVETWEB_API void *
 mg_get_thread_pointer(const struct mg_connection *conn)
 {
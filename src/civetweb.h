@@ -640,6 +640,13 @@ CIVETWEB_API void *mg_get_user_data(const struct mg_context *ctx);
 CIVETWEB_API void *mg_get_user_context_data(const struct mg_connection *conn);
 
 
+/* Local addition (not upstream): get the raw client socket descriptor so
+   embedders can sendfile() plain-file response bodies after writing the
+   headers themselves. Returns -1 if unavailable or if the connection is
+   TLS-wrapped (raw writes would bypass encryption). */
+CIVETWEB_API int mg_get_client_socket(const struct mg_connection *conn);
+
+
 /* Get user defined thread pointer for server threads (see init_thread). */
 CIVETWEB_API void *mg_get_thread_pointer(const struct mg_connection *conn);
 
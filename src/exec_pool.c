@@ -0,0 +1,452 @@
+/*
+exec_pool.c — pre-spawned exec worker pool
+
+Workers are forked before the HTTP server spins up its threads, each holding
+one end of a SOCK_STREAM socketpair. The parent sends a length-prefixed JSON
+request ({"path","args","timeout_ms","max_bytes"}); the worker forks/execs the
+interpreter, streams output back as framed chunks ('O' stdout, 'E' stderr)
+and finishes with an 'R' frame carrying {"rc","elapsed_ms"}. Forking the
+interpreter from a tiny single-threaded worker is much cheaper than forking
+the full daemon per request, and the frame stream lets callers forward
+output while the command still runs.
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#include "exec_pool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define EXEC_POOL_MAX_WORKERS 16
+#define EXEC_POOL_CHUNK       1024
+
+typedef struct {
+    pid_t pid;
+    int   sock;  // parent end; -1 when the worker is gone
+    int   busy;
+} pool_worker_t;
+
+static pool_worker_t   g_workers[EXEC_POOL_MAX_WORKERS];
+static int             g_worker_count = 0;
+static pthread_mutex_t g_pool_mx = PTHREAD_MUTEX_INITIALIZER;
+
+static long long pool_now_ms(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
+}
+
+// ---------------- framing helpers ----------------
+
+static int write_full(int fd, const void *buf, size_t len) {
+    const char *p = buf;
+    while (len > 0) {
+        ssize_t w = write(fd, p, len);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+static int read_full(int fd, void *buf, size_t len) {
+    char *p = buf;
+    while (len > 0) {
+        ssize_t r = read(fd, p, len);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (r == 0) return -1;
+        p += r;
+        len -= (size_t)r;
+    }
+    return 0;
+}
+
+static int send_frame(int fd, char type, const void *payload, uint32_t len) {
+    char hdr[5];
+    hdr[0] = type;
+    memcpy(hdr + 1, &len, 4);
+    if (write_full(fd, hdr, sizeof(hdr)) != 0) return -1;
+    if (len && write_full(fd, payload, len) != 0) return -1;
+    return 0;
+}
+
+// ---------------- worker side ----------------
+
+static void worker_stream_child(int sock, const char *interpreter,
+                                const char *path, JSON_Array *args,
+                                int timeout_ms, int max_bytes) {
+    int out_pipe[2] = { -1, -1 }, err_pipe[2] = { -1, -1 };
+    long long t0 = pool_now_ms();
+    int rc = -1;
+
+    if (pipe(out_pipe) < 0 || pipe(err_pipe) < 0) goto done;
+
+    pid_t pid = fork();
+    if (pid < 0) goto done;
+
+    if (pid == 0) {
+        dup2(out_pipe[1], STDOUT_FILENO);
+        dup2(err_pipe[1], STDERR_FILENO);
+        close(out_pipe[0]); close(out_pipe[1]);
+        close(err_pipe[0]); close(err_pipe[1]);
+        close(sock);
+
+        size_t narg = args ? json_array_get_count(args) : 0;
+        char **argv = calloc(2 + narg + 1, sizeof(char*));
+        if (!argv) _exit(127);
+        argv[0] = (char*)interpreter;
+        argv[1] = (char*)path;
+        for (size_t i = 0; i < narg; i++) argv[2+i] = (char*)json_array_get_string(args, i);
+        argv[2+narg] = NULL;
+        execv(interpreter, argv);
+        dprintf(STDERR_FILENO, "execv failed: %s\n", strerror(errno));
+        _exit(127);
+    }
+
+    close(out_pipe[1]); out_pipe[1] = -1;
+    close(err_pipe[1]); err_pipe[1] = -1;
+
+    struct pollfd pfds[2] = {
+        { .fd = out_pipe[0], .events = POLLIN },
+        { .fd = err_pipe[0], .events = POLLIN }
+    };
+    int sent[2] = { 0, 0 }; // bytes forwarded per stream (capped at max_bytes)
+    int status = 0, child_done = 0;
+    int remain = timeout_ms;
+
+    while (remain > 0) {
+        int pr = poll(pfds, 2, remain > 100 ? 100 : remain);
+        long long t = pool_now_ms();
+        if (pr < 0 && errno != EINTR) break;
+
+        for (int s = 0; pr > 0 && s < 2; s++) {
+            if (!(pfds[s].revents & (POLLIN | POLLHUP))) continue;
+            char tmp[EXEC_POOL_CHUNK];
+            ssize_t r = read(pfds[s].fd, tmp, sizeof(tmp));
+            if (r > 0) {
+                int space = max_bytes - sent[s];
+                int c = (int)r;
+                if (c > space) c = space;
+                if (c > 0) {
+                    if (send_frame(sock, s ? 'E' : 'O', tmp, (uint32_t)c) != 0) _exit(1);
+                    sent[s] += c;
+                }
+            } else if (r == 0 || (r < 0 && errno != EINTR && errno != EAGAIN)) {
+                pfds[s].events = 0;
+                pfds[s].fd = -1;
+            }
+        }
+
+        pid_t wp = waitpid(pid, &status, WNOHANG);
+        if (wp == pid) { child_done = 1; break; }
+        if (pfds[0].fd < 0 && pfds[1].fd < 0) {
+            wp = waitpid(pid, &status, 0);
+            if (wp == pid) child_done = 1;
+            break;
+        }
+        remain = timeout_ms - (int)(t - t0);
+    }
+
+    // drain whatever is left in the pipes
+    for (int s = 0; s < 2; s++) {
+        int fd = s ? err_pipe[0] : out_pipe[0];
+        if (fd < 0) continue;
+        struct pollfd p = { .fd = fd, .events = POLLIN };
+        while (poll(&p, 1, 0) == 1 && (p.revents & POLLIN)) {
+            char tmp[EXEC_POOL_CHUNK];
+            ssize_t r = read(fd, tmp, sizeof(tmp));
+            if (r <= 0) break;
+            int space = max_bytes - sent[s];
+            int c = (int)r;
+            if (c > space) c = space;
+            if (c > 0) {
+                if (send_frame(sock, s ? 'E' : 'O', tmp, (uint32_t)c) != 0) _exit(1);
+                sent[s] += c;
+            }
+        }
+    }
+
+    if (!child_done) {
+        if (waitpid(pid, &status, WNOHANG) == pid) {
+            child_done = 1;
+        } else {
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            rc = 124;
+        }
+    }
+    if (child_done) {
+        if (WIFEXITED(status)) rc = WEXITSTATUS(status);
+        else rc = 128;
+    }
+
+done:
+    if (out_pipe[0] >= 0) close(out_pipe[0]);
+    if (out_pipe[1] >= 0) close(out_pipe[1]);
+    if (err_pipe[0] >= 0) close(err_pipe[0]);
+    if (err_pipe[1] >= 0) close(err_pipe[1]);
+
+    {
+        JSON_Value *rv = json_value_init_object();
+        JSON_Object *ro = json_object(rv);
+        json_object_set_number(ro, "rc", rc);
+        json_object_set_number(ro, "elapsed_ms", (double)(pool_now_ms() - t0));
+        char *s = json_serialize_to_string(rv);
+        if (!s || send_frame(sock, 'R', s, (uint32_t)strlen(s)) != 0) _exit(1);
+        json_free_serialized_string(s);
+        json_value_free(rv);
+    }
+}
+
+static void worker_main(int sock, const char *interpreter) {
+    signal(SIGINT, SIG_IGN); // parent handles shutdown; we exit on socket EOF
+
+    for (;;) {
+        uint32_t len = 0;
+        if (read_full(sock, &len, sizeof(len)) != 0) _exit(0);
+        if (len == 0 || len > 1u << 20) _exit(0);
+
+        char *req = malloc(len + 1);
+        if (!req) _exit(1);
+        if (read_full(sock, req, len) != 0) { free(req); _exit(0); }
+        req[len] = '\0';
+
+        JSON_Value *rv = json_parse_string(req);
+        free(req);
+        if (!rv) _exit(1);
+        JSON_Object *ro = json_object(rv);
+        const char *path = json_object_get_string(ro, "path");
+        JSON_Array *args = json_object_get_array(ro, "args");
+        int timeout_ms = (int)json_object_get_number(ro, "timeout_ms");
+        int max_bytes  = (int)json_object_get_number(ro, "max_bytes");
+        if (timeout_ms <= 0) timeout_ms = 5000;
+        if (max_bytes <= 0) max_bytes = 65536;
+
+        if (path && *path) {
+            worker_stream_child(sock, interpreter, path, args, timeout_ms, max_bytes);
+        } else {
+            const char *err = "{\"rc\":127,\"elapsed_ms\":0}";
+            if (send_frame(sock, 'R', err, (uint32_t)strlen(err)) != 0) {
+                json_value_free(rv);
+                _exit(1);
+            }
+        }
+        json_value_free(rv);
+    }
+}
+
+// ---------------- parent side ----------------
+
+int exec_pool_start(const char *interpreter, int workers) {
+    if (!interpreter || !*interpreter || workers <= 0) return -1;
+    if (workers > EXEC_POOL_MAX_WORKERS) workers = EXEC_POOL_MAX_WORKERS;
+    if (g_worker_count > 0) return -1; // already running
+
+    for (int i = 0; i < workers; i++) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0) break;
+
+        pid_t pid = fork();
+        if (pid < 0) { close(sv[0]); close(sv[1]); break; }
+        if (pid == 0) {
+            close(sv[0]);
+            // close the other workers' parent-side sockets we inherited
+            for (int j = 0; j < g_worker_count; j++) {
+                if (g_workers[j].sock >= 0) close(g_workers[j].sock);
+            }
+            worker_main(sv[1], interpreter);
+            _exit(0);
+        }
+        close(sv[1]);
+        g_workers[g_worker_count].pid  = pid;
+        g_workers[g_worker_count].sock = sv[0];
+        g_workers[g_worker_count].busy = 0;
+        g_worker_count++;
+    }
+    return g_worker_count > 0 ? 0 : -1;
+}
+
+void exec_pool_stop(void) {
+    pthread_mutex_lock(&g_pool_mx);
+    for (int i = 0; i < g_worker_count; i++) {
+        if (g_workers[i].sock >= 0) { close(g_workers[i].sock); g_workers[i].sock = -1; }
+        if (g_workers[i].pid > 0) {
+            kill(g_workers[i].pid, SIGTERM);
+            waitpid(g_workers[i].pid, NULL, 0);
+            g_workers[i].pid = -1;
+        }
+    }
+    g_worker_count = 0;
+    pthread_mutex_unlock(&g_pool_mx);
+}
+
+static pool_worker_t *pool_acquire(void) {
+    pool_worker_t *w = NULL;
+    pthread_mutex_lock(&g_pool_mx);
+    for (int i = 0; i < g_worker_count; i++) {
+        if (!g_workers[i].busy && g_workers[i].sock >= 0) {
+            g_workers[i].busy = 1;
+            w = &g_workers[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_pool_mx);
+    return w;
+}
+
+static void pool_release(pool_worker_t *w, int dead) {
+    pthread_mutex_lock(&g_pool_mx);
+    if (dead) {
+        // No respawn here: forking from the threaded daemon is unsafe.
+        // The pool just shrinks; callers fall back to direct exec.
+        if (w->sock >= 0) { close(w->sock); w->sock = -1; }
+        if (w->pid > 0) { kill(w->pid, SIGKILL); waitpid(w->pid, NULL, 0); w->pid = -1; }
+    }
+    w->busy = 0;
+    pthread_mutex_unlock(&g_pool_mx);
+}
+
+int exec_pool_run_cb(const char *path, JSON_Array *args,
+                     int timeout_ms, int max_bytes,
+                     int *rc_out, long long *elapsed_ms,
+                     exec_pool_chunk_fn on_chunk, void *ud) {
+    if (!path || !rc_out || !elapsed_ms) return -1;
+
+    pool_worker_t *w = pool_acquire();
+    if (!w) return 1;
+
+    // Build the request
+    JSON_Value *rv = json_value_init_object();
+    JSON_Object *ro = json_object(rv);
+    json_object_set_string(ro, "path", path);
+    if (args) {
+        JSON_Value *av = json_value_deep_copy(json_array_get_wrapping_value(args));
+        if (av) json_object_set_value(ro, "args", av);
+    }
+    json_object_set_number(ro, "timeout_ms", timeout_ms);
+    json_object_set_number(ro, "max_bytes", max_bytes);
+    char *req = json_serialize_to_string(rv);
+    json_value_free(rv);
+    if (!req) { pool_release(w, 0); return -1; }
+
+    uint32_t len = (uint32_t)strlen(req);
+    int werr = (write_full(w->sock, &len, sizeof(len)) != 0 ||
+                write_full(w->sock, req, len) != 0);
+    json_free_serialized_string(req);
+    if (werr) {
+        pool_release(w, 1);
+        return 1; // request never reached a worker; safe to fall back
+    }
+
+    // Read frames until the result; the worker enforces the command timeout,
+    // this deadline only guards against a wedged worker.
+    long long deadline = pool_now_ms() + timeout_ms + 3000;
+    int ret = -1;
+
+    for (;;) {
+        long long left = deadline - pool_now_ms();
+        if (left <= 0) break;
+        struct pollfd p = { .fd = w->sock, .events = POLLIN };
+        int pr = poll(&p, 1, (int)(left > 250 ? 250 : left));
+        if (pr < 0 && errno != EINTR) break;
+        if (pr <= 0) continue;
+
+        char hdr[5];
+        if (read_full(w->sock, hdr, sizeof(hdr)) != 0) break;
+        uint32_t plen;
+        memcpy(&plen, hdr + 1, 4);
+        if (plen > 1u << 20) break;
+
+        char *payload = NULL;
+        if (plen) {
+            payload = malloc(plen + 1);
+            if (!payload || read_full(w->sock, payload, plen) != 0) { free(payload); break; }
+            payload[plen] = '\0';
+        }
+
+        if (hdr[0] == 'O' || hdr[0] == 'E') {
+            if (on_chunk && payload) on_chunk(hdr[0] == 'E', payload, plen, ud);
+            free(payload);
+            continue;
+        }
+        if (hdr[0] == 'R') {
+            JSON_Value *res = payload ? json_parse_string(payload) : NULL;
+            free(payload);
+            if (res) {
+                JSON_Object *reso = json_object(res);
+                *rc_out = (int)json_object_get_number(reso, "rc");
+                *elapsed_ms = (long long)json_object_get_number(reso, "elapsed_ms");
+                json_value_free(res);
+                ret = 0;
+            }
+            break;
+        }
+        free(payload);
+        break;
+    }
+
+    pool_release(w, ret != 0);
+    return ret; // -1 after dispatch: caller must not re-run the command
+}
+
+typedef struct {
+    char *out;
+    char *err;
+    int   wout, werr;
+    int   max_bytes;
+} buf_sink_t;
+
+static void buffered_chunk(int is_err, const char *data, size_t len, void *ud) {
+    buf_sink_t *b = ud;
+    char *dst   = is_err ? b->err : b->out;
+    int  *count = is_err ? &b->werr : &b->wout;
+    int space = b->max_bytes - *count;
+    int c = (int)len;
+    if (c > space) c = space;
+    if (c > 0) {
+        memcpy(dst + *count, data, (size_t)c);
+        *count += c;
+    }
+}
+
+int exec_pool_run(const char *path, JSON_Array *args,
+                  int timeout_ms, int max_bytes,
+                  int *rc_out, long long *elapsed_ms,
+                  char **out_stdout, char **out_stderr) {
+    buf_sink_t sink = {0};
+    sink.max_bytes = max_bytes;
+    sink.out = malloc(max_bytes + 1);
+    sink.err = malloc(max_bytes + 1);
+    if (!sink.out || !sink.err) {
+        free(sink.out); free(sink.err);
+        return -1;
+    }
+
+    int r = exec_pool_run_cb(path, args, timeout_ms, max_bytes,
+                             rc_out, elapsed_ms, buffered_chunk, &sink);
+    if (r != 0) {
+        free(sink.out); free(sink.err);
+        return r;
+    }
+    sink.out[sink.wout] = '\0';
+    sink.err[sink.werr] = '\0';
+    *out_stdout = sink.out;
+    *out_stderr = sink.err;
+    return 0;
+}
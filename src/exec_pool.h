@@ -0,0 +1,40 @@
+#ifndef AUTOD_EXEC_POOL_H
+#define AUTOD_EXEC_POOL_H
+
+#include <stddef.h>
+
+#include "parson.h"
+
+// Pre-spawned exec worker pool. Workers are forked at startup (before the
+// HTTP server creates its threads) and each runs the interpreter on request,
+// so steady-state /exec dispatch is a couple of pipe writes instead of a
+// fork of the full multi-threaded daemon.
+
+struct config;
+
+// Chunk callback used while a command runs: is_err selects stderr vs stdout.
+typedef void (*exec_pool_chunk_fn)(int is_err, const char *data, size_t len, void *ud);
+
+// Fork `workers` helper processes running `interpreter`. Call once, before
+// the HTTP server starts. Returns 0 on success, -1 on error (pool disabled).
+int exec_pool_start(const char *interpreter, int workers);
+
+// Terminate all workers (best effort). Safe if the pool never started.
+void exec_pool_stop(void);
+
+// Dispatch one command to a free worker, invoking on_chunk as output
+// arrives. Returns 0 on success (rc/elapsed filled), 1 when no worker is
+// available (caller should fall back to a direct fork), -1 on a dispatch
+// failure after the command may have started (caller must not retry).
+int exec_pool_run_cb(const char *path, JSON_Array *args,
+                     int timeout_ms, int max_bytes,
+                     int *rc_out, long long *elapsed_ms,
+                     exec_pool_chunk_fn on_chunk, void *ud);
+
+// Buffered convenience wrapper with run_exec()-compatible outputs.
+int exec_pool_run(const char *path, JSON_Array *args,
+                  int timeout_ms, int max_bytes,
+                  int *rc_out, long long *elapsed_ms,
+                  char **out_stdout, char **out_stderr);
+
+#endif
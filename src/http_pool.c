@@ -0,0 +1,429 @@
+/*
+ * http_pool.c — keep-alive HTTP/1.1 client with a per-target connection pool.
+ *
+ * Responses are framed by Content-Length or chunked transfer-encoding; only
+ * a cleanly framed exchange parks the connection for reuse. Unframed
+ * (read-to-EOF) responses and anything carrying "Connection: close" fall
+ * back to one-shot behaviour, so talking to plain HTTP/1.0 peers still works.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "http_pool.h"
+#include "resolver.h"
+
+enum {
+    POOL_SLOTS   = 8,
+    POOL_IDLE_MS = 30000, // drop parked sockets idle longer than this
+};
+
+typedef struct {
+    char      host[64]; // "" = free slot
+    int       port;
+    int       fd;
+    long long parked_ms;
+} pool_conn_t;
+
+static pool_conn_t g_pool[POOL_SLOTS];
+static pthread_mutex_t g_pool_mx = PTHREAD_MUTEX_INITIALIZER;
+
+static long long pool_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
+}
+
+/* A parked socket is healthy when a non-blocking peek reports "would
+   block": EOF or stray bytes both mean the peer gave up on it. */
+static int conn_is_alive(int fd) {
+    char b;
+    ssize_t r = recv(fd, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 1;
+    return 0;
+}
+
+static void conn_set_timeout(int fd, int timeout_ms) {
+    struct timeval tv;
+    if (timeout_ms < 1) timeout_ms = 1;
+    tv.tv_sec = timeout_ms / 1000;
+    tv.tv_usec = (timeout_ms % 1000) * 1000;
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    (void)setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+static int pool_take(const char *host, int port) {
+    int fd = -1;
+    pthread_mutex_lock(&g_pool_mx);
+    long long now = pool_now_ms();
+    for (int i = 0; i < POOL_SLOTS; i++) {
+        pool_conn_t *e = &g_pool[i];
+        if (!e->host[0]) continue;
+        int stale = (now - e->parked_ms) > POOL_IDLE_MS;
+        if (stale) {
+            close(e->fd);
+            e->host[0] = '\0';
+            continue;
+        }
+        if (e->port != port || strcmp(e->host, host) != 0) continue;
+        if (!conn_is_alive(e->fd)) {
+            close(e->fd);
+            e->host[0] = '\0';
+            continue;
+        }
+        fd = e->fd;
+        e->host[0] = '\0';
+        break;
+    }
+    pthread_mutex_unlock(&g_pool_mx);
+    return fd;
+}
+
+static void pool_park(const char *host, int port, int fd) {
+    pthread_mutex_lock(&g_pool_mx);
+    pool_conn_t *slot = NULL;
+    pool_conn_t *oldest = NULL;
+    for (int i = 0; i < POOL_SLOTS; i++) {
+        pool_conn_t *e = &g_pool[i];
+        if (!e->host[0]) { slot = e; break; }
+        if (!oldest || e->parked_ms < oldest->parked_ms) oldest = e;
+    }
+    if (!slot && oldest) {
+        close(oldest->fd);
+        oldest->host[0] = '\0';
+        slot = oldest;
+    }
+    if (slot) {
+        snprintf(slot->host, sizeof(slot->host), "%s", host);
+        slot->port = port;
+        slot->fd = fd;
+        slot->parked_ms = pool_now_ms();
+    } else {
+        close(fd);
+    }
+    pthread_mutex_unlock(&g_pool_mx);
+}
+
+static int pool_connect(const char *host, int port, int timeout_ms) {
+    struct sockaddr_storage ss;
+    socklen_t slen = 0;
+    int rr = resolver_resolve(host, port, timeout_ms, &ss, &slen, NULL, 0);
+    if (rr == RESOLVE_TIMEOUT) {
+        errno = ETIMEDOUT;
+        return -3; // resolver deadline hit (the caller answers 504)
+    }
+    if (rr != RESOLVE_OK) {
+        errno = EHOSTUNREACH;
+        return -2; // resolve failure (distinct from connect failure)
+    }
+
+    int fd = socket(ss.ss_family, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) return -1;
+    conn_set_timeout(fd, timeout_ms);
+    int one = 1;
+    (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, (struct sockaddr *)&ss, slen) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+static int send_all(int fd, const void *buf, size_t len) {
+    const char *p = (const char *)buf;
+    size_t off = 0;
+    while (off < len) {
+        ssize_t w = send(fd, p + off, len - off, 0);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (w == 0) { errno = EPIPE; return -1; }
+        off += (size_t)w;
+    }
+    return 0;
+}
+
+/* Case-insensitive header lookup in a raw header block. Returns a pointer
+   to the value (after the colon, spaces skipped) or NULL. */
+static const char *header_find(const char *headers, const char *name) {
+    size_t name_len = strlen(name);
+    const char *p = headers;
+    while (p && *p) {
+        const char *eol = strstr(p, "\r\n");
+        size_t line_len = eol ? (size_t)(eol - p) : strlen(p);
+        if (line_len > name_len + 1 &&
+            strncasecmp(p, name, name_len) == 0 && p[name_len] == ':') {
+            const char *v = p + name_len + 1;
+            while (*v == ' ' || *v == '\t') v++;
+            return v;
+        }
+        if (!eol) break;
+        p = eol + 2;
+    }
+    return NULL;
+}
+
+typedef struct {
+    char  *buf;
+    size_t len;
+    size_t cap;
+} growbuf_t;
+
+static int growbuf_put(growbuf_t *g, const char *data, size_t n, size_t max) {
+    if (g->len + n + 1 > max) return -1;
+    if (g->len + n + 1 > g->cap) {
+        size_t ncap = g->cap ? g->cap : 4096;
+        while (g->len + n + 1 > ncap) ncap *= 2;
+        char *nb = (char *)realloc(g->buf, ncap);
+        if (!nb) return -1;
+        g->buf = nb;
+        g->cap = ncap;
+    }
+    memcpy(g->buf + g->len, data, n);
+    g->len += n;
+    g->buf[g->len] = '\0';
+    return 0;
+}
+
+/* Read more bytes into g, honouring the overall deadline. Returns bytes
+   read, 0 on EOF, -1 on error/timeout. */
+static ssize_t read_more(int fd, growbuf_t *g, size_t max, long long deadline_ms) {
+    long long left = deadline_ms - pool_now_ms();
+    if (left <= 0) { errno = ETIMEDOUT; return -1; }
+    if (left > 600000) left = 600000;
+    conn_set_timeout(fd, (int)left);
+    char chunk[4096];
+    for (;;) {
+        ssize_t r = recv(fd, chunk, sizeof(chunk), 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return r;
+        if (growbuf_put(g, chunk, (size_t)r, max) != 0) { errno = EMSGSIZE; return -1; }
+        return r;
+    }
+}
+
+/* Decode a chunked body in place from raw[ofs..len) plus further reads.
+   Appends decoded bytes to out. Returns 0 done, -1 error. */
+static int read_chunked(int fd, growbuf_t *raw, size_t *ofs, growbuf_t *out,
+                        size_t max, long long deadline_ms) {
+    for (;;) {
+        // need a full "size\r\n" line
+        char *line_end;
+        while ((line_end = strstr(raw->buf + *ofs, "\r\n")) == NULL) {
+            if (read_more(fd, raw, max, deadline_ms) <= 0) return -1;
+        }
+        unsigned long chunk_len = strtoul(raw->buf + *ofs, NULL, 16);
+        *ofs = (size_t)(line_end - raw->buf) + 2;
+        if (chunk_len == 0) {
+            // swallow (empty) trailer up to final CRLF
+            while (raw->len < *ofs + 2) {
+                if (read_more(fd, raw, max, deadline_ms) <= 0) return -1;
+            }
+            return 0;
+        }
+        while (raw->len < *ofs + chunk_len + 2) {
+            if (read_more(fd, raw, max, deadline_ms) <= 0) return -1;
+        }
+        if (growbuf_put(out, raw->buf + *ofs, chunk_len, max) != 0) return -1;
+        *ofs += chunk_len + 2; // skip data + CRLF
+    }
+}
+
+int http_pool_request(const char *host, int port,
+                      const char *method, const char *path,
+                      const char *extra_headers,
+                      const void *body, size_t body_len,
+                      int timeout_ms, size_t max_resp,
+                      http_pool_resp_t *resp, const char **err_code) {
+    if (err_code) *err_code = NULL;
+    if (!host || !*host || port <= 0 || !method || !path || !resp) {
+        if (err_code) *err_code = "connect_failed";
+        return -1;
+    }
+    memset(resp, 0, sizeof(*resp));
+    if (timeout_ms < 1) timeout_ms = 1;
+    if (max_resp == 0) max_resp = 65536;
+    long long deadline_ms = pool_now_ms() + timeout_ms;
+
+    char header[1024];
+    int header_len = snprintf(header, sizeof(header),
+                              "%s %s HTTP/1.1\r\n"
+                              "Host: %s\r\n"
+                              "%s"
+                              "Content-Length: %zu\r\n"
+                              "Connection: keep-alive\r\n\r\n",
+                              method, path, host,
+                              extra_headers ? extra_headers : "",
+                              body_len);
+    if (header_len <= 0 || header_len >= (int)sizeof(header)) {
+        if (err_code) *err_code = "send_failed";
+        return -1;
+    }
+
+    int reused = 1;
+    int fd = pool_take(host, port);
+    if (fd < 0) {
+        reused = 0;
+        fd = pool_connect(host, port, timeout_ms);
+        if (fd < 0) {
+            if (err_code) *err_code = (fd == -3) ? "resolve_timeout"
+                                    : (fd == -2) ? "resolve_failed"
+                                                 : "connect_failed";
+            return -1;
+        }
+    } else {
+        conn_set_timeout(fd, timeout_ms);
+    }
+
+    if (send_all(fd, header, (size_t)header_len) != 0 ||
+        (body_len > 0 && send_all(fd, body, body_len) != 0)) {
+        close(fd);
+        if (reused) {
+            // parked socket died between peek and send: retry once, fresh
+            fd = pool_connect(host, port, timeout_ms);
+            if (fd < 0 ||
+                send_all(fd, header, (size_t)header_len) != 0 ||
+                (body_len > 0 && send_all(fd, body, body_len) != 0)) {
+                if (fd >= 0) close(fd);
+                if (err_code) *err_code = "send_failed";
+                return -1;
+            }
+        } else {
+            if (err_code) *err_code = "send_failed";
+            return -1;
+        }
+    }
+
+    growbuf_t raw = {0};
+    char *hdr_end;
+    for (;;) {
+        if (raw.buf && (hdr_end = strstr(raw.buf, "\r\n\r\n")) != NULL) break;
+        ssize_t r = read_more(fd, &raw, max_resp, deadline_ms);
+        if (r <= 0) {
+            free(raw.buf);
+            close(fd);
+            if (err_code) *err_code = "recv_failed";
+            return -1;
+        }
+    }
+
+    size_t header_block_len = (size_t)(hdr_end - raw.buf);
+    size_t body_ofs = header_block_len + 4;
+
+    int status = 0;
+    sscanf(raw.buf, "HTTP/%*s %d", &status);
+
+    char saved = raw.buf[header_block_len];
+    raw.buf[header_block_len] = '\0';
+    const char *cl = header_find(raw.buf, "Content-Length");
+    const char *te = header_find(raw.buf, "Transfer-Encoding");
+    const char *cn = header_find(raw.buf, "Connection");
+    int is_http11 = (strncmp(raw.buf, "HTTP/1.1", 8) == 0);
+    char *headers_copy = (char *)malloc(header_block_len + 1);
+    if (headers_copy) memcpy(headers_copy, raw.buf, header_block_len + 1);
+    raw.buf[header_block_len] = saved;
+    if (!headers_copy) {
+        free(raw.buf);
+        close(fd);
+        if (err_code) *err_code = "recv_failed";
+        return -1;
+    }
+
+    int no_body = (strcasecmp(method, "HEAD") == 0 || status == 204 || status == 304);
+    int chunked = te && strncasecmp(te, "chunked", 7) == 0;
+    int reusable = 0;
+    growbuf_t out = {0};
+    int ok = 0;
+
+    if (no_body) {
+        ok = 1;
+        reusable = 1;
+    } else if (chunked) {
+        size_t ofs = body_ofs;
+        ok = (read_chunked(fd, &raw, &ofs, &out, max_resp, deadline_ms) == 0);
+        reusable = ok;
+    } else if (cl) {
+        size_t want = (size_t)strtoul(cl, NULL, 10);
+        if (want <= max_resp) {
+            while (raw.len < body_ofs + want) {
+                if (read_more(fd, &raw, max_resp, deadline_ms) <= 0) break;
+            }
+            if (raw.len >= body_ofs + want &&
+                growbuf_put(&out, raw.buf + body_ofs, want, max_resp + 1) == 0) {
+                ok = 1;
+                reusable = 1;
+            }
+        }
+    } else {
+        // no framing: drain to EOF, connection is spent
+        for (;;) {
+            ssize_t r = read_more(fd, &raw, max_resp, deadline_ms);
+            if (r == 0) { ok = 1; break; }
+            if (r < 0) break;
+        }
+        if (ok) (void)growbuf_put(&out, raw.buf + body_ofs, raw.len - body_ofs, max_resp + 1);
+    }
+
+    if (cn && strncasecmp(cn, "close", 5) == 0) reusable = 0;
+    if (!is_http11 && !(cn && strncasecmp(cn, "keep-alive", 10) == 0)) reusable = 0;
+
+    free(raw.buf);
+    if (!ok) {
+        free(headers_copy);
+        free(out.buf);
+        close(fd);
+        if (err_code) *err_code = "recv_failed";
+        return -1;
+    }
+
+    if (reusable) {
+        pool_park(host, port, fd);
+    } else {
+        close(fd);
+    }
+
+    if (!out.buf) {
+        out.buf = (char *)malloc(1);
+        if (out.buf) out.buf[0] = '\0';
+    }
+    resp->status = status;
+    resp->headers = headers_copy;
+    resp->body = out.buf;
+    resp->body_len = out.len;
+    return 0;
+}
+
+void http_pool_resp_free(http_pool_resp_t *resp) {
+    if (!resp) return;
+    free(resp->headers);
+    free(resp->body);
+    memset(resp, 0, sizeof(*resp));
+}
+
+void http_pool_close_all(void) {
+    pthread_mutex_lock(&g_pool_mx);
+    for (int i = 0; i < POOL_SLOTS; i++) {
+        if (g_pool[i].host[0]) {
+            close(g_pool[i].fd);
+            g_pool[i].host[0] = '\0';
+        }
+    }
+    pthread_mutex_unlock(&g_pool_mx);
+}
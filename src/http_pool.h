@@ -0,0 +1,38 @@
+#ifndef AUTOD_HTTP_POOL_H
+#define AUTOD_HTTP_POOL_H
+
+#include <stddef.h>
+
+/*
+ * Small keep-alive HTTP/1.1 client shared by the /http proxy and the sync
+ * slave thread. Idle connections are parked per host:port and reused for
+ * the next request to the same peer, so repeat traffic to a slave skips
+ * the TCP handshake and the TIME_WAIT churn of one-shot sockets.
+ */
+
+typedef struct {
+    int    status;    // parsed HTTP status code (0 if unparsable)
+    char  *headers;   // malloc'd raw header block incl. status line, NUL-terminated
+    char  *body;      // malloc'd body bytes (NUL-terminated; may contain binary)
+    size_t body_len;
+} http_pool_resp_t;
+
+// Issue one request over a pooled (or fresh) connection. extra_headers, when
+// given, must be pre-formatted "Name: value\r\n" lines; Host, Connection and
+// Content-Length are managed by the pool and must not be included. Returns 0
+// with *resp filled on success, -1 on transport failure (err_code, when
+// non-NULL, is set to "resolve_failed"/"resolve_timeout"/"connect_failed"/
+// "send_failed"/"recv_failed" for the caller's error report).
+int http_pool_request(const char *host, int port,
+                      const char *method, const char *path,
+                      const char *extra_headers,
+                      const void *body, size_t body_len,
+                      int timeout_ms, size_t max_resp,
+                      http_pool_resp_t *resp, const char **err_code);
+
+void http_pool_resp_free(http_pool_resp_t *resp);
+
+// Close all parked connections (shutdown).
+void http_pool_close_all(void);
+
+#endif
@@ -4,6 +4,9 @@
 // - UDP coalescing: size threshold + short idle before send
 // - Short-write safe: ring buffers for both directions (non-blocking)
 // - SIGHUP: reload /etc/ip2uart.conf and reopen resources
+// - engine=epoll (default) | io_uring: io_uring submits UART reads, UDP
+//   sends and timer waits as batched SQEs (one enter per wakeup); falls
+//   back to epoll at runtime on kernels without the needed ops
 // - Verbose logging: -v prints one-line stats once per second
 // SPDX-License-Identifier: MIT
 
@@ -19,6 +22,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <termios.h>
@@ -31,6 +36,15 @@
 #include <time.h>
 #include <unistd.h>
 
+#if defined(__linux__) && defined(__has_include)
+# if __has_include(<linux/io_uring.h>)
+#  include <linux/io_uring.h>
+#  ifdef IO_URING_OP_SUPPORTED /* probe API present (5.6+ headers) */
+#   define HAVE_IO_URING 1
+#  endif
+# endif
+#endif
+
 #define DEFAULT_CONF "/etc/ip2uart.conf"
 #define MAX_LINE     512
 #define MAX_KEY      64
@@ -57,40 +71,14 @@ static void vlog(int level, const char *fmt, ...){
 }
 
 /* ----------------- Small ring buffer (non-blocking IO helper) ----------------- */
-typedef struct { uint8_t *buf; size_t cap, head, tail, len; } ringbuf_t;
-static int    ring_init (ringbuf_t *r, size_t cap){
-    r->buf=NULL; r->cap=r->head=r->tail=r->len=0;
-    if(!cap) return 0;
-    r->buf=(uint8_t*)malloc(cap);
-    if(!r->buf){ errno=ENOMEM; return -1; }
-    r->cap=cap;
-    return 0;
-}
-static void   ring_free (ringbuf_t *r){ free(r->buf); r->buf=NULL; r->cap=r->head=r->tail=r->len=0; }
-static size_t ring_space(const ringbuf_t *r){ return r->cap - r->len; }
-static size_t ring_write(ringbuf_t *r, const uint8_t *src, size_t n){
-    if (!r->cap || !n) return 0;
-    size_t w = n>ring_space(r)?ring_space(r):n;
-    size_t first = w>(r->cap-r->head) ? (r->cap-r->head) : w;
-    if (first) memcpy(r->buf + r->head, src, first);
-    size_t second = w - first;
-    if (second) memcpy(r->buf, src + first, second);
-    r->head = (r->head + w) % r->cap; r->len += w;
-    return w;
-}
-static size_t ring_peek(const ringbuf_t *r, const uint8_t **p1, size_t *l1, const uint8_t **p2, size_t *l2){
-    if (!r->len){ *p1=*p2=NULL; *l1=*l2=0; return 0; }
-    size_t first = r->len>(r->cap-r->tail) ? (r->cap-r->tail) : r->len;
-    *p1 = r->buf + r->tail; *l1 = first; *p2 = NULL; *l2 = 0;
-    if (r->len > first){ *p2 = r->buf; *l2 = r->len - first; }
-    return r->len;
-}
-static void ring_consume(ringbuf_t *r, size_t n){ if (n>r->len) n=r->len; r->tail=(r->tail+n)%r->cap; r->len-=n; }
+/* mirror-mapped SPSC ring, shared with udp_relay */
+#include "ringbuf.h"
 
 /* --------------------------------- Config ----------------------------------- */
 typedef struct {
     // Selectors
     uart_backend_t uart_backend;   // tty | stdio
+    int  engine_uring;             // engine=io_uring (0 = epoll)
 
     // CRSF parser
     int  crsf_detect;              // 0 | 1
@@ -208,6 +196,11 @@ typedef struct {
 /* Forward declarations */
 static void uart_forward_with_coalesce(const config_t *cfg, state_t *st,
                                        const uint8_t *data, size_t n);
+#ifdef HAVE_IO_URING
+struct uring_bridge;
+static struct uring_bridge *g_uring_bridge; /* set while the io_uring loop runs */
+static void uring_submit_udp_send(state_t *st);
+#endif
 
 /* ------------------------------- Signals ------------------------------------ */
 static volatile sig_atomic_t g_reload = 0, g_stop = 0;
@@ -272,6 +265,7 @@ static int parse_config(const char *path, config_t *cfg){
     memset(cfg,0,sizeof(*cfg));
     // Defaults
     cfg->uart_backend = UART_TTY;
+    cfg->engine_uring = 0;
     cfg->crsf_detect = 0;
     cfg->crsf_log = 0;
     strcpy(cfg->crsf_log_path, "/tmp/crsf_log.msg");
@@ -299,6 +293,9 @@ static int parse_config(const char *path, config_t *cfg){
         if(!strcmp(key,"uart_backend")){
             if(!strcmp(val,"tty")) cfg->uart_backend=UART_TTY;
             else if(!strcmp(val,"stdio")) cfg->uart_backend=UART_STDIO;
+        } else if(!strcmp(key,"engine")){
+            if(!strcmp(val,"io_uring")) cfg->engine_uring=1;
+            else if(!strcmp(val,"epoll")) cfg->engine_uring=0;
         } else if(!strcmp(key,"net_mode")){
             if(strcmp(val,"udp_peer")){
                 fclose(f);
@@ -410,11 +407,11 @@ static void close_fd(int *fd){ if(*fd>=0){ close(*fd); *fd=-1; } }
 
 /* --------------------------- Short-write helpers ---------------------------- */
 static ssize_t write_from_ring_fd(int fd, ringbuf_t *r){
-    const uint8_t *p1,*p2; size_t l1,l2; ssize_t total=0;
-    ring_peek(r,&p1,&l1,&p2,&l2);
-    if(l1){ ssize_t w=write(fd,p1,l1); if(w>0){ ring_consume(r,(size_t)w); total+=w; } else return w; }
-    if(r->len && l2){ ring_peek(r,&p1,&l1,&p2,&l2); if(l2){ ssize_t w=write(fd,p2,l2); if(w>0){ ring_consume(r,(size_t)w); total+=w; } else return (total>0?total:w); } }
-    return total;
+    const uint8_t *p; size_t l=ring_read_span(r,&p);
+    if(!l) return 0;
+    ssize_t w=write(fd,p,l);
+    if(w>0) ring_consume(r,(size_t)w);
+    return w;
 }
 
 /* ------------------------ Open/close based on config ------------------------ */
@@ -476,6 +473,9 @@ static void udp_flush_if_ready(const config_t *cfg, state_t *st, bool force, con
     bool send_now = force || size_ready || cfg->udp_coalesce_idle_ms==0;
     if(!send_now) return;
 
+#ifdef HAVE_IO_URING
+    if (g_uring_bridge){ uring_submit_udp_send(st); return; }
+#endif
     ssize_t w = sendto(st->fd_net, st->udp_out, st->udp_out_len, 0,
                        (struct sockaddr*)&st->udp_peer, sizeof(st->udp_peer));
     if(w==(ssize_t)st->udp_out_len){
@@ -982,6 +982,549 @@ static void uart_forward_with_coalesce(const config_t *cfg, state_t *st,
         st->udp_out_len >= (size_t)cfg->udp_coalesce_bytes ? "size_threshold" : "pending");
 }
 
+
+/* --------------------- Shared event handlers (both engines) ------------------ */
+static void handle_uart_data(const config_t *cfg, state_t *st, crsf_monitor_t *crsf,
+                             const uint8_t *data, size_t n){
+    bool crsf_mode = cfg->crsf_detect != 0;
+    get_mono(&st->last_uart_rx);
+    if (crsf->enabled) {
+        crsf_monitor_feed(crsf, CRSF_FROM_UART, data, n);
+    }
+    if (crsf_mode) {
+        crsf_forward_feed(cfg, st, data, n);
+    } else {
+        uart_forward_with_coalesce(cfg, st, data, n);
+    }
+}
+
+/* defer_uart_write: the io_uring engine queues NET->UART bytes on the ring and
+   lets the loop submit the write SQE; the epoll engine writes inline and only
+   falls back to the ring on short writes. */
+static void handle_net_data(const config_t *cfg, state_t *st, crsf_monitor_t *crsf,
+                            const uint8_t *data, size_t n,
+                            const struct sockaddr_in *from, bool defer_uart_write){
+    if (crsf->enabled) {
+        crsf_monitor_feed(crsf, CRSF_FROM_UDP, data, n);
+    }
+    if(!cfg->udp_peer_addr[0]){
+        bool changed = !st->udp_peer_set ||
+            st->udp_peer.sin_addr.s_addr!=from->sin_addr.s_addr ||
+            st->udp_peer.sin_port!=from->sin_port;
+        if(changed){
+            st->udp_peer = *from; st->udp_peer_set=true;
+            char ipbuf[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET,&from->sin_addr,ipbuf,sizeof(ipbuf));
+            vlog(1, "UDP: learned peer %s:%d", ipbuf, ntohs(from->sin_port));
+        }
+    }
+    if (defer_uart_write){
+        size_t wr=ring_write(&st->uart_out, data, n);
+        if(wr<n) st->drops_net_to_uart+=(uint64_t)(n-wr);
+        return;
+    }
+    int outfd = (cfg->uart_backend==UART_STDIO)? STDOUT_FILENO : st->fd_uart;
+    ssize_t w=write(outfd, data, n);
+    if(w>0){
+        st->bytes_net_to_uart+=(uint64_t)w; st->pkts_net_to_uart+=1;
+        if((size_t)w<n){
+            size_t rem=n-(size_t)w;
+            size_t wr=ring_write(&st->uart_out, data+w, rem);
+            if(wr<rem) st->drops_net_to_uart+=(uint64_t)(rem-wr);
+            if(cfg->uart_backend==UART_STDIO){
+                if(!st->stdout_registered){ add_ep(st->epfd, STDOUT_FILENO, EPOLLOUT); st->stdout_registered=true; }
+            } else {
+                mod_ep(st->epfd, st->fd_uart, EPOLLIN|EPOLLOUT);
+            }
+        }
+    } else if(w<0 && (errno==EAGAIN||errno==EWOULDBLOCK)){
+        size_t wr=ring_write(&st->uart_out, data, n);
+        if(wr<n) st->drops_net_to_uart+=(uint64_t)(n-wr);
+        if(cfg->uart_backend==UART_STDIO){
+            if(!st->stdout_registered){ add_ep(st->epfd, STDOUT_FILENO, EPOLLOUT); st->stdout_registered=true; }
+        } else {
+            mod_ep(st->epfd, st->fd_uart, EPOLLIN|EPOLLOUT);
+        }
+    }
+}
+
+/* How long the engine may sleep: bounded by the coalesce deadline and the
+   once-per-second stats report. */
+static int compute_timeout_ms(const config_t *cfg, const state_t *st){
+    int timeout_ms=500;
+    if(st->udp_out_len>0 && cfg->udp_coalesce_idle_ms>0){
+        struct timespec now; get_mono(&now);
+        long long waited=diff_ms(&now,&st->last_uart_rx);
+        long long remain=cfg->udp_coalesce_idle_ms - waited;
+        if(remain<0) remain=0;
+        if(remain<timeout_ms) timeout_ms=(int)remain;
+    }
+    if(g_verbosity){
+        struct timespec now; get_mono(&now);
+        if(st->last_stats_report.tv_sec!=0 || st->last_stats_report.tv_nsec!=0){
+            long long since = diff_ms(&now,&st->last_stats_report);
+            long long remain = 1000 - since;
+            if(remain<0) remain=0;
+            if(remain<timeout_ms) timeout_ms=(int)remain;
+        } else if(timeout_ms>1000){
+            timeout_ms=1000;
+        }
+    }
+    return timeout_ms;
+}
+
+/* SIGHUP reload, shared by both engines.
+   Returns 1 to proceed with this iteration, 0 to skip it, -1 to stop. */
+static int handle_reload(const char *conf_path, config_t *cfg, state_t *st,
+                         crsf_monitor_t *crsf,
+                         uint8_t **pbuf_uart, uint8_t **pbuf_net, size_t *prx_buf_cap){
+    config_t newcfg;
+    if(parse_config(conf_path,&newcfg)!=0){
+        vlog(1, "SIGHUP: parse failed, keeping previous config");
+        return 1;
+    }
+    config_t oldcfg = *cfg;
+
+    size_t desired_udp_cap = newcfg.udp_max_datagram>0?(size_t)newcfg.udp_max_datagram:1200;
+    bool udp_resize = desired_udp_cap != st->udp_out_cap;
+    uint8_t *new_udp_out = NULL;
+    if(udp_resize){
+        new_udp_out = (uint8_t*)malloc(desired_udp_cap);
+        if(!new_udp_out){
+            vlog(1, "SIGHUP: UDP buffer alloc failed (%s), keeping previous config", strerror(errno));
+            return 0;
+        }
+    }
+
+    size_t desired_rx = newcfg.rx_buf>0?newcfg.rx_buf:1;
+    bool rx_resize = desired_rx != *prx_buf_cap;
+    uint8_t *new_buf_uart=NULL, *new_buf_net=NULL;
+    if(rx_resize){
+        new_buf_uart=(uint8_t*)malloc(desired_rx);
+        new_buf_net=(uint8_t*)malloc(desired_rx);
+        if(!new_buf_uart||!new_buf_net){
+            int err = errno;
+            free(new_buf_uart);
+            free(new_buf_net);
+            if(new_udp_out) free(new_udp_out);
+            vlog(1, "SIGHUP: RX buffer alloc failed (%s), keeping previous config", strerror(err));
+            return 0;
+        }
+    }
+
+    if(reopen_everything(&newcfg,st)<0){
+        int err = errno;
+        vlog(1, "SIGHUP: reopen failed (%s), attempting to restore previous config", strerror(err));
+        if(reopen_everything(&oldcfg,st)<0){
+            int restore_err = errno;
+            vlog(0, "SIGHUP: failed to restore previous config (%s), stopping", strerror(restore_err));
+            if(rx_resize){ free(new_buf_uart); free(new_buf_net); }
+            if(new_udp_out) free(new_udp_out);
+            st->running=false;
+            return -1;
+        }
+        *cfg = oldcfg;
+        if(rx_resize){ free(new_buf_uart); free(new_buf_net); }
+        if(new_udp_out) free(new_udp_out);
+        reset_stats_window(st);
+        return 0;
+    }
+
+    *cfg = newcfg;
+
+    crsf_monitor_set_enabled(crsf, cfg->crsf_detect && g_verbosity);
+    crsf_log_apply_config(&st->crsf_log, cfg);
+
+    if(rx_resize){
+        free(*pbuf_uart);
+        free(*pbuf_net);
+        *pbuf_uart = new_buf_uart;
+        *pbuf_net = new_buf_net;
+        *prx_buf_cap = desired_rx;
+    }
+
+    if(new_udp_out){
+        uint8_t *old_udp = st->udp_out;
+        st->udp_out = new_udp_out;
+        st->udp_out_cap = desired_udp_cap;
+        st->udp_out_len = 0;
+        st->udp_wait_writable = false;
+        free(old_udp);
+    } else {
+        st->udp_out_cap = desired_udp_cap;
+        st->udp_out_len = 0;
+        st->udp_wait_writable = false;
+    }
+
+    crsf_forward_reset(st);
+
+    get_mono(&st->last_uart_rx);
+    reset_stats_window(st);
+    vlog(1, "SIGHUP: reload successful (uart_backend=%s)",
+         (cfg->uart_backend==UART_TTY?"tty":"stdio"));
+    return 1;
+}
+
+
+/* ------------------------------ io_uring engine ------------------------------ */
+/* Raw-syscall shim (no liburing): one ring, completion-driven. UART reads, UDP
+   receives/sends, UART writes and the wakeup timer are all SQEs, so a typical
+   frame costs a single io_uring_enter(). Selected with engine=io_uring; if the
+   kernel lacks the ops (pre-5.6) init fails and main() falls back to epoll. */
+#ifdef HAVE_IO_URING
+
+#define URING_ENTRIES 64
+#define URING_MAX_TIMEOUTS 8 /* cap on outstanding one-shot timer SQEs */
+
+enum {
+    UR_UART_READ = 1,
+    UR_NET_RECV  = 2,
+    UR_TIMEOUT   = 3,
+    UR_UDP_SEND  = 4,
+    UR_UART_WRITE= 5,
+};
+
+struct uring_ring {
+    int fd;
+    unsigned sq_entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ptr; size_t sq_sz;
+    void *cq_ptr; size_t cq_sz;
+    size_t sqe_sz;
+    unsigned local_tail;
+    unsigned pending;
+};
+
+struct uring_bridge {
+    struct uring_ring ring;
+    /* UDP send: the coalesce buffer is copied here so it can keep filling
+       while the SENDMSG is in flight */
+    uint8_t *send_buf; size_t send_cap; size_t send_len;
+    bool send_inflight;
+    struct msghdr send_mh; struct iovec send_iov; struct sockaddr_in send_to;
+    /* persistent receive ops */
+    bool uart_read_inflight, net_recv_inflight, uart_write_inflight;
+    size_t uart_write_len;
+    struct msghdr rx_mh; struct iovec rx_iov; struct sockaddr_in rx_from;
+    struct __kernel_timespec ts;
+    int timeouts_pending;
+};
+
+static void uring_ring_destroy(struct uring_ring *r){
+    if (r->sqes && r->sqes != MAP_FAILED) munmap(r->sqes, r->sqe_sz);
+    if (r->cq_ptr && r->cq_ptr != r->sq_ptr && r->cq_ptr != MAP_FAILED) munmap(r->cq_ptr, r->cq_sz);
+    if (r->sq_ptr && r->sq_ptr != MAP_FAILED) munmap(r->sq_ptr, r->sq_sz);
+    if (r->fd >= 0) close(r->fd); /* kernel waits out in-flight requests */
+    memset(r, 0, sizeof(*r)); r->fd = -1;
+}
+
+static int uring_ring_init(struct uring_ring *r){
+    memset(r, 0, sizeof(*r)); r->fd = -1;
+    struct io_uring_params p; memset(&p, 0, sizeof(p));
+    int fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &p);
+    if (fd < 0) return -errno;
+    r->fd = fd;
+
+    /* make sure the ops we rely on exist before committing to this engine */
+    {
+        size_t psz = sizeof(struct io_uring_probe) + 256*sizeof(struct io_uring_probe_op);
+        struct io_uring_probe *probe = calloc(1, psz);
+        int ok = 0;
+        if (probe &&
+            syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) == 0){
+            ok = probe->ops_len > IORING_OP_READ &&
+                 (probe->ops[IORING_OP_READ].flags    & IO_URING_OP_SUPPORTED) &&
+                 (probe->ops[IORING_OP_WRITE].flags   & IO_URING_OP_SUPPORTED) &&
+                 (probe->ops[IORING_OP_RECVMSG].flags & IO_URING_OP_SUPPORTED) &&
+                 (probe->ops[IORING_OP_SENDMSG].flags & IO_URING_OP_SUPPORTED) &&
+                 (probe->ops[IORING_OP_TIMEOUT].flags & IO_URING_OP_SUPPORTED);
+        }
+        free(probe);
+        if (!ok){ close(fd); r->fd = -1; return -EOPNOTSUPP; }
+    }
+
+    r->sq_entries = p.sq_entries;
+    r->sq_sz = p.sq_off.array + p.sq_entries*sizeof(unsigned);
+    r->cq_sz = p.cq_off.cqes + p.cq_entries*sizeof(struct io_uring_cqe);
+    bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single && r->cq_sz > r->sq_sz) r->sq_sz = r->cq_sz;
+
+    r->sq_ptr = mmap(NULL, r->sq_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (r->sq_ptr == MAP_FAILED){ int e=errno; uring_ring_destroy(r); return -e; }
+    r->cq_ptr = single ? r->sq_ptr
+              : mmap(NULL, r->cq_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    if (r->cq_ptr == MAP_FAILED){ int e=errno; uring_ring_destroy(r); return -e; }
+    r->sqe_sz = p.sq_entries*sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqe_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED){ int e=errno; uring_ring_destroy(r); return -e; }
+
+    char *sq = (char*)r->sq_ptr;
+    r->sq_head  = (unsigned*)(sq + p.sq_off.head);
+    r->sq_tail  = (unsigned*)(sq + p.sq_off.tail);
+    r->sq_mask  = (unsigned*)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned*)(sq + p.sq_off.array);
+    char *cq = (char*)r->cq_ptr;
+    r->cq_head = (unsigned*)(cq + p.cq_off.head);
+    r->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    r->cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    r->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+    r->local_tail = *r->sq_tail;
+    return 0;
+}
+
+static struct io_uring_sqe *uring_sqe(struct uring_ring *r, uint64_t tag){
+    unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    if (r->local_tail - head >= r->sq_entries) return NULL;
+    unsigned idx = r->local_tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = tag;
+    r->sq_array[idx] = idx;
+    r->local_tail++;
+    r->pending++;
+    return sqe;
+}
+
+static int uring_enter(struct uring_ring *r, unsigned min_complete){
+    __atomic_store_n(r->sq_tail, r->local_tail, __ATOMIC_RELEASE);
+    unsigned to_submit = r->pending;
+    r->pending = 0;
+    int rc = (int)syscall(__NR_io_uring_enter, r->fd, to_submit, min_complete,
+                          IORING_ENTER_GETEVENTS, NULL, 0);
+    return rc < 0 ? -errno : rc;
+}
+
+static int uring_cqe(struct uring_ring *r, uint64_t *tag, int *res){
+    unsigned head = *r->cq_head;
+    unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+    if (head == tail) return 0;
+    struct io_uring_cqe *c = &r->cqes[head & *r->cq_mask];
+    *tag = c->user_data;
+    *res = c->res;
+    __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/* Called from udp_flush_if_ready() while the io_uring loop runs: instead of a
+   synchronous sendto(), copy the datagram and queue a SENDMSG SQE. While a
+   send is in flight the coalesce buffer is kept, mirroring the EAGAIN path. */
+static void uring_submit_udp_send(state_t *st){
+    struct uring_bridge *b = g_uring_bridge;
+    if (b->send_inflight || st->udp_out_len > b->send_cap){
+        st->udp_wait_writable = true;
+        return;
+    }
+    struct io_uring_sqe *sqe = uring_sqe(&b->ring, UR_UDP_SEND);
+    if (!sqe){ st->udp_wait_writable = true; return; }
+    memcpy(b->send_buf, st->udp_out, st->udp_out_len);
+    b->send_len = st->udp_out_len;
+    b->send_to = st->udp_peer;
+    b->send_iov.iov_base = b->send_buf;
+    b->send_iov.iov_len  = b->send_len;
+    memset(&b->send_mh, 0, sizeof(b->send_mh));
+    b->send_mh.msg_name = &b->send_to;
+    b->send_mh.msg_namelen = sizeof(b->send_to);
+    b->send_mh.msg_iov = &b->send_iov;
+    b->send_mh.msg_iovlen = 1;
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = st->fd_net;
+    sqe->addr = (uintptr_t)&b->send_mh;
+    sqe->len = 1;
+    b->send_inflight = true;
+    st->udp_out_len = 0;
+    st->udp_wait_writable = false;
+}
+
+static void uring_bridge_reset_ops(struct uring_bridge *b){
+    b->uart_read_inflight = b->net_recv_inflight = b->uart_write_inflight = false;
+    b->send_inflight = false;
+    b->send_len = 0;
+    b->timeouts_pending = 0;
+}
+
+/* Returns 0 on normal shutdown; negative errno if the engine could not start
+   or died mid-run (main falls back to the epoll loop; shared state carries
+   over cleanly since both engines use the same handlers). */
+static int run_uring_loop(const char *conf_path, config_t *cfg, state_t *st,
+                          crsf_monitor_t *crsf,
+                          uint8_t **pbuf_uart, uint8_t **pbuf_net, size_t *prx_buf_cap){
+    struct uring_bridge b;
+    memset(&b, 0, sizeof(b));
+    b.ring.fd = -1;
+    int rc = uring_ring_init(&b.ring);
+    if (rc < 0) return rc;
+    b.send_cap = st->udp_out_cap;
+    b.send_buf = malloc(b.send_cap);
+    if (!b.send_buf){ uring_ring_destroy(&b.ring); return -ENOMEM; }
+    g_uring_bridge = &b;
+    vlog(1, "engine: io_uring (%u entries)", b.ring.sq_entries);
+
+    int ret = 0;
+    while (st->running && !g_stop){
+        if (g_reload){
+            vlog(1, "SIGHUP: reloading %s", conf_path);
+            g_reload = 0;
+            /* quiesce first: closing the ring fd waits out in-flight SQEs so
+               none can touch buffers the reload is about to replace */
+            g_uring_bridge = NULL;
+            uring_ring_destroy(&b.ring);
+            int rr = handle_reload(conf_path, cfg, st, crsf, pbuf_uart, pbuf_net, prx_buf_cap);
+            if (rr < 0){ ret = 0; goto out_noring; }
+            rc = uring_ring_init(&b.ring);
+            if (rc < 0){ ret = rc; goto out_noring; }
+            uring_bridge_reset_ops(&b);
+            if (st->udp_out_cap != b.send_cap){
+                uint8_t *nb = malloc(st->udp_out_cap);
+                if (!nb){ ret = -ENOMEM; goto out; }
+                free(b.send_buf);
+                b.send_buf = nb;
+                b.send_cap = st->udp_out_cap;
+            }
+            g_uring_bridge = &b;
+            if (rr == 0) continue;
+        }
+
+        /* (re)arm the persistent receive ops */
+        if (!b.uart_read_inflight && st->fd_uart >= 0){
+            struct io_uring_sqe *sqe = uring_sqe(&b.ring, UR_UART_READ);
+            if (sqe){
+                sqe->opcode = IORING_OP_READ;
+                sqe->fd = st->fd_uart;
+                sqe->addr = (uintptr_t)*pbuf_uart;
+                sqe->len = (unsigned)cfg->rx_buf;
+                sqe->off = (__u64)-1;
+                b.uart_read_inflight = true;
+            }
+        }
+        if (!b.net_recv_inflight && st->fd_net >= 0){
+            struct io_uring_sqe *sqe = uring_sqe(&b.ring, UR_NET_RECV);
+            if (sqe){
+                b.rx_iov.iov_base = *pbuf_net;
+                b.rx_iov.iov_len  = cfg->rx_buf;
+                memset(&b.rx_mh, 0, sizeof(b.rx_mh));
+                b.rx_mh.msg_name = &b.rx_from;
+                b.rx_mh.msg_namelen = sizeof(b.rx_from);
+                b.rx_mh.msg_iov = &b.rx_iov;
+                b.rx_mh.msg_iovlen = 1;
+                sqe->opcode = IORING_OP_RECVMSG;
+                sqe->fd = st->fd_net;
+                sqe->addr = (uintptr_t)&b.rx_mh;
+                sqe->len = 1;
+                b.net_recv_inflight = true;
+            }
+        }
+        /* drain NET->UART ring one segment per SQE */
+        if (!b.uart_write_inflight && ring_len(&st->uart_out) > 0){
+            const uint8_t *p1; size_t l1;
+            l1 = ring_read_span(&st->uart_out, &p1);
+            if (l1){
+                int outfd = (cfg->uart_backend==UART_STDIO) ? STDOUT_FILENO : st->fd_uart;
+                struct io_uring_sqe *sqe = uring_sqe(&b.ring, UR_UART_WRITE);
+                if (sqe){
+                    sqe->opcode = IORING_OP_WRITE;
+                    sqe->fd = outfd;
+                    sqe->addr = (uintptr_t)p1;
+                    sqe->len = (unsigned)l1;
+                    sqe->off = (__u64)-1;
+                    b.uart_write_inflight = true;
+                    b.uart_write_len = l1;
+                }
+            }
+        }
+        /* one-shot wakeup timer (coalesce deadline / stats tick); capped so a
+           busy loop cannot pile them up */
+        if (b.timeouts_pending < URING_MAX_TIMEOUTS){
+            struct io_uring_sqe *sqe = uring_sqe(&b.ring, UR_TIMEOUT);
+            if (sqe){
+                int timeout_ms = compute_timeout_ms(cfg, st);
+                b.ts.tv_sec  = timeout_ms/1000;
+                b.ts.tv_nsec = (long long)(timeout_ms%1000)*1000000LL;
+                sqe->opcode = IORING_OP_TIMEOUT;
+                sqe->fd = -1;
+                sqe->addr = (uintptr_t)&b.ts;
+                sqe->len = 1;
+                b.timeouts_pending++;
+            }
+        }
+
+        rc = uring_enter(&b.ring, 1);
+        if (rc < 0){
+            if (rc == -EINTR) continue;
+            vlog(0, "io_uring_enter failed (%s)", strerror(-rc));
+            ret = rc;
+            goto out;
+        }
+
+        uint64_t tag; int res;
+        while (uring_cqe(&b.ring, &tag, &res)){
+            switch (tag){
+            case UR_UART_READ:
+                b.uart_read_inflight = false;
+                if (res > 0) handle_uart_data(cfg, st, crsf, *pbuf_uart, (size_t)res);
+                break;
+            case UR_NET_RECV:
+                b.net_recv_inflight = false;
+                if (res > 0) handle_net_data(cfg, st, crsf, *pbuf_net, (size_t)res, &b.rx_from, true);
+                break;
+            case UR_UDP_SEND:
+                b.send_inflight = false;
+                if (res >= 0){
+                    st->bytes_uart_to_net += (uint64_t)res;
+                    st->pkts_uart_to_net += 1;
+                    vlog(3, "UDP: sent datagram bytes=%d reason=uring", res);
+                } else {
+                    st->drops_uart_to_net += b.send_len;
+                    vlog(1, "UDP: send error (%d) dropping datagram reason=uring", -res);
+                }
+                b.send_len = 0;
+                if (st->udp_wait_writable && st->udp_out_len > 0)
+                    udp_flush_if_ready(cfg, st, true, "retry");
+                break;
+            case UR_UART_WRITE:
+                b.uart_write_inflight = false;
+                if (res > 0){
+                    ring_consume(&st->uart_out, (size_t)res);
+                    st->bytes_net_to_uart += (uint64_t)res;
+                    st->pkts_net_to_uart += 1;
+                } else if (res < 0 && res != -EAGAIN && res != -EINTR){
+                    size_t d = ring_len(&st->uart_out);
+                    ring_consume(&st->uart_out, d);
+                    st->drops_net_to_uart += (uint64_t)d;
+                }
+                break;
+            case UR_TIMEOUT:
+                if (b.timeouts_pending > 0) b.timeouts_pending--;
+                break;
+            default:
+                break;
+            }
+        }
+
+        if (st->udp_out_len > 0 && cfg->udp_coalesce_idle_ms > 0){
+            struct timespec now; get_mono(&now);
+            if (diff_ms(&now, &st->last_uart_rx) >= cfg->udp_coalesce_idle_ms){
+                udp_flush_if_ready(cfg, st, true, "idle_timeout");
+            }
+        }
+        udp_flush_if_ready(cfg, st, false,
+            st->udp_out_len >= (size_t)cfg->udp_coalesce_bytes ? "size_threshold" : "pending");
+        maybe_print_stats(st);
+        crsf_monitor_maybe_report(crsf);
+    }
+
+out:
+    g_uring_bridge = NULL;
+    uring_ring_destroy(&b.ring);
+out_noring:
+    g_uring_bridge = NULL;
+    free(b.send_buf);
+    return ret;
+}
+#endif /* HAVE_IO_URING */
+
 /* --------------------------------- main ------------------------------------- */
 int main(int argc, char **argv){
     const char *conf_path = DEFAULT_CONF;
@@ -1049,116 +1592,27 @@ int main(int argc, char **argv){
     st.running=true; get_mono(&st.last_uart_rx);
     reset_stats_window(&st);
 
+#ifdef HAVE_IO_URING
+    if (cfg.engine_uring){
+        int urc = run_uring_loop(conf_path, &cfg, &st, &crsf, &buf_uart, &buf_net, &rx_buf_cap);
+        if (urc == 0) goto shutdown;
+        vlog(1, "engine: io_uring unavailable (%s), using epoll", strerror(-urc));
+    }
+#else
+    if (cfg.engine_uring)
+        vlog(1, "engine: io_uring not compiled in, using epoll");
+#endif
+
     while(st.running && !g_stop){
         if(g_reload){
             vlog(1, "SIGHUP: reloading %s", conf_path);
             g_reload=0;
-            config_t newcfg;
-            if(parse_config(conf_path,&newcfg)==0){
-                config_t oldcfg = cfg;
-
-                size_t desired_udp_cap = newcfg.udp_max_datagram>0?(size_t)newcfg.udp_max_datagram:1200;
-                bool udp_resize = desired_udp_cap != st.udp_out_cap;
-                uint8_t *new_udp_out = NULL;
-                if(udp_resize){
-                    new_udp_out = (uint8_t*)malloc(desired_udp_cap);
-                    if(!new_udp_out){
-                        vlog(1, "SIGHUP: UDP buffer alloc failed (%s), keeping previous config", strerror(errno));
-                        continue;
-                    }
-                }
-
-                size_t desired_rx = newcfg.rx_buf>0?newcfg.rx_buf:1;
-                bool rx_resize = desired_rx != rx_buf_cap;
-                uint8_t *new_buf_uart=NULL, *new_buf_net=NULL;
-                if(rx_resize){
-                    new_buf_uart=(uint8_t*)malloc(desired_rx);
-                    new_buf_net=(uint8_t*)malloc(desired_rx);
-                    if(!new_buf_uart||!new_buf_net){
-                        int err = errno;
-                        free(new_buf_uart);
-                        free(new_buf_net);
-                        if(new_udp_out) free(new_udp_out);
-                        vlog(1, "SIGHUP: RX buffer alloc failed (%s), keeping previous config", strerror(err));
-                        continue;
-                    }
-                }
-
-                if(reopen_everything(&newcfg,&st)<0){
-                    int err = errno;
-                    vlog(1, "SIGHUP: reopen failed (%s), attempting to restore previous config", strerror(err));
-                    if(reopen_everything(&oldcfg,&st)<0){
-                        int restore_err = errno;
-                        vlog(0, "SIGHUP: failed to restore previous config (%s), stopping", strerror(restore_err));
-                        if(rx_resize){ free(new_buf_uart); free(new_buf_net); }
-                        if(new_udp_out) free(new_udp_out);
-                        st.running=false;
-                        break;
-                    }
-                    cfg = oldcfg;
-                    if(rx_resize){ free(new_buf_uart); free(new_buf_net); }
-                    if(new_udp_out) free(new_udp_out);
-                    reset_stats_window(&st);
-                    continue;
-                }
-
-                cfg = newcfg;
-
-                crsf_monitor_set_enabled(&crsf, cfg.crsf_detect && g_verbosity);
-                crsf_log_apply_config(&st.crsf_log, &cfg);
-
-                if(rx_resize){
-                    free(buf_uart);
-                    free(buf_net);
-                    buf_uart = new_buf_uart;
-                    buf_net = new_buf_net;
-                    rx_buf_cap = desired_rx;
-                }
-
-                if(new_udp_out){
-                    uint8_t *old_udp = st.udp_out;
-                    st.udp_out = new_udp_out;
-                    st.udp_out_cap = desired_udp_cap;
-                    st.udp_out_len = 0;
-                    st.udp_wait_writable = false;
-                    free(old_udp);
-                } else {
-                    st.udp_out_cap = desired_udp_cap;
-                    st.udp_out_len = 0;
-                    st.udp_wait_writable = false;
-                }
-
-                crsf_forward_reset(&st);
-
-                get_mono(&st.last_uart_rx);
-                reset_stats_window(&st);
-                vlog(1, "SIGHUP: reload successful (uart_backend=%s)",
-                     (cfg.uart_backend==UART_TTY?"tty":"stdio"));
-            } else {
-                vlog(1, "SIGHUP: parse failed, keeping previous config");
-            }
-        }
-
-        int timeout_ms=500;
-        if(st.udp_out_len>0 && cfg.udp_coalesce_idle_ms>0){
-            struct timespec now; get_mono(&now);
-            long long waited=diff_ms(&now,&st.last_uart_rx);
-            long long remain=cfg.udp_coalesce_idle_ms - waited;
-            if(remain<0) remain=0;
-            if(remain<timeout_ms) timeout_ms=(int)remain;
+            int rr=handle_reload(conf_path,&cfg,&st,&crsf,&buf_uart,&buf_net,&rx_buf_cap);
+            if(rr<0) break;
+            if(rr==0) continue;
         }
 
-        if(g_verbosity){
-            struct timespec now; get_mono(&now);
-            if(st.last_stats_report.tv_sec!=0 || st.last_stats_report.tv_nsec!=0){
-                long long since = diff_ms(&now,&st.last_stats_report);
-                long long remain = 1000 - since;
-                if(remain<0) remain=0;
-                if(remain<timeout_ms) timeout_ms=(int)remain;
-            } else if(timeout_ms>1000){
-                timeout_ms=1000;
-            }
-        }
+        int timeout_ms=compute_timeout_ms(&cfg,&st);
 
         if(st.fd_net>=0){
             uint32_t net_events = EPOLLIN | (st.udp_wait_writable ? EPOLLOUT : 0);
@@ -1166,11 +1620,11 @@ int main(int argc, char **argv){
         }
 
         if(cfg.uart_backend==UART_TTY){
-            uint32_t uart_events = EPOLLIN | (st.uart_out.len>0?EPOLLOUT:0);
+            uint32_t uart_events = EPOLLIN | (ring_len(&st.uart_out)>0?EPOLLOUT:0);
             mod_ep(st.epfd, st.fd_uart, uart_events);
         } else {
-            if(st.uart_out.len>0 && !st.stdout_registered){ add_ep(st.epfd, STDOUT_FILENO, EPOLLOUT); st.stdout_registered=true; }
-            else if(st.uart_out.len==0 && st.stdout_registered){ del_ep(st.epfd, STDOUT_FILENO); st.stdout_registered=false; }
+            if(ring_len(&st.uart_out)>0 && !st.stdout_registered){ add_ep(st.epfd, STDOUT_FILENO, EPOLLOUT); st.stdout_registered=true; }
+            else if(ring_len(&st.uart_out)==0 && st.stdout_registered){ del_ep(st.epfd, STDOUT_FILENO); st.stdout_registered=false; }
         }
 
         struct epoll_event evs[MAX_EVENTS]; int n=epoll_wait(st.epfd, evs, MAX_EVENTS, timeout_ms);
@@ -1188,64 +1642,13 @@ int main(int argc, char **argv){
 
             if(fd==st.fd_uart && (ev&EPOLLIN)){
                 ssize_t r=read(st.fd_uart,(void*)buf_uart,cfg.rx_buf);
-                if(r>0){
-                    bool crsf_mode = cfg.crsf_detect != 0;
-
-                    get_mono(&st.last_uart_rx);
-                    if (crsf.enabled) {
-                        crsf_monitor_feed(&crsf, CRSF_FROM_UART, buf_uart, (size_t)r);
-                    }
-
-                    if (crsf_mode) {
-                        crsf_forward_feed(&cfg, &st, buf_uart, (size_t)r);
-                    } else {
-                        uart_forward_with_coalesce(&cfg, &st, buf_uart, (size_t)r);
-                    }
-                }
+                if(r>0) handle_uart_data(&cfg,&st,&crsf,buf_uart,(size_t)r);
             }
 
             if(fd==st.fd_net && (ev&EPOLLIN)){
                 struct sockaddr_in from; socklen_t flen=sizeof(from);
                 ssize_t r=recvfrom(st.fd_net, buf_net, cfg.rx_buf, 0,(struct sockaddr*)&from,&flen);
-                if(r>0){
-                    if (crsf.enabled) {
-                        crsf_monitor_feed(&crsf, CRSF_FROM_UDP, buf_net, (size_t)r);
-                    }
-                    if(!cfg.udp_peer_addr[0]){
-                        bool changed = !st.udp_peer_set ||
-                            st.udp_peer.sin_addr.s_addr!=from.sin_addr.s_addr ||
-                            st.udp_peer.sin_port!=from.sin_port;
-                        if(changed){
-                            st.udp_peer = from; st.udp_peer_set=true;
-                            char ipbuf[INET_ADDRSTRLEN];
-                            inet_ntop(AF_INET,&from.sin_addr,ipbuf,sizeof(ipbuf));
-                            vlog(1, "UDP: learned peer %s:%d", ipbuf, ntohs(from.sin_port));
-                        }
-                    }
-                    int outfd = (cfg.uart_backend==UART_STDIO)? STDOUT_FILENO : st.fd_uart;
-                    ssize_t w=write(outfd, buf_net, (size_t)r);
-                    if(w>0){
-                        st.bytes_net_to_uart+=(uint64_t)w; st.pkts_net_to_uart+=1;
-                        if(w<r){
-                            size_t rem=(size_t)r-(size_t)w;
-                            size_t wr=ring_write(&st.uart_out, buf_net+w, rem);
-                            if(wr<rem) st.drops_net_to_uart+=(uint64_t)(rem-wr);
-                            if(cfg.uart_backend==UART_STDIO){
-                                if(!st.stdout_registered){ add_ep(st.epfd, STDOUT_FILENO, EPOLLOUT); st.stdout_registered=true; }
-                            } else {
-                                mod_ep(st.epfd, st.fd_uart, EPOLLIN|EPOLLOUT);
-                            }
-                        }
-                    } else if(w<0 && (errno==EAGAIN||errno==EWOULDBLOCK)){
-                        size_t wr=ring_write(&st.uart_out, buf_net, (size_t)r);
-                        if(wr<(size_t)r) st.drops_net_to_uart+=(uint64_t)((size_t)r-wr);
-                        if(cfg.uart_backend==UART_STDIO){
-                            if(!st.stdout_registered){ add_ep(st.epfd, STDOUT_FILENO, EPOLLOUT); st.stdout_registered=true; }
-                        } else {
-                            mod_ep(st.epfd, st.fd_uart, EPOLLIN|EPOLLOUT);
-                        }
-                    }
-                }
+                if(r>0) handle_net_data(&cfg,&st,&crsf,buf_net,(size_t)r,&from,false);
             }
 
             if(fd==st.fd_net && (ev&EPOLLOUT)){
@@ -1253,13 +1656,13 @@ int main(int argc, char **argv){
             }
 
             if(cfg.uart_backend==UART_TTY && fd==st.fd_uart && (ev&EPOLLOUT)){
-                if(st.uart_out.len>0){ ssize_t w=write_from_ring_fd(st.fd_uart,&st.uart_out); if(w>0) st.bytes_net_to_uart+=(uint64_t)w; }
-                uint32_t want=EPOLLIN | (st.uart_out.len?EPOLLOUT:0); mod_ep(st.epfd, st.fd_uart, want);
+                if(ring_len(&st.uart_out)>0){ ssize_t w=write_from_ring_fd(st.fd_uart,&st.uart_out); if(w>0) st.bytes_net_to_uart+=(uint64_t)w; }
+                uint32_t want=EPOLLIN | (ring_len(&st.uart_out)?EPOLLOUT:0); mod_ep(st.epfd, st.fd_uart, want);
             }
 
             if(cfg.uart_backend==UART_STDIO && st.stdout_registered && fd==STDOUT_FILENO && (ev&EPOLLOUT)){
-                if(st.uart_out.len>0){ ssize_t w=write_from_ring_fd(STDOUT_FILENO,&st.uart_out); if(w>0) st.bytes_net_to_uart+=(uint64_t)w; }
-                if(st.uart_out.len==0){ del_ep(st.epfd, STDOUT_FILENO); st.stdout_registered=false; }
+                if(ring_len(&st.uart_out)>0){ ssize_t w=write_from_ring_fd(STDOUT_FILENO,&st.uart_out); if(w>0) st.bytes_net_to_uart+=(uint64_t)w; }
+                if(ring_len(&st.uart_out)==0){ del_ep(st.epfd, STDOUT_FILENO); st.stdout_registered=false; }
             }
         }
 
@@ -1269,6 +1672,9 @@ int main(int argc, char **argv){
         crsf_monitor_maybe_report(&crsf);
     }
 
+#ifdef HAVE_IO_URING
+shutdown:
+#endif
     maybe_print_stats(&st);
     crsf_monitor_maybe_report(&crsf);
     vlog(1, "Exiting");
@@ -2,8 +2,9 @@
  * joystick2crsf.c - SDL joystick to CRSF bridge with UDP/SSE outputs
  *
  * The utility samples the selected joystick at a configurable rate (25–500 Hz),
- * maps its controls to 16 CRSF channels, and streams the packed frames to a
- * UDP peer. Runtime
+ * maps its controls to 16 CRSF channels, and streams the packed frames to one
+ * or more UDP peers (udp_target takes a comma-separated list; the frame is
+ * packed once and fanned out with a single sendmmsg per tick). Runtime
  * behaviour is configured exclusively via a config
  * file (default: /etc/joystick2crsf.conf).
  */
@@ -69,6 +70,7 @@
 
 #define DEFAULT_CONF       "/etc/joystick2crsf.conf"
 #define MAX_LINE_LEN       512
+#define MAX_UDP_TARGETS    4
 
 /* ------------------------------------------------------------------------- */
 typedef struct {
@@ -270,48 +272,99 @@ static int parse_host_port(const char *spec, char **host_out, char **port_out)
     return 0;
 }
 
-static int open_udp_target(const char *target, struct sockaddr_storage *addr, socklen_t *addrlen)
+/* One unconnected socket shared by every target; sendmmsg() carries the
+ * destination per message, so all targets must share the address family of
+ * the first one that resolves (others are skipped with a warning). */
+typedef struct {
+    int fd;
+    int count;
+    struct sockaddr_storage addr[MAX_UDP_TARGETS];
+    socklen_t addrlen[MAX_UDP_TARGETS];
+    char label[MAX_UDP_TARGETS][256];
+} udp_out_t;
+
+static int open_udp_targets(const char *list, udp_out_t *out)
 {
-    char *host = NULL;
-    char *port = NULL;
-    if (parse_host_port(target, &host, &port) < 0) {
-        fprintf(stderr, "Invalid UDP target '%s' (use host:port or [ipv6]:port)\n", target);
-        return -1;
-    }
+    out->fd = -1;
+    out->count = 0;
 
-    struct addrinfo hints;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_DGRAM;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", list);
 
-    struct addrinfo *res = NULL;
-    int rc = getaddrinfo(host, port, &hints, &res);
-    if (rc != 0) {
-        fprintf(stderr, "UDP getaddrinfo(%s,%s): %s\n", host, port, gai_strerror(rc));
-        free(host);
-        free(port);
-        return -1;
-    }
+    char *save = NULL;
+    for (char *tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+        while (*tok == ' ' || *tok == '\t') {
+            tok++;
+        }
+        char *end = tok + strlen(tok);
+        while (end > tok && (end[-1] == ' ' || end[-1] == '\t')) {
+            *--end = '\0';
+        }
+        if (!*tok) {
+            continue;
+        }
+        if (out->count == MAX_UDP_TARGETS) {
+            fprintf(stderr, "Too many UDP targets (max %d); ignoring '%s'\n",
+                    MAX_UDP_TARGETS, tok);
+            continue;
+        }
 
-    int fd = -1;
-    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
-        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
-        if (fd >= 0) {
-            memcpy(addr, ai->ai_addr, ai->ai_addrlen);
-            *addrlen = (socklen_t)ai->ai_addrlen;
+        char *host = NULL;
+        char *port = NULL;
+        if (parse_host_port(tok, &host, &port) < 0) {
+            fprintf(stderr, "Invalid UDP target '%s' (use host:port or [ipv6]:port)\n", tok);
+            continue;
+        }
+
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+
+        struct addrinfo *res = NULL;
+        int rc = getaddrinfo(host, port, &hints, &res);
+        if (rc != 0) {
+            fprintf(stderr, "UDP getaddrinfo(%s,%s): %s\n", host, port, gai_strerror(rc));
+            free(host);
+            free(port);
+            continue;
+        }
+
+        int added = 0;
+        for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+            if (out->fd < 0) {
+                out->fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+                if (out->fd < 0) {
+                    continue;
+                }
+            } else if (ai->ai_family != ((struct sockaddr *)&out->addr[0])->sa_family) {
+                continue;
+            }
+            memcpy(&out->addr[out->count], ai->ai_addr, ai->ai_addrlen);
+            out->addrlen[out->count] = (socklen_t)ai->ai_addrlen;
+            snprintf(out->label[out->count], sizeof(out->label[0]), "%s", tok);
+            out->count++;
+            added = 1;
             break;
         }
-    }
+        if (!added && out->fd >= 0) {
+            fprintf(stderr, "UDP target '%s' skipped (address family mismatch)\n", tok);
+        }
 
-    freeaddrinfo(res);
-    free(host);
-    free(port);
+        freeaddrinfo(res);
+        free(host);
+        free(port);
+    }
 
-    if (fd < 0) {
+    if (out->count == 0) {
+        if (out->fd >= 0) {
+            close(out->fd);
+            out->fd = -1;
+        }
         perror("udp socket");
         return -1;
     }
-    return fd;
+    return 0;
 }
 
 static int set_nonblock(int fd)
@@ -1367,11 +1420,9 @@ int main(int argc, char **argv)
             }
         }
 
-        int udp_fd = -1;
+        udp_out_t udp = { .fd = -1, .count = 0 };
         int sse_fd = -1;
         int sse_client_fd = -1;
-        struct sockaddr_storage udp_addr;
-        socklen_t udp_addrlen = 0;
         SDL_GameController *gc = NULL;
         SDL_Joystick *js = NULL;
         int js_owned = 0;
@@ -1388,8 +1439,7 @@ int main(int argc, char **argv)
                 fprintf(stderr, "UDP enabled but udp_target is empty\n");
                 fprintf(stderr, "Continuing without UDP output.\n");
             } else {
-                udp_fd = open_udp_target(cfg.udp_target, &udp_addr, &udp_addrlen);
-                if (udp_fd < 0) {
+                if (open_udp_targets(cfg.udp_target, &udp) < 0) {
                     fprintf(stderr, "Continuing without UDP output.\n");
                 }
             }
@@ -1420,8 +1470,8 @@ int main(int argc, char **argv)
             }
             js = NULL;
             js_owned = 0;
-            if (udp_fd >= 0) {
-                close(udp_fd);
+            if (udp.fd >= 0) {
+                close(udp.fd);
             }
             if (sse_client_fd >= 0) {
                 close(sse_client_fd);
@@ -1436,23 +1486,23 @@ int main(int argc, char **argv)
             break;
         }
 
-        if (udp_fd < 0 && (!cfg.sse_enabled || sse_fd < 0)) {
+        if (udp.fd < 0 && (!cfg.sse_enabled || sse_fd < 0)) {
             fprintf(stderr, "Warning: no output destinations configured; frames will stay local.\n");
         }
 
-        if (udp_fd >= 0) {
+        for (int t = 0; t < udp.count; t++) {
             char hostbuf[NI_MAXHOST];
             char servbuf[NI_MAXSERV];
-            int gi = getnameinfo((struct sockaddr *)&udp_addr, udp_addrlen,
+            int gi = getnameinfo((struct sockaddr *)&udp.addr[t], udp.addrlen[t],
                                  hostbuf, sizeof(hostbuf),
                                  servbuf, sizeof(servbuf),
                                  NI_NUMERICHOST | NI_NUMERICSERV);
             if (gi == 0) {
                 fprintf(stderr, "UDP target %s resolved to %s:%s\n",
-                        cfg.udp_target, hostbuf, servbuf);
+                        udp.label[t], hostbuf, servbuf);
             } else {
                 fprintf(stderr, "UDP target %s ready (resolution error: %s)\n",
-                        cfg.udp_target, gai_strerror(gi));
+                        udp.label[t], gai_strerror(gi));
             }
         }
 
@@ -1514,7 +1564,10 @@ int main(int argc, char **argv)
             if (timespec_cmp(&now, &deadline) < 0) {
                 int64_t wait_ns = timespec_diff_ns(&now, &deadline);
                 if (wait_ns > 0) {
-                    wait_ms = (int)((wait_ns + 999999L) / 1000000L);
+                    /* floor, not ceil: the absolute-clock sleep below trims the
+                     * sub-millisecond remainder so frame cadence doesn't jitter
+                     * with SDL's ms-granular timeout */
+                    wait_ms = (int)(wait_ns / 1000000L);
                 }
             }
 
@@ -1528,6 +1581,8 @@ int main(int argc, char **argv)
                     ev.type == SDL_CONTROLLERDEVICEREMOVED) {
                     next_rescan = now;
                 }
+            } else {
+                (void)clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL);
             }
 
             clock_gettime(CLOCK_MONOTONIC, &now);
@@ -1830,16 +1885,25 @@ int main(int argc, char **argv)
                     putchar('\n');
                 }
 
-                if (frame_len > 0 && udp_fd >= 0) {
-                    ssize_t sent = sendto(udp_fd, frame, frame_len, 0,
-                                           (struct sockaddr *)&udp_addr, udp_addrlen);
+                if (frame_len > 0 && udp.fd >= 0) {
+                    /* the frame is packed once; every target shares the same iovec */
+                    struct iovec iov = { .iov_base = frame, .iov_len = frame_len };
+                    struct mmsghdr mh[MAX_UDP_TARGETS];
+                    memset(mh, 0, sizeof(mh[0]) * (size_t)udp.count);
+                    for (int t = 0; t < udp.count; t++) {
+                        mh[t].msg_hdr.msg_name = &udp.addr[t];
+                        mh[t].msg_hdr.msg_namelen = udp.addrlen[t];
+                        mh[t].msg_hdr.msg_iov = &iov;
+                        mh[t].msg_hdr.msg_iovlen = 1;
+                    }
+                    int sent = sendmmsg(udp.fd, mh, (unsigned)udp.count, 0);
                     if (sent < 0) {
                         if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
                             perror("udp send");
                             g_run = 0;
                         }
                     } else {
-                        udp_packets++;
+                        udp_packets += (uint64_t)sent;
                     }
                 }
             }
@@ -1867,7 +1931,7 @@ int main(int argc, char **argv)
                         printf("  wakes event %llu timeout %llu",
                                (unsigned long long)wake_events,
                                (unsigned long long)wake_timeouts);
-                        if (udp_fd >= 0) {
+                        if (udp.fd >= 0) {
                             printf("  udp %llu/s",
                                    (unsigned long long)udp_packets);
                         }
@@ -1913,9 +1977,9 @@ int main(int argc, char **argv)
             js = NULL;
             js_owned = 0;
         }
-        if (udp_fd >= 0) {
-            close(udp_fd);
-            udp_fd = -1;
+        if (udp.fd >= 0) {
+            close(udp.fd);
+            udp.fd = -1;
         }
         if (sse_client_fd >= 0) {
             close(sse_client_fd);
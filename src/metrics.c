@@ -0,0 +1,184 @@
+// Lock-free latency/throughput metrics for autod (see metrics.h).
+//
+// Each recording thread owns a private slot; writes are relaxed atomic
+// increments on that slot only, so instrumentation never bounces a shared
+// cacheline between HTTP workers. Readers (the /metrics handler) sum the
+// slots into a merged histogram. Latencies go into power-of-two microsecond
+// buckets; percentiles are reported as the upper bound of the bucket holding
+// the requested rank, which is plenty for "which endpoint is slow" triage.
+
+#include "metrics.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define METRICS_MAX_THREADS 64
+#define METRICS_BUCKETS     32 // bucket b holds samples in [2^b, 2^(b+1)) us
+
+typedef struct {
+    unsigned long long count;
+    unsigned long long sum_us;
+    unsigned long long bucket[METRICS_BUCKETS];
+} metrics_hist_t;
+
+typedef struct {
+    metrics_hist_t endpoint[METRICS_MAX_ENDPOINTS];
+    metrics_hist_t exec;
+    metrics_hist_t scan;
+    metrics_hist_t sync_reg;
+} metrics_slot_t;
+
+static char g_endpoint_name[METRICS_MAX_ENDPOINTS][32];
+static int g_endpoint_count;
+
+static metrics_slot_t *g_slot[METRICS_MAX_THREADS];
+static int g_slot_count;
+static pthread_mutex_t g_slot_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread metrics_slot_t *t_slot;
+
+long long metrics_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+int metrics_endpoint_register(const char *name) {
+    if (!name || !*name) return -1;
+    pthread_mutex_lock(&g_slot_lock);
+    int id = -1;
+    if (g_endpoint_count < METRICS_MAX_ENDPOINTS) {
+        id = g_endpoint_count++;
+        strncpy(g_endpoint_name[id], name, sizeof(g_endpoint_name[id]) - 1);
+        g_endpoint_name[id][sizeof(g_endpoint_name[id]) - 1] = '\0';
+    }
+    pthread_mutex_unlock(&g_slot_lock);
+    return id;
+}
+
+// One calloc + list insert per thread lifetime; every later record is a
+// lookup of the thread-local pointer.
+static metrics_slot_t *slot_get(void) {
+    if (t_slot) return t_slot;
+    metrics_slot_t *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    pthread_mutex_lock(&g_slot_lock);
+    if (g_slot_count < METRICS_MAX_THREADS) {
+        g_slot[g_slot_count] = s;
+        // publish the slot only after its zeroed contents are visible
+        __atomic_store_n(&g_slot_count, g_slot_count + 1, __ATOMIC_RELEASE);
+        t_slot = s;
+    } else {
+        free(s);
+    }
+    pthread_mutex_unlock(&g_slot_lock);
+    return t_slot;
+}
+
+static void hist_add(metrics_hist_t *h, long long us) {
+    if (us < 0) us = 0;
+    unsigned long long v = (unsigned long long)us;
+    int b = 0;
+    while (v >>= 1) b++;
+    if (b >= METRICS_BUCKETS) b = METRICS_BUCKETS - 1;
+    __atomic_fetch_add(&h->count, 1ULL, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum_us, (unsigned long long)us, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->bucket[b], 1ULL, __ATOMIC_RELAXED);
+}
+
+void metrics_record_endpoint(int id, long long elapsed_us) {
+    if (id < 0 || id >= METRICS_MAX_ENDPOINTS) return;
+    metrics_slot_t *s = slot_get();
+    if (s) hist_add(&s->endpoint[id], elapsed_us);
+}
+
+void metrics_record_exec(long long elapsed_us) {
+    metrics_slot_t *s = slot_get();
+    if (s) hist_add(&s->exec, elapsed_us);
+}
+
+void metrics_record_scan(long long elapsed_us) {
+    metrics_slot_t *s = slot_get();
+    if (s) hist_add(&s->scan, elapsed_us);
+}
+
+void metrics_record_sync_register(long long elapsed_us) {
+    metrics_slot_t *s = slot_get();
+    if (s) hist_add(&s->sync_reg, elapsed_us);
+}
+
+/* ----------------------- merged reporting ----------------------- */
+
+static void hist_merge_one(metrics_hist_t *dst, const metrics_hist_t *src) {
+    dst->count += __atomic_load_n(&src->count, __ATOMIC_RELAXED);
+    dst->sum_us += __atomic_load_n(&src->sum_us, __ATOMIC_RELAXED);
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        dst->bucket[b] += __atomic_load_n(&src->bucket[b], __ATOMIC_RELAXED);
+    }
+}
+
+// Upper bound of the bucket holding the sample at the requested rank.
+static unsigned long long hist_percentile_us(const metrics_hist_t *h, int pct) {
+    if (h->count == 0) return 0;
+    unsigned long long rank = (h->count * (unsigned long long)pct + 99) / 100;
+    if (rank == 0) rank = 1;
+    unsigned long long seen = 0;
+    for (int b = 0; b < METRICS_BUCKETS; b++) {
+        seen += h->bucket[b];
+        if (seen >= rank) {
+            return (1ULL << (b + 1)) - 1;
+        }
+    }
+    return (1ULL << METRICS_BUCKETS) - 1;
+}
+
+static void hist_to_json(JSON_Object *parent, const char *key,
+                         const metrics_hist_t *h) {
+    JSON_Value *v = json_value_init_object();
+    JSON_Object *o = json_object(v);
+    json_object_set_number(o, "count", (double)h->count);
+    json_object_set_number(o, "avg_us",
+                           h->count ? (double)(h->sum_us / h->count) : 0);
+    json_object_set_number(o, "p50_us", (double)hist_percentile_us(h, 50));
+    json_object_set_number(o, "p95_us", (double)hist_percentile_us(h, 95));
+    json_object_set_number(o, "p99_us", (double)hist_percentile_us(h, 99));
+    json_object_set_value(parent, key, v);
+}
+
+JSON_Value *metrics_build_json(void) {
+    int nslots = __atomic_load_n(&g_slot_count, __ATOMIC_ACQUIRE);
+
+    metrics_hist_t endpoint[METRICS_MAX_ENDPOINTS];
+    metrics_hist_t exec_h, scan_h, sync_h;
+    memset(endpoint, 0, sizeof(endpoint));
+    memset(&exec_h, 0, sizeof(exec_h));
+    memset(&scan_h, 0, sizeof(scan_h));
+    memset(&sync_h, 0, sizeof(sync_h));
+
+    for (int i = 0; i < nslots; i++) {
+        const metrics_slot_t *s = g_slot[i];
+        if (!s) continue;
+        for (int e = 0; e < g_endpoint_count; e++) {
+            hist_merge_one(&endpoint[e], &s->endpoint[e]);
+        }
+        hist_merge_one(&exec_h, &s->exec);
+        hist_merge_one(&scan_h, &s->scan);
+        hist_merge_one(&sync_h, &s->sync_reg);
+    }
+
+    JSON_Value *root = json_value_init_object();
+    JSON_Object *o = json_object(root);
+
+    JSON_Value *eps = json_value_init_object();
+    JSON_Object *epo = json_object(eps);
+    for (int e = 0; e < g_endpoint_count; e++) {
+        hist_to_json(epo, g_endpoint_name[e], &endpoint[e]);
+    }
+    json_object_set_value(o, "endpoints", eps);
+
+    hist_to_json(o, "exec", &exec_h);
+    hist_to_json(o, "scan", &scan_h);
+    hist_to_json(o, "sync_register", &sync_h);
+    return root;
+}
@@ -0,0 +1,26 @@
+#ifndef AUTOD_METRICS_H
+#define AUTOD_METRICS_H
+
+#include "parson.h"
+
+// Per-endpoint latency/throughput metrics, surfaced via GET /metrics.
+// Samples land in per-thread slots with relaxed atomic increments (no shared
+// cacheline contention on the hot path) and are merged when a report is built.
+
+#define METRICS_MAX_ENDPOINTS 24
+
+// Returns the endpoint id used by metrics_record_endpoint, or -1 when the
+// table is full. Intended for single-threaded startup registration.
+int metrics_endpoint_register(const char *name);
+
+void metrics_record_endpoint(int id, long long elapsed_us);
+void metrics_record_exec(long long elapsed_us);
+void metrics_record_scan(long long elapsed_us);
+void metrics_record_sync_register(long long elapsed_us);
+
+long long metrics_now_us(void);
+
+// Merged snapshot as a JSON object (caller frees).
+JSON_Value *metrics_build_json(void);
+
+#endif
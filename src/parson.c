@@ -1856,6 +1856,146 @@ char * json_serialize_to_string(const JSON_Value *value) {
     return buf;
 }
 
+/* Local addition (not upstream): see parson.h. Mirrors the escaping and number
+   formatting of json_serialize_to_buffer_r so the byte stream is identical. */
+static int json_sink_string(const char *string, size_t len, JSON_Serialization_Sink sink, void *user_data) {
+    static const char hex[] = "0123456789abcdef";
+    size_t i = 0, run_start = 0;
+    if (sink("\"", 1, user_data) != 0) {
+        return -1;
+    }
+    for (i = 0; i < len; i++) {
+        unsigned char c = (unsigned char)string[i];
+        const char *esc = NULL;
+        size_t esc_len = 0;
+        char ubuf[6];
+        switch (c) {
+            case '\"': esc = "\\\""; esc_len = 2; break;
+            case '\\': esc = "\\\\"; esc_len = 2; break;
+            case '\b': esc = "\\b"; esc_len = 2; break;
+            case '\f': esc = "\\f"; esc_len = 2; break;
+            case '\n': esc = "\\n"; esc_len = 2; break;
+            case '\r': esc = "\\r"; esc_len = 2; break;
+            case '\t': esc = "\\t"; esc_len = 2; break;
+            case '/':
+                if (parson_escape_slashes) {
+                    esc = "\\/"; esc_len = 2;
+                }
+                break;
+            default:
+                if (c < 0x20) {
+                    ubuf[0] = '\\'; ubuf[1] = 'u'; ubuf[2] = '0'; ubuf[3] = '0';
+                    ubuf[4] = hex[c >> 4]; ubuf[5] = hex[c & 0xF];
+                    esc = ubuf; esc_len = 6;
+                }
+                break;
+        }
+        if (esc != NULL) {
+            if (i > run_start && sink(string + run_start, i - run_start, user_data) != 0) {
+                return -1;
+            }
+            if (sink(esc, esc_len, user_data) != 0) {
+                return -1;
+            }
+            run_start = i + 1;
+        }
+    }
+    if (len > run_start && sink(string + run_start, len - run_start, user_data) != 0) {
+        return -1;
+    }
+    return sink("\"", 1, user_data);
+}
+
+static int json_serialize_to_sink_r(const JSON_Value *value, JSON_Serialization_Sink sink, void *user_data, char *num_buf) {
+    const char *key = NULL, *string = NULL;
+    JSON_Array *array = NULL;
+    JSON_Object *object = NULL;
+    size_t i = 0, count = 0, len = 0;
+    double num = 0.0;
+    int written = -1;
+
+    switch (json_value_get_type(value)) {
+        case JSONArray:
+            array = json_value_get_array(value);
+            count = json_array_get_count(array);
+            if (sink("[", 1, user_data) != 0) {
+                return -1;
+            }
+            for (i = 0; i < count; i++) {
+                if (json_serialize_to_sink_r(json_array_get_value(array, i), sink, user_data, num_buf) < 0) {
+                    return -1;
+                }
+                if (i < (count - 1) && sink(",", 1, user_data) != 0) {
+                    return -1;
+                }
+            }
+            return sink("]", 1, user_data);
+        case JSONObject:
+            object = json_value_get_object(value);
+            count  = json_object_get_count(object);
+            if (sink("{", 1, user_data) != 0) {
+                return -1;
+            }
+            for (i = 0; i < count; i++) {
+                key = json_object_get_name(object, i);
+                if (key == NULL) {
+                    return -1;
+                }
+                if (json_sink_string(key, strlen(key), sink, user_data) < 0) {
+                    return -1;
+                }
+                if (sink(":", 1, user_data) != 0) {
+                    return -1;
+                }
+                if (json_serialize_to_sink_r(json_object_get_value_at(object, i), sink, user_data, num_buf) < 0) {
+                    return -1;
+                }
+                if (i < (count - 1) && sink(",", 1, user_data) != 0) {
+                    return -1;
+                }
+            }
+            return sink("}", 1, user_data);
+        case JSONString:
+            string = json_value_get_string(value);
+            if (string == NULL) {
+                return -1;
+            }
+            len = json_value_get_string_len(value);
+            return json_sink_string(string, len, sink, user_data);
+        case JSONBoolean:
+            if (json_value_get_boolean(value)) {
+                return sink("true", 4, user_data);
+            }
+            return sink("false", 5, user_data);
+        case JSONNumber:
+            num = json_value_get_number(value);
+            if (parson_number_serialization_function) {
+                written = parson_number_serialization_function(num, num_buf);
+            } else {
+                const char *float_format = parson_float_format ? parson_float_format : PARSON_DEFAULT_FLOAT_FORMAT;
+                written = parson_sprintf(num_buf, float_format, num);
+            }
+            if (written < 0) {
+                return -1;
+            }
+            return sink(num_buf, (size_t)written, user_data);
+        case JSONNull:
+            return sink("null", 4, user_data);
+        case JSONError:
+            return -1;
+        default:
+            return -1;
+    }
+}
+
+JSON_Status json_serialize_to_sink(const JSON_Value *value, JSON_Serialization_Sink sink, void *user_data) {
+    char num_buf[PARSON_NUM_BUF_SIZE]; /* recursively allocating buffer on stack is a bad idea, so let's do it only once */
+    if (value == NULL || sink == NULL) {
+        return JSONFailure;
+    }
+    return json_serialize_to_sink_r(value, sink, user_data, num_buf) < 0 ? JSONFailure : JSONSuccess;
+}
+
 size_t json_serialization_size_pretty(const JSON_Value *value) {
     char num_buf[PARSON_NUM_BUF_SIZE]; /* recursively allocating buffer on stack is a bad idea, so let's do it only once */
     int res = json_serialize_to_buffer_r(value, NULL, 0, PARSON_TRUE, num_buf);
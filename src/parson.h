@@ -110,6 +110,14 @@ JSON_Status json_serialize_to_buffer(const JSON_Value *value, char *buf, size_t
 JSON_Status json_serialize_to_file(const JSON_Value *value, const char *filename);
 char *      json_serialize_to_string(const JSON_Value *value);
 
+/* Local addition (not upstream): streams the (non-pretty) serialization through
+   a caller-provided sink instead of building it in one buffer, so memory use is
+   bounded by the sink's own buffer rather than the document size. Output bytes
+   match json_serialize_to_string exactly. The sink returns 0 to continue or
+   non-zero to abort serialization. */
+typedef int (*JSON_Serialization_Sink)(const char *data, size_t len, void *user_data);
+JSON_Status json_serialize_to_sink(const JSON_Value *value, JSON_Serialization_Sink sink, void *user_data);
+
 /* Pretty serialization */
 size_t      json_serialization_size_pretty(const JSON_Value *value); /* returns 0 on fail */
 JSON_Status json_serialize_to_buffer_pretty(const JSON_Value *value, char *buf, size_t buf_size_in_bytes);
@@ -0,0 +1,285 @@
+// resolver.c - async hostname resolution with a TTL cache (see resolver.h)
+#define _POSIX_C_SOURCE 200809L
+
+#include "resolver.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ----------------------- cache ----------------------- */
+
+enum { RES_SLOTS = 16 };
+#define RES_TTL_OK_MS  60000 // re-resolve a working name at most once a minute
+#define RES_TTL_NEG_MS 5000  // retry a failing name after a few seconds
+
+enum res_state { RES_FREE = 0, RES_PENDING, RES_OK, RES_FAILED };
+
+typedef struct {
+    char                    host[64];
+    enum res_state          state;
+    struct sockaddr_storage addr;  // valid when RES_OK (port not set)
+    socklen_t               alen;
+    int                     gai_err;     // valid when RES_FAILED
+    long long               resolved_ms; // completion time (OK/FAILED)
+    long long               used_ms;     // LRU eviction
+} res_entry_t;
+
+static res_entry_t     g_cache[RES_SLOTS];
+static pthread_mutex_t g_mx      = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_work_cv = PTHREAD_COND_INITIALIZER; // wakes the worker
+static pthread_cond_t  g_done_cv = PTHREAD_COND_INITIALIZER; // wakes waiters
+static pthread_t       g_thread;
+static int             g_running = 0;
+
+static long long res_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static res_entry_t *cache_find(const char *host) {
+    for (int i = 0; i < RES_SLOTS; i++) {
+        if (g_cache[i].state != RES_FREE && strcmp(g_cache[i].host, host) == 0)
+            return &g_cache[i];
+    }
+    return NULL;
+}
+
+/* Pick a slot for a new lookup: a free one, else the LRU completed entry.
+   PENDING entries are never evicted (the worker still holds their name). */
+static res_entry_t *cache_take_slot(void) {
+    res_entry_t *lru = NULL;
+    for (int i = 0; i < RES_SLOTS; i++) {
+        res_entry_t *e = &g_cache[i];
+        if (e->state == RES_FREE) return e;
+        if (e->state == RES_PENDING) continue;
+        if (!lru || e->used_ms < lru->used_ms) lru = e;
+    }
+    return lru;
+}
+
+/* One blocking getaddrinfo, run off the handler threads. Family-agnostic;
+   SOCK_DGRAM only to dedupe the per-socktype triples glibc returns. */
+static void res_lookup(const char *host,
+                       struct sockaddr_storage *addr, socklen_t *alen,
+                       int *gai_err) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    struct addrinfo *res = NULL;
+    int rc = getaddrinfo(host, NULL, &hints, &res);
+    if (rc != 0 || !res) {
+        if (res) freeaddrinfo(res);
+        *alen = 0;
+        *gai_err = (rc != 0) ? rc : EAI_NONAME;
+        return;
+    }
+    memcpy(addr, res->ai_addr, res->ai_addrlen);
+    *alen = (socklen_t)res->ai_addrlen;
+    *gai_err = 0;
+    freeaddrinfo(res);
+}
+
+static void *resolver_thread_main(void *arg) {
+    (void)arg;
+    pthread_mutex_lock(&g_mx);
+    while (g_running) {
+        res_entry_t *e = NULL;
+        for (int i = 0; i < RES_SLOTS; i++) {
+            if (g_cache[i].state == RES_PENDING) { e = &g_cache[i]; break; }
+        }
+        if (!e) {
+            pthread_cond_wait(&g_work_cv, &g_mx);
+            continue;
+        }
+
+        char host[sizeof(e->host)];
+        snprintf(host, sizeof(host), "%s", e->host);
+        pthread_mutex_unlock(&g_mx);
+
+        struct sockaddr_storage addr;
+        socklen_t alen = 0;
+        int gai_err = 0;
+        res_lookup(host, &addr, &alen, &gai_err);
+
+        pthread_mutex_lock(&g_mx);
+        // the entry cannot have moved: PENDING slots are never evicted
+        if (e->state == RES_PENDING && strcmp(e->host, host) == 0) {
+            if (gai_err == 0) {
+                e->addr = addr;
+                e->alen = alen;
+                e->state = RES_OK;
+            } else {
+                e->gai_err = gai_err;
+                e->state = RES_FAILED;
+            }
+            e->resolved_ms = res_now_ms();
+            pthread_cond_broadcast(&g_done_cv);
+        }
+    }
+    pthread_mutex_unlock(&g_mx);
+    return NULL;
+}
+
+/* ----------------------- public API ----------------------- */
+
+void resolver_start(void) {
+    pthread_mutex_lock(&g_mx);
+    if (!g_running) {
+        g_running = 1;
+        if (pthread_create(&g_thread, NULL, resolver_thread_main, NULL) != 0) {
+            g_running = 0; // resolver_resolve falls back to blocking lookups
+        }
+    }
+    pthread_mutex_unlock(&g_mx);
+}
+
+void resolver_stop(void) {
+    pthread_mutex_lock(&g_mx);
+    int was_running = g_running;
+    g_running = 0;
+    pthread_cond_broadcast(&g_work_cv);
+    pthread_mutex_unlock(&g_mx);
+    if (was_running) pthread_join(g_thread, NULL);
+}
+
+static void addr_set_port(struct sockaddr_storage *addr, int port) {
+    if (addr->ss_family == AF_INET)
+        ((struct sockaddr_in *)addr)->sin_port = htons((uint16_t)port);
+    else if (addr->ss_family == AF_INET6)
+        ((struct sockaddr_in6 *)addr)->sin6_port = htons((uint16_t)port);
+}
+
+static void set_detail(char *detail, size_t detail_sz, const char *msg) {
+    if (detail && detail_sz) snprintf(detail, detail_sz, "%s", msg);
+}
+
+int resolver_resolve(const char *host, int port, int timeout_ms,
+                     struct sockaddr_storage *addr, socklen_t *alen,
+                     char *detail, size_t detail_sz) {
+    if (detail && detail_sz) detail[0] = '\0';
+    if (!host || !*host) {
+        set_detail(detail, detail_sz, "empty host");
+        return RESOLVE_FAILED;
+    }
+
+    // IP-literal fast path: no cache, no thread
+    struct in_addr a4;
+    if (inet_pton(AF_INET, host, &a4) == 1) {
+        struct sockaddr_in *s = (struct sockaddr_in *)addr;
+        memset(addr, 0, sizeof(*addr));
+        s->sin_family = AF_INET;
+        s->sin_addr = a4;
+        s->sin_port = htons((uint16_t)port);
+        *alen = sizeof(*s);
+        return RESOLVE_OK;
+    }
+    struct in6_addr a6;
+    if (inet_pton(AF_INET6, host, &a6) == 1) {
+        struct sockaddr_in6 *s = (struct sockaddr_in6 *)addr;
+        memset(addr, 0, sizeof(*addr));
+        s->sin6_family = AF_INET6;
+        s->sin6_addr = a6;
+        s->sin6_port = htons((uint16_t)port);
+        *alen = sizeof(*s);
+        return RESOLVE_OK;
+    }
+
+    if (strlen(host) >= sizeof(((res_entry_t *)0)->host)) {
+        set_detail(detail, detail_sz, "hostname too long");
+        return RESOLVE_FAILED;
+    }
+
+    pthread_mutex_lock(&g_mx);
+
+    if (!g_running) {
+        // resolver thread unavailable: degrade to the old blocking lookup
+        pthread_mutex_unlock(&g_mx);
+        struct sockaddr_storage tmp;
+        socklen_t tlen = 0;
+        int gai_err = 0;
+        res_lookup(host, &tmp, &tlen, &gai_err);
+        if (gai_err != 0) {
+            set_detail(detail, detail_sz, gai_strerror(gai_err));
+            return RESOLVE_FAILED;
+        }
+        *addr = tmp;
+        *alen = tlen;
+        addr_set_port(addr, port);
+        return RESOLVE_OK;
+    }
+
+    long long now = res_now_ms();
+    res_entry_t *e = cache_find(host);
+    if (e) {
+        long long ttl = (e->state == RES_OK) ? RES_TTL_OK_MS : RES_TTL_NEG_MS;
+        if (e->state != RES_PENDING && now - e->resolved_ms > ttl) {
+            e->state = RES_PENDING; // stale: kick off a refresh and wait
+            pthread_cond_signal(&g_work_cv);
+        }
+    } else {
+        e = cache_take_slot();
+        if (!e) {
+            // every slot mid-lookup: shed load instead of queueing behind them
+            pthread_mutex_unlock(&g_mx);
+            set_detail(detail, detail_sz, "resolver busy");
+            return RESOLVE_TIMEOUT;
+        }
+        snprintf(e->host, sizeof(e->host), "%s", host);
+        e->state = RES_PENDING;
+        pthread_cond_signal(&g_work_cv);
+    }
+    e->used_ms = now;
+
+    if (e->state == RES_PENDING) {
+        if (timeout_ms < 1) timeout_ms = 1;
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while (e && e->state == RES_PENDING && g_running) {
+            int wrc = pthread_cond_timedwait(&g_done_cv, &g_mx, &deadline);
+            /* While we slept the slot may have completed, been evicted by
+               cache_take_slot() and reused for a different name — the
+               no-evict invariant only covers PENDING, not completed-but-
+               unconsumed. Re-find our entry by name before trusting the
+               slot's state or address. */
+            e = cache_find(host);
+            if (wrc == ETIMEDOUT) break;
+        }
+        if (!e || e->state == RES_PENDING) {
+            // on timeout the entry stays in place: when the lookup
+            // eventually lands it becomes a warm cache hit for the next
+            // request (unless eviction already recycled the slot)
+            pthread_mutex_unlock(&g_mx);
+            set_detail(detail, detail_sz, "resolver timeout");
+            return RESOLVE_TIMEOUT;
+        }
+    }
+
+    int rc;
+    if (e->state == RES_OK) {
+        *addr = e->addr;
+        *alen = e->alen;
+        addr_set_port(addr, port);
+        rc = RESOLVE_OK;
+    } else {
+        set_detail(detail, detail_sz, gai_strerror(e->gai_err));
+        rc = RESOLVE_FAILED;
+    }
+    pthread_mutex_unlock(&g_mx);
+    return rc;
+}
@@ -0,0 +1,36 @@
+#ifndef AUTOD_RESOLVER_H
+#define AUTOD_RESOLVER_H
+
+#include <stddef.h>
+#include <sys/socket.h>
+
+/*
+ * Hostname resolver for the proxy plane (/udp, /http targets).
+ *
+ * getaddrinfo() blocks for seconds against a dead DNS server, and the
+ * proxy handlers run on civetweb worker threads — a few lookups for an
+ * unreachable name used to freeze the whole HTTP plane. Lookups now run
+ * on one dedicated resolver thread; handlers wait on the result with a
+ * deadline and answer 504 instead of hanging. Results are cached with a
+ * TTL (positive ~1 min, negative a few seconds) so steady-state traffic
+ * never touches the thread, and IP literals — the common case — are
+ * converted inline without involving it at all.
+ */
+
+enum {
+    RESOLVE_OK      =  0,
+    RESOLVE_FAILED  = -1,  // name does not resolve (possibly negative-cached)
+    RESOLVE_TIMEOUT = -2,  // deadline expired with the lookup still running
+};
+
+void resolver_start(void);
+void resolver_stop(void);
+
+// Resolve host and write the first usable address, with port baked in, to
+// *addr/*alen. Waits at most timeout_ms for an uncached name. detail, when
+// non-NULL, receives a short human-readable reason on failure.
+int resolver_resolve(const char *host, int port, int timeout_ms,
+                     struct sockaddr_storage *addr, socklen_t *alen,
+                     char *detail, size_t detail_sz);
+
+#endif
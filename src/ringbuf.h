@@ -0,0 +1,99 @@
+/*
+ * ringbuf.h — mirror-mapped single-producer/single-consumer byte ring
+ * -------------------------------------------------------------------
+ * Shared by ip2uart and udp_relay (header-only, Linux).
+ *
+ * The buffer is a memfd mapped twice back-to-back ("magic ring"), so the
+ * pending bytes are always one contiguous span: no two-segment peek, no
+ * modulo math on the data path, one write()/memcpy per operation.
+ *
+ * head/tail are free-running byte counters (masked on access) updated with
+ * acquire/release atomics, which makes the ring lock-free for exactly one
+ * producer thread and one consumer thread. Capacity is rounded up to a
+ * power-of-two multiple of the page size; cap == 0 leaves the ring disabled
+ * (all operations become no-ops), matching the old malloc-based behavior.
+ */
+#ifndef RINGBUF_H
+#define RINGBUF_H
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+typedef struct {
+    uint8_t *buf;   /* 2*cap mapping; [cap,2*cap) mirrors [0,cap) */
+    size_t cap;     /* power of two, multiple of page size; 0 = disabled */
+    size_t head;    /* producer: total bytes ever written */
+    size_t tail;    /* consumer: total bytes ever consumed */
+} ringbuf_t;
+
+static inline int ring_init(ringbuf_t *r, size_t cap){
+    r->buf = NULL; r->cap = 0; r->head = r->tail = 0;
+    if (!cap) return 0;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t c = page;
+    while (c < cap) c <<= 1;
+    int fd = memfd_create("ringbuf", MFD_CLOEXEC);
+    if (fd < 0){ errno = ENOMEM; return -1; }
+    if (ftruncate(fd, (off_t)c) < 0){ close(fd); errno = ENOMEM; return -1; }
+    uint8_t *base = (uint8_t*)mmap(NULL, c*2, PROT_NONE,
+                                   MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED){ close(fd); errno = ENOMEM; return -1; }
+    if (mmap(base,     c, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_FIXED, fd, 0) == MAP_FAILED ||
+        mmap(base + c, c, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_FIXED, fd, 0) == MAP_FAILED){
+        munmap(base, c*2); close(fd); errno = ENOMEM; return -1;
+    }
+    close(fd);
+    r->buf = base;
+    r->cap = c;
+    return 0;
+}
+
+static inline void ring_free(ringbuf_t *r){
+    if (r->buf) munmap(r->buf, r->cap*2);
+    r->buf = NULL; r->cap = r->head = r->tail = 0;
+}
+
+/* pending bytes (consumer-accurate; a safe lower bound for the producer) */
+static inline size_t ring_len(const ringbuf_t *r){
+    size_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    size_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+static inline size_t ring_space(const ringbuf_t *r){
+    return r->cap - ring_len(r);
+}
+
+/* producer side: copy up to n bytes, return how many fit */
+static inline size_t ring_write(ringbuf_t *r, const uint8_t *src, size_t n){
+    if (!r->cap || !n) return 0;
+    size_t head = r->head;
+    size_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    size_t space = r->cap - (head - tail);
+    size_t w = n > space ? space : n;
+    if (!w) return 0;
+    memcpy(r->buf + (head & (r->cap - 1)), src, w);
+    __atomic_store_n(&r->head, head + w, __ATOMIC_RELEASE);
+    return w;
+}
+
+/* consumer side: all pending bytes as one contiguous span */
+static inline size_t ring_read_span(const ringbuf_t *r, const uint8_t **p){
+    if (!r->cap){ *p = NULL; return 0; }
+    size_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    size_t tail = r->tail;
+    *p = r->buf + (tail & (r->cap - 1));
+    return head - tail;
+}
+
+static inline void ring_consume(ringbuf_t *r, size_t n){
+    size_t len = ring_len(r);
+    if (n > len) n = len;
+    __atomic_store_n(&r->tail, r->tail + n, __ATOMIC_RELEASE);
+}
+
+#endif /* RINGBUF_H */
@@ -1,6 +1,8 @@
 #define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // struct ip_mreq / timeval for announce discovery
 #include "scan.h"
 #include "parson.h"
+#include "metrics.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -10,10 +12,20 @@
 #include <time.h>
 #include <poll.h>
 #include <pthread.h>
+#include <sys/epoll.h>
 #include <ifaddrs.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+// The whole engine compiles out under the slim profile (`make slim`,
+// -DAUTOD_NO_SCAN); the stubs at the bottom of this file keep every call
+// site working with an always-empty node table.
+#ifndef AUTOD_NO_SCAN
 
 // ================= Tiny HTTP client =================
 
@@ -79,12 +91,34 @@ static const char* http_body_ptr(const char *resp) {
 
 static pthread_mutex_t g_nodes_mx = PTHREAD_MUTEX_INITIALIZER;
 
-static scan_node_t g_nodes[SCAN_MAX_NODES];
-static int         g_nodes_count = 0;
+// Growable node store. Optionally backed by a memory-mapped cache file
+// (scan_cache_attach) so a restarted daemon comes up warm. A small
+// open-addressing hash keyed on ip:port makes lookups O(1).
+typedef struct {
+    uint32_t magic;     // SCAN_CACHE_MAGIC
+    uint32_t node_size; // sizeof(scan_node_t) — reject mismatched layouts
+    uint32_t count;
+    uint32_t capacity;
+} scan_cache_hdr_t;
+
+#define SCAN_CACHE_MAGIC 0x44434e41u /* "ANCD" */
+
+static scan_node_t *g_nodes = NULL;
+static int          g_nodes_count = 0;
+static int          g_nodes_cap = 0;
+
+static int               g_cache_fd = -1;
+static scan_cache_hdr_t *g_cache_hdr = NULL; // start of the mapping (NULL = in-memory)
+static size_t            g_cache_map_len = 0;
+
+static int      *g_node_idx = NULL;  // hash slots: node index + 1, 0 = empty
+static unsigned  g_node_idx_cap = 0; // power of two
 
 static volatile int      g_scan_in_progress = 0;
+static volatile unsigned g_table_gen = 0;     // bumps on any node-table or scan-state change
 static volatile unsigned g_scan_total = 0;
 static volatile unsigned g_scan_done  = 0;
+static volatile unsigned g_scan_inflight = 0;
 static volatile double   g_last_started  = 0.0;
 static volatile double   g_last_finished = 0.0;
 static volatile unsigned g_scan_seq = 0;
@@ -103,7 +137,7 @@ static scan_tun_t g_tun = {
     .connect_timeout_ms = 200,
     .health_timeout_ms  = 150,
     .caps_timeout_ms    = 400,
-    .concurrency        = 16,
+    .concurrency        = 128,
     .stale_max_misses   = 2
 };
 
@@ -115,19 +149,102 @@ static inline int progress_pct(void) {
     return tot ? (int)((100ULL * don) / tot) : 0;
 }
 
-static void nodes_reset(void) {
-    pthread_mutex_lock(&g_nodes_mx);
-    g_nodes_count = 0;
-    pthread_mutex_unlock(&g_nodes_mx);
+// ---- hash index (callers hold g_nodes_mx) ----
+
+static unsigned node_key_hash(const char *ip, int port) {
+    unsigned h = 2166136261u; // FNV-1a
+    for (const unsigned char *p = (const unsigned char*)ip; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    h ^= (unsigned)port * 2654435761u;
+    return h;
+}
+
+static void idx_insert(int node_index) {
+    if (!g_node_idx_cap) return;
+    unsigned mask = g_node_idx_cap - 1;
+    unsigned h = node_key_hash(g_nodes[node_index].ip, g_nodes[node_index].port) & mask;
+    while (g_node_idx[h]) h = (h + 1) & mask;
+    g_node_idx[h] = node_index + 1;
+}
+
+static void idx_rebuild(void) {
+    unsigned want = 16;
+    while (want < (unsigned)g_nodes_count * 2u) want <<= 1;
+    if (want != g_node_idx_cap) {
+        int *ni = realloc(g_node_idx, want * sizeof(int));
+        if (!ni) return; // keep old table; lookups fall back to linear scan
+        g_node_idx = ni;
+        g_node_idx_cap = want;
+    }
+    memset(g_node_idx, 0, g_node_idx_cap * sizeof(int));
+    for (int i = 0; i < g_nodes_count; i++) idx_insert(i);
 }
 
 static int nodes_find_idx(const char *ip, int port) {
+    if (g_node_idx_cap) {
+        unsigned mask = g_node_idx_cap - 1;
+        unsigned h = node_key_hash(ip, port) & mask;
+        for (unsigned probes = 0; probes <= mask; probes++) {
+            int slot = g_node_idx[h];
+            if (!slot) return -1;
+            int i = slot - 1;
+            if (i < g_nodes_count && g_nodes[i].port == port && strcmp(g_nodes[i].ip, ip) == 0)
+                return i;
+            h = (h + 1) & mask;
+        }
+        return -1;
+    }
     for (int i=0;i<g_nodes_count;i++){
         if (g_nodes[i].port==port && strcmp(g_nodes[i].ip, ip)==0) return i;
     }
     return -1;
 }
 
+// ---- growable backing store (callers hold g_nodes_mx) ----
+
+static void nodes_publish_count(void) {
+    if (g_cache_hdr) g_cache_hdr->count = (uint32_t)g_nodes_count;
+}
+
+static int nodes_reserve(int need) {
+    if (need <= g_nodes_cap) return 0;
+    int ncap = g_nodes_cap ? g_nodes_cap * 2 : SCAN_MAX_NODES;
+    while (ncap < need) ncap *= 2;
+
+    if (g_cache_hdr) {
+        size_t nlen = sizeof(scan_cache_hdr_t) + (size_t)ncap * sizeof(scan_node_t);
+        if (ftruncate(g_cache_fd, (off_t)nlen) != 0) return -1;
+        void *nmap = mmap(NULL, nlen, PROT_READ | PROT_WRITE, MAP_SHARED, g_cache_fd, 0);
+        if (nmap == MAP_FAILED) return -1;
+        munmap(g_cache_hdr, g_cache_map_len);
+        g_cache_hdr = (scan_cache_hdr_t*)nmap;
+        g_cache_map_len = nlen;
+        g_cache_hdr->capacity = (uint32_t)ncap;
+        g_nodes = (scan_node_t*)(g_cache_hdr + 1);
+    } else {
+        scan_node_t *nn = realloc(g_nodes, (size_t)ncap * sizeof(scan_node_t));
+        if (!nn) return -1;
+        g_nodes = nn;
+    }
+    g_nodes_cap = ncap;
+    return 0;
+}
+
+static void table_gen_bump(void) {
+    __sync_fetch_and_add(&g_table_gen, 1);
+}
+
+static void nodes_reset(void) {
+    pthread_mutex_lock(&g_nodes_mx);
+    g_nodes_count = 0;
+    table_gen_bump();
+    nodes_publish_count();
+    idx_rebuild();
+    pthread_mutex_unlock(&g_nodes_mx);
+}
+
 static void nodes_upsert(const scan_node_t *ni) {
     pthread_mutex_lock(&g_nodes_mx);
     int idx = nodes_find_idx(ni->ip, ni->port);
@@ -137,8 +254,13 @@ static void nodes_upsert(const scan_node_t *ni) {
         g_nodes[idx] = *ni;
         g_nodes[idx].is_self = is_self ? 1u : ni->is_self;
         g_nodes[idx].misses  = 0;
-    } else if (g_nodes_count < SCAN_MAX_NODES) {
+        table_gen_bump();
+    } else if (nodes_reserve(g_nodes_count + 1) == 0) {
         g_nodes[g_nodes_count++] = *ni;
+        table_gen_bump();
+        nodes_publish_count();
+        if ((unsigned)g_nodes_count * 2u > g_node_idx_cap) idx_rebuild();
+        else idx_insert(g_nodes_count - 1);
     }
     pthread_mutex_unlock(&g_nodes_mx);
 }
@@ -162,6 +284,9 @@ static void nodes_prune_after_scan(unsigned scan_seq) {
         }
     }
     g_nodes_count = w;
+    table_gen_bump();
+    nodes_publish_count();
+    idx_rebuild(); // compaction moved entries
     pthread_mutex_unlock(&g_nodes_mx);
 }
 
@@ -174,7 +299,7 @@ void scan_set_tuning(const scan_tuning_t *t) {
     if (t->connect_timeout_ms > 0) g_tun.connect_timeout_ms = t->connect_timeout_ms;
     if (t->health_timeout_ms  > 0) g_tun.health_timeout_ms  = t->health_timeout_ms;
     if (t->caps_timeout_ms    > 0) g_tun.caps_timeout_ms    = t->caps_timeout_ms;
-    if (t->concurrency        > 0 && t->concurrency <= 256) g_tun.concurrency = t->concurrency;
+    if (t->concurrency        > 0 && t->concurrency <= 4096) g_tun.concurrency = t->concurrency;
     if (t->stale_max_misses   > 0) g_tun.stale_max_misses   = t->stale_max_misses;
 }
 
@@ -210,11 +335,14 @@ void scan_seed_self_nodes(const scan_config_t *cfg) {
 
 int scan_is_running(void) { return g_scan_in_progress ? 1 : 0; }
 
+unsigned scan_table_generation(void) { return __sync_fetch_and_add(&g_table_gen, 0); }
+
 void scan_get_status(scan_status_t *st) {
     if (!st) return;
     st->scanning      = scan_is_running();
     st->targets       = g_scan_total;
     st->done          = g_scan_done;
+    st->in_flight     = g_scan_inflight;
     st->progress_pct  = progress_pct();
     st->last_started  = g_last_started;
     st->last_finished = g_last_finished;
@@ -230,21 +358,97 @@ int scan_get_nodes(scan_node_t *dst, int max) {
     return n;
 }
 
-int scan_probe_node(const char *ip, int port) {
-    if (!ip || !*ip || port <= 0 || port > 65535) return -1;
+int scan_node_count(void) {
+    pthread_mutex_lock(&g_nodes_mx);
+    int n = g_nodes_count;
+    pthread_mutex_unlock(&g_nodes_mx);
+    return n;
+}
 
-    char resp[8192];
-    int health = http_get_simple(ip, port, "/health", resp, sizeof(resp),
-                                 g_tun.health_timeout_ms);
-    if (health != 0) return -1;
+scan_node_t *scan_copy_nodes(int *count) {
+    if (count) *count = 0;
+    pthread_mutex_lock(&g_nodes_mx);
+    scan_node_t *copy = NULL;
+    int n = g_nodes_count;
+    if (n > 0) {
+        copy = malloc((size_t)n * sizeof(scan_node_t));
+        if (copy) memcpy(copy, g_nodes, (size_t)n * sizeof(scan_node_t));
+        else n = 0;
+    }
+    pthread_mutex_unlock(&g_nodes_mx);
+    if (count) *count = n;
+    return copy;
+}
 
-    int caps = http_get_simple(ip, port, "/caps", resp, sizeof(resp),
-                               g_tun.caps_timeout_ms);
-    if (caps != 0) return -1;
+int scan_find_node(const char *ip, int port, scan_node_t *out) {
+    if (!ip || !*ip || port <= 0) return -1;
+    pthread_mutex_lock(&g_nodes_mx);
+    int idx = nodes_find_idx(ip, port);
+    if (idx >= 0 && out) *out = g_nodes[idx];
+    pthread_mutex_unlock(&g_nodes_mx);
+    return idx >= 0 ? 0 : -1;
+}
 
-    const char *body = http_body_ptr(resp);
-    if (!body) return -1;
+int scan_cache_attach(const char *path) {
+    if (!path || !*path) return -1;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) { close(fd); return -1; }
+
+    int valid = 0;
+    scan_cache_hdr_t hdr;
+    if ((size_t)st.st_size >= sizeof(hdr)) {
+        if (read(fd, &hdr, sizeof(hdr)) == (ssize_t)sizeof(hdr) &&
+            hdr.magic == SCAN_CACHE_MAGIC &&
+            hdr.node_size == (uint32_t)sizeof(scan_node_t) &&
+            hdr.capacity > 0 &&
+            hdr.count <= hdr.capacity &&
+            (size_t)st.st_size >= sizeof(hdr) + hdr.capacity * sizeof(scan_node_t)) {
+            valid = 1;
+        }
+    }
 
+    uint32_t cap = valid ? hdr.capacity : SCAN_MAX_NODES;
+    size_t len = sizeof(scan_cache_hdr_t) + (size_t)cap * sizeof(scan_node_t);
+    if (!valid && ftruncate(fd, (off_t)len) != 0) { close(fd); return -1; }
+
+    void *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) { close(fd); return -1; }
+
+    pthread_mutex_lock(&g_nodes_mx);
+    if (g_nodes && !g_cache_hdr) free(g_nodes);
+    g_cache_fd      = fd;
+    g_cache_hdr     = (scan_cache_hdr_t*)map;
+    g_cache_map_len = len;
+    g_nodes         = (scan_node_t*)(g_cache_hdr + 1);
+    g_nodes_cap     = (int)cap;
+    if (valid) {
+        g_nodes_count = (int)hdr.count;
+        // Entries from the previous run need re-validation: drop self flags
+        // (seeding re-adds them) and restart the staleness counters.
+        for (int i = 0; i < g_nodes_count; i++) {
+            g_nodes[i].is_self   = 0;
+            g_nodes[i].seen_scan = g_scan_seq;
+            g_nodes[i].misses    = 0;
+        }
+    } else {
+        g_nodes_count = 0;
+        g_cache_hdr->magic     = SCAN_CACHE_MAGIC;
+        g_cache_hdr->node_size = (uint32_t)sizeof(scan_node_t);
+        g_cache_hdr->capacity  = cap;
+        g_cache_hdr->count     = 0;
+    }
+    idx_rebuild();
+    pthread_mutex_unlock(&g_nodes_mx);
+    return 0;
+}
+
+// Parse a /caps JSON body and upsert the node cache. mark_seen tags the entry
+// with the current scan sequence so it survives the post-scan prune.
+static int node_from_caps_body(const char *ip, int port, const char *body, int mark_seen) {
     JSON_Value *v = json_parse_string(body);
     if (!v) return -1;
 
@@ -266,11 +470,29 @@ int scan_probe_node(const char *ip, int port) {
         if (sync_id)   strncpy(ni.sync_id,   sync_id,   sizeof(ni.sync_id) - 1);
     }
     ni.last_seen = now_s();
+    if (mark_seen) ni.seen_scan = g_scan_seq;
     nodes_upsert(&ni);
     json_value_free(v);
     return 0;
 }
 
+int scan_probe_node(const char *ip, int port) {
+    if (!ip || !*ip || port <= 0 || port > 65535) return -1;
+
+    char resp[8192];
+    int health = http_get_simple(ip, port, "/health", resp, sizeof(resp),
+                                 g_tun.health_timeout_ms);
+    if (health != 0) return -1;
+
+    int caps = http_get_simple(ip, port, "/caps", resp, sizeof(resp),
+                               g_tun.caps_timeout_ms);
+    if (caps != 0) return -1;
+
+    const char *body = http_body_ptr(resp);
+    if (!body) return -1;
+    return node_from_caps_body(ip, port, body, 0);
+}
+
 // ================ Target planning helpers ================
 
 typedef struct { uint32_t *ips; unsigned n, cap; } ipvec_t;
@@ -360,68 +582,238 @@ static void add_subnet_walk(ipvec_t *v, const char *ip, const char *mask, uint32
     add_subnet_walk_raw(v, a, m, *self_a);
 }
 
-// ================ Worker pool ================
+// ================ Async probe engine (epoll) ================
+//
+// One thread drives every in-flight probe through a small per-target state
+// machine: non-blocking connect, then both GETs pipelined on one connection.
+// Peers that close after the first response (our own autod does) get a
+// follow-up caps-only connection on the same slot.
+
+typedef enum {
+    PROBE_CONNECTING = 0,   // waiting for connect() to complete
+    PROBE_SENDING,          // pipelined /health + /caps request partially written
+    PROBE_READING,          // reading responses until EOF
+    PROBE_CAPS_CONNECTING,  // fallback: fresh connection for /caps only
+    PROBE_CAPS_SENDING,
+    PROBE_CAPS_READING
+} probe_state_t;
 
 typedef struct {
-    uint32_t *targets;
-    unsigned  count;
-    volatile unsigned *next_idx;
-    int       port;
-} work_ctx_t;
+    int           fd;        // -1 when the slot is free
+    probe_state_t state;
+    char          ip[16];
+    size_t        wr;        // request bytes written so far
+    size_t        rd;        // response bytes buffered
+    long long     deadline;  // now_ms_mono() when this stage expires
+    size_t        req_len;
+    char          req[192];
+    char          resp[8192];
+} probe_t;
+
+static long long now_ms_mono(void) {
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000LL + ts.tv_nsec / 1000000LL;
+}
 
-static void probe_and_maybe_add(uint32_t a, int port) {
-    struct in_addr t; t.s_addr = htonl(a);
-    char tip[16]; if (!inet_ntop(AF_INET, &t, tip, sizeof(tip))) { __sync_add_and_fetch(&g_scan_done, 1); return; }
+static int probe_open(probe_t *p, int ep, int port, int caps_only) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
 
-    char resp[8192];
+    struct sockaddr_in sa; memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_port   = htons((uint16_t)port);
+    if (inet_pton(AF_INET, p->ip, &sa.sin_addr) != 1) { close(fd); return -1; }
+
+    int r = connect(fd, (struct sockaddr*)&sa, sizeof(sa));
+    if (r != 0 && errno != EINPROGRESS) { close(fd); return -1; }
+
+    int n;
+    if (caps_only) {
+        n = snprintf(p->req, sizeof(p->req),
+                     "GET /caps HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n",
+                     p->ip);
+    } else {
+        n = snprintf(p->req, sizeof(p->req),
+                     "GET /health HTTP/1.1\r\nHost: %s\r\n\r\n"
+                     "GET /caps HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n",
+                     p->ip, p->ip);
+    }
+    if (n < 0 || n >= (int)sizeof(p->req)) { close(fd); return -1; }
+    p->req_len  = (size_t)n;
+    p->wr       = 0;
+    p->rd       = 0;
+    p->fd       = fd;
+    p->state    = caps_only ? PROBE_CAPS_CONNECTING : PROBE_CONNECTING;
+    p->deadline = now_ms_mono() + g_tun.connect_timeout_ms;
+
+    struct epoll_event ev = { .events = EPOLLOUT, .data.ptr = p };
+    if (epoll_ctl(ep, EPOLL_CTL_ADD, fd, &ev) != 0) { close(fd); p->fd = -1; return -1; }
+    return 0;
+}
+
+static void probe_close(probe_t *p) {
+    if (p->fd >= 0) { close(p->fd); p->fd = -1; }
+}
+
+// Locate the pipelined /caps response. Returns its body, or NULL when only
+// the /health response arrived (peer closed after the first request).
+static const char *probe_second_body(const char *resp) {
+    const char *body = http_body_ptr(resp);
+    if (!body) return NULL;
+    const char *second = strstr(body, "HTTP/1.");
+    if (!second) return NULL;
+    if (strncmp(second, "HTTP/1.1 200", 12) != 0 && strncmp(second, "HTTP/1.0 200", 12) != 0)
+        return NULL;
+    return http_body_ptr(second);
+}
 
-    // Quick: /health (allows super short timeout to skip dead hosts fast)
-    int r = http_get_simple(tip, port, "/health", resp, sizeof(resp), g_tun.health_timeout_ms);
-    if (r != 0) { __sync_add_and_fetch(&g_scan_done, 1); return; }
-
-    // Detail: /caps
-    r = http_get_simple(tip, port, "/caps", resp, sizeof(resp), g_tun.caps_timeout_ms);
-    if (r == 0) {
-        const char *body = http_body_ptr(resp);
-        if (body) {
-            JSON_Value *v = json_parse_string(body);
-            if (v) {
-                JSON_Object *o = json_object(v);
-                scan_node_t ni; memset(&ni, 0, sizeof(ni));
-                strncpy(ni.ip, tip, sizeof(ni.ip)-1);
-                ni.port = port;
-                const char *role   = json_object_get_string(o, "role");
-                const char *device = json_object_get_string(o, "device");
-                const char *ver    = json_object_get_string(o, "version");
-                if (role)   strncpy(ni.role,    role,   sizeof(ni.role)-1);
-                if (device) strncpy(ni.device,  device, sizeof(ni.device)-1);
-                if (ver)    strncpy(ni.version, ver,    sizeof(ni.version)-1);
-                JSON_Object *sync = json_object_get_object(o, "sync");
-                if (sync) {
-                    const char *sync_role = json_object_get_string(sync, "role");
-                    const char *sync_id = json_object_get_string(sync, "id");
-                    if (sync_role) strncpy(ni.sync_role, sync_role, sizeof(ni.sync_role) - 1);
-                    if (sync_id)   strncpy(ni.sync_id,   sync_id,   sizeof(ni.sync_id) - 1);
-                }
-                ni.last_seen = now_s();
-                ni.seen_scan = g_scan_seq;
-                // keep is_self=0 by default
-                nodes_upsert(&ni);
-                json_value_free(v);
+// Returns 1 when the probe is finished (slot freed), 0 when it is still live.
+static int probe_handle_event(probe_t *p, int ep, int port, uint32_t events) {
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        // EOF while reading is the normal end-of-response signal
+        if (p->state != PROBE_READING && p->state != PROBE_CAPS_READING) {
+            probe_close(p);
+            return 1;
+        }
+    }
+
+    switch (p->state) {
+    case PROBE_CONNECTING:
+    case PROBE_CAPS_CONNECTING: {
+        int err = 0; socklen_t el = sizeof(err);
+        if (getsockopt(p->fd, SOL_SOCKET, SO_ERROR, &err, &el) != 0 || err != 0) {
+            probe_close(p);
+            return 1;
+        }
+        p->state = (p->state == PROBE_CONNECTING) ? PROBE_SENDING : PROBE_CAPS_SENDING;
+        p->deadline = now_ms_mono() + g_tun.health_timeout_ms + g_tun.caps_timeout_ms;
+    }
+    /* fall through */
+    case PROBE_SENDING:
+    case PROBE_CAPS_SENDING: {
+        while (p->wr < p->req_len) {
+            ssize_t w = write(p->fd, p->req + p->wr, p->req_len - p->wr);
+            if (w > 0) { p->wr += (size_t)w; continue; }
+            if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+            probe_close(p);
+            return 1;
+        }
+        p->state = (p->state == PROBE_SENDING) ? PROBE_READING : PROBE_CAPS_READING;
+        struct epoll_event ev = { .events = EPOLLIN, .data.ptr = p };
+        (void)epoll_ctl(ep, EPOLL_CTL_MOD, p->fd, &ev);
+        return 0;
+    }
+    case PROBE_READING:
+    case PROBE_CAPS_READING: {
+        int eof = 0;
+        for (;;) {
+            ssize_t r = read(p->fd, p->resp + p->rd, (sizeof(p->resp) - 1) - p->rd);
+            if (r > 0) {
+                p->rd += (size_t)r;
+                if (p->rd >= sizeof(p->resp) - 1) { eof = 1; break; }
+                continue;
             }
+            if (r == 0) { eof = 1; break; }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            eof = 1;
+            break;
+        }
+        if (!eof) return 0;
+
+        p->resp[p->rd] = '\0';
+        if (strncmp(p->resp, "HTTP/1.1 200", 12) != 0 && strncmp(p->resp, "HTTP/1.0 200", 12) != 0) {
+            probe_close(p);
+            return 1;
+        }
+
+        if (p->state == PROBE_CAPS_READING) {
+            const char *body = http_body_ptr(p->resp);
+            if (body) (void)node_from_caps_body(p->ip, port, body, 1);
+            probe_close(p);
+            return 1;
+        }
+
+        const char *caps_body = probe_second_body(p->resp);
+        if (caps_body) {
+            (void)node_from_caps_body(p->ip, port, caps_body, 1);
+            probe_close(p);
+            return 1;
         }
+
+        // Healthy but the peer closed before answering the pipelined /caps:
+        // re-dial the same slot for a caps-only request.
+        probe_close(p);
+        if (probe_open(p, ep, port, 1) != 0) return 1;
+        return 0;
     }
-    __sync_add_and_fetch(&g_scan_done, 1);
+    }
+    return 0;
 }
 
-static void *worker_fn(void *arg) {
-    work_ctx_t *wc = (work_ctx_t*)arg;
-    for (;;) {
-        unsigned i = __sync_fetch_and_add(wc->next_idx, 1);
-        if (i >= wc->count) break;
-        probe_and_maybe_add(wc->targets[i], wc->port);
+static void scan_run_engine(const uint32_t *targets, unsigned count, int port) {
+    unsigned max_inflight = g_tun.concurrency;
+    if (max_inflight == 0) max_inflight = 1;
+    if (max_inflight > count && count > 0) max_inflight = count;
+
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    if (ep < 0) { __sync_lock_test_and_set(&g_scan_done, count); return; }
+
+    probe_t *slots = calloc(max_inflight, sizeof(probe_t));
+    if (!slots) { close(ep); __sync_lock_test_and_set(&g_scan_done, count); return; }
+    for (unsigned i = 0; i < max_inflight; i++) slots[i].fd = -1;
+
+    struct epoll_event evs[64];
+    unsigned next = 0, active = 0;
+
+    while (g_scan_done < count) {
+        // Top up free slots with fresh connects
+        for (unsigned i = 0; i < max_inflight && next < count; i++) {
+            if (slots[i].fd >= 0) continue;
+            probe_t *p = &slots[i];
+            struct in_addr t; t.s_addr = htonl(targets[next++]);
+            if (!inet_ntop(AF_INET, &t, p->ip, sizeof(p->ip)) ||
+                probe_open(p, ep, port, 0) != 0) {
+                __sync_add_and_fetch(&g_scan_done, 1);
+                i--; // slot still free, try the next target
+                continue;
+            }
+            active++;
+        }
+        g_scan_inflight = active;
+        if (active == 0) {
+            if (next >= count) break;
+            continue;
+        }
+
+        // Wake at least every 50ms to expire deadlines
+        int n = epoll_wait(ep, evs, (int)(sizeof(evs)/sizeof(evs[0])), 50);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int e = 0; e < n; e++) {
+            probe_t *p = (probe_t*)evs[e].data.ptr;
+            if (p->fd < 0) continue;
+            if (probe_handle_event(p, ep, port, evs[e].events)) {
+                active--;
+                __sync_add_and_fetch(&g_scan_done, 1);
+            }
+        }
+
+        long long now = now_ms_mono();
+        for (unsigned i = 0; i < max_inflight; i++) {
+            if (slots[i].fd < 0 || now < slots[i].deadline) continue;
+            probe_close(&slots[i]);
+            active--;
+            __sync_add_and_fetch(&g_scan_done, 1);
+        }
+        g_scan_inflight = active;
     }
-    return NULL;
+
+    for (unsigned i = 0; i < max_inflight; i++) probe_close(&slots[i]);
+    g_scan_inflight = 0;
+    free(slots);
+    close(ep);
 }
 
 // ================ Scan thread ================
@@ -489,37 +881,217 @@ static void *scan_thread(void *arg) {
     // Seed/refresh self nodes (keep them resident)
     scan_seed_self_nodes(&sc->cfg);
 
-    // Worker pool
-    unsigned workers = g_tun.concurrency;
-    if (workers == 0) workers = 1;
-    if (workers > 64) workers = 64; // sane cap
-
-    pthread_t tids[64];
-    volatile unsigned next_idx = 0;
-    work_ctx_t wc = { .targets = targets.ips, .count = targets.n, .next_idx = &next_idx, .port = sc->cfg.port };
-
-    for (unsigned i=0;i<workers;i++){
-        pthread_create(&tids[i], NULL, worker_fn, (void*)&wc);
-    }
-    for (unsigned i=0;i<workers;i++){
-        if (i < workers) pthread_join(tids[i], NULL);
-    }
+    // Drive every probe from this one thread via epoll
+    scan_run_engine(targets.ips, targets.n, sc->cfg.port);
 
     // Prune stales (nodes not seen in this seq)
     nodes_prune_after_scan(seq);
 
     g_last_finished = now_s();
+    metrics_record_scan((long long)((g_last_finished - g_last_started) * 1e6));
+    table_gen_bump();
     __sync_lock_release(&g_scan_in_progress);
     free(sc);
     return NULL;
 }
 
+// ================ UDP announce discovery ================
+//
+// Sends a small identity datagram to a multicast group (with a subnet
+// broadcast fallback) every interval, and feeds received announces straight
+// into the node cache. O(#nodes) instead of O(subnet size).
+
+typedef struct {
+    volatile int  running;
+    volatile int  stop;
+    pthread_t     tx_thread;
+    pthread_t     rx_thread;
+    int           port;        // announce UDP port
+    int           interval_s;
+    scan_config_t cfg;
+} announce_state_t;
+
+static announce_state_t g_ann = {0};
+
+static int ip_is_self(const char *ip) {
+    int self = 0;
+    pthread_mutex_lock(&g_nodes_mx);
+    for (int i = 0; i < g_nodes_count; i++) {
+        if (g_nodes[i].is_self && strcmp(g_nodes[i].ip, ip) == 0) { self = 1; break; }
+    }
+    pthread_mutex_unlock(&g_nodes_mx);
+    return self;
+}
+
+static char *announce_build_payload(const scan_config_t *cfg) {
+    JSON_Value *v = json_value_init_object();
+    JSON_Object *o = json_object(v);
+    json_object_set_number(o, "autod_announce", 1);
+    json_object_set_number(o, "port", cfg->port);
+    if (cfg->role[0])    json_object_set_string(o, "role",    cfg->role);
+    if (cfg->device[0])  json_object_set_string(o, "device",  cfg->device);
+    if (cfg->version[0]) json_object_set_string(o, "version", cfg->version);
+    if (cfg->sync_role[0] || cfg->sync_id[0]) {
+        JSON_Value *sv = json_value_init_object();
+        JSON_Object *so = json_object(sv);
+        if (cfg->sync_role[0]) json_object_set_string(so, "role", cfg->sync_role);
+        if (cfg->sync_id[0])   json_object_set_string(so, "id",   cfg->sync_id);
+        json_object_set_value(o, "sync", sv);
+    }
+    char *s = json_serialize_to_string(v);
+    json_value_free(v);
+    return s; // caller frees with json_free_serialized_string()
+}
+
+static void *announce_tx_thread(void *arg) {
+    (void)arg;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return NULL;
+
+    int ttl = 1;
+    (void)setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    int on = 1;
+    (void)setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+
+    struct sockaddr_in mcast; memset(&mcast, 0, sizeof(mcast));
+    mcast.sin_family = AF_INET;
+    mcast.sin_port   = htons((uint16_t)g_ann.port);
+    inet_pton(AF_INET, SCAN_ANNOUNCE_GROUP, &mcast.sin_addr);
+
+    struct sockaddr_in bcast = mcast;
+    bcast.sin_addr.s_addr = htonl(INADDR_BROADCAST);
+
+    while (!g_ann.stop) {
+        char *payload = announce_build_payload(&g_ann.cfg);
+        if (payload) {
+            size_t len = strlen(payload);
+            (void)sendto(fd, payload, len, 0, (struct sockaddr*)&mcast, sizeof(mcast));
+            (void)sendto(fd, payload, len, 0, (struct sockaddr*)&bcast, sizeof(bcast));
+            json_free_serialized_string(payload);
+        }
+        for (int i = 0; i < g_ann.interval_s * 2 && !g_ann.stop; i++) {
+            struct timespec ts = { 0, 500L * 1000L * 1000L };
+            nanosleep(&ts, NULL);
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+static void announce_handle_datagram(const char *buf, const char *sender_ip) {
+    JSON_Value *v = json_parse_string(buf);
+    if (!v) return;
+    JSON_Object *o = json_object(v);
+    if (!o || json_object_get_number(o, "autod_announce") != 1) {
+        json_value_free(v);
+        return;
+    }
+
+    int port = (int)json_object_get_number(o, "port");
+    if (port <= 0 || port > 65535 ||
+        (port == g_ann.cfg.port && ip_is_self(sender_ip))) {
+        json_value_free(v);
+        return;
+    }
+
+    scan_node_t ni; memset(&ni, 0, sizeof(ni));
+    strncpy(ni.ip, sender_ip, sizeof(ni.ip) - 1);
+    ni.port = port;
+    const char *role   = json_object_get_string(o, "role");
+    const char *device = json_object_get_string(o, "device");
+    const char *ver    = json_object_get_string(o, "version");
+    if (role)   strncpy(ni.role,    role,   sizeof(ni.role) - 1);
+    if (device) strncpy(ni.device,  device, sizeof(ni.device) - 1);
+    if (ver)    strncpy(ni.version, ver,    sizeof(ni.version) - 1);
+    JSON_Object *sync = json_object_get_object(o, "sync");
+    if (sync) {
+        const char *sync_role = json_object_get_string(sync, "role");
+        const char *sync_id = json_object_get_string(sync, "id");
+        if (sync_role) strncpy(ni.sync_role, sync_role, sizeof(ni.sync_role) - 1);
+        if (sync_id)   strncpy(ni.sync_id,   sync_id,   sizeof(ni.sync_id) - 1);
+    }
+    ni.last_seen = now_s();
+    ni.seen_scan = g_scan_seq; // count as seen so sweeps don't prune announcers
+    nodes_upsert(&ni);
+    json_value_free(v);
+}
+
+static void *announce_rx_thread(void *arg) {
+    (void)arg;
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return NULL;
+
+    int on = 1;
+    (void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    struct sockaddr_in sa; memset(&sa, 0, sizeof(sa));
+    sa.sin_family      = AF_INET;
+    sa.sin_port        = htons((uint16_t)g_ann.port);
+    sa.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    struct ip_mreq mreq; memset(&mreq, 0, sizeof(mreq));
+    inet_pton(AF_INET, SCAN_ANNOUNCE_GROUP, &mreq.imr_multiaddr);
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    (void)setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq));
+
+    struct timeval tv = { 0, 500 * 1000 }; // wake to check stop flag
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    while (!g_ann.stop) {
+        char buf[1024];
+        struct sockaddr_in peer; socklen_t pl = sizeof(peer);
+        ssize_t r = recvfrom(fd, buf, sizeof(buf) - 1, 0, (struct sockaddr*)&peer, &pl);
+        if (r <= 0) continue;
+        buf[r] = '\0';
+
+        char sender_ip[16];
+        if (!inet_ntop(AF_INET, &peer.sin_addr, sender_ip, sizeof(sender_ip))) continue;
+        announce_handle_datagram(buf, sender_ip);
+    }
+    close(fd);
+    return NULL;
+}
+
+int scan_announce_start(const scan_config_t *cfg, int announce_port, int interval_s) {
+    if (!cfg) return -1;
+    if (g_ann.running) return 1;
+
+    g_ann.cfg        = *cfg;
+    g_ann.port       = (announce_port > 0 && announce_port <= 65535) ? announce_port : SCAN_ANNOUNCE_PORT;
+    g_ann.interval_s = (interval_s > 0) ? interval_s : 5;
+    g_ann.stop       = 0;
+
+    if (pthread_create(&g_ann.rx_thread, NULL, announce_rx_thread, NULL) != 0) return -1;
+    if (pthread_create(&g_ann.tx_thread, NULL, announce_tx_thread, NULL) != 0) {
+        g_ann.stop = 1;
+        pthread_join(g_ann.rx_thread, NULL);
+        g_ann.stop = 0;
+        return -1;
+    }
+    g_ann.running = 1;
+    return 0;
+}
+
+void scan_announce_stop(void) {
+    if (!g_ann.running) return;
+    g_ann.stop = 1;
+    pthread_join(g_ann.tx_thread, NULL);
+    pthread_join(g_ann.rx_thread, NULL);
+    g_ann.running = 0;
+    g_ann.stop = 0;
+}
+
 int scan_start_async(const scan_config_t *cfg) {
     if (!cfg) return -1;
     g_cfg = *cfg;
     if (!__sync_bool_compare_and_swap(&g_scan_in_progress, 0, 1)) {
         return 1; // already running
     }
+    table_gen_bump();
 
     pthread_t th;
     scan_ctx_t *sc = (scan_ctx_t*)malloc(sizeof(*sc));
@@ -536,3 +1108,30 @@ int scan_start_async(const scan_config_t *cfg) {
     __sync_lock_release(&g_scan_in_progress);
     return -1;
 }
+
+#else /* AUTOD_NO_SCAN */
+
+// Slim-profile stubs: no node table, no sweeps, no announce threads.
+// /nodes reports an empty fleet and scan_start_async fails cleanly.
+void scan_init(void) {}
+void scan_set_tuning(const scan_tuning_t *t) { (void)t; }
+void scan_reset_nodes(void) {}
+void scan_seed_self_nodes(const scan_config_t *cfg) { (void)cfg; }
+int  scan_start_async(const scan_config_t *cfg) { (void)cfg; return -1; }
+int  scan_is_running(void) { return 0; }
+void scan_get_status(scan_status_t *st) { if (st) memset(st, 0, sizeof(*st)); }
+int  scan_get_nodes(scan_node_t *dst, int max) { (void)dst; (void)max; return 0; }
+int  scan_node_count(void) { return 0; }
+scan_node_t *scan_copy_nodes(int *count) { if (count) *count = 0; return NULL; }
+unsigned scan_table_generation(void) { return 0; }
+int  scan_find_node(const char *ip, int port, scan_node_t *out) {
+    (void)ip; (void)port; (void)out; return -1;
+}
+int  scan_cache_attach(const char *path) { (void)path; return -1; }
+int  scan_probe_node(const char *ip, int port) { (void)ip; (void)port; return -1; }
+int  scan_announce_start(const scan_config_t *cfg, int announce_port, int interval_s) {
+    (void)cfg; (void)announce_port; (void)interval_s; return -1;
+}
+void scan_announce_stop(void) {}
+
+#endif /* AUTOD_NO_SCAN */
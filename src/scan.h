@@ -6,6 +6,8 @@
 extern "C" {
 #endif
 
+// Initial node-store capacity and the copy bound for the fixed-buffer
+// scan_get_nodes(); the store itself grows past this as the fleet does.
 #ifndef SCAN_MAX_NODES
 #define SCAN_MAX_NODES 64
 #endif
@@ -30,6 +32,7 @@ typedef struct {
     int      scanning;        // 0/1
     unsigned targets;         // planned targets this scan
     unsigned done;            // completed probes
+    unsigned in_flight;       // probes currently in flight
     int      progress_pct;    // 0..100
     double   last_started;    // time(NULL) or 0
     double   last_finished;   // time(NULL) or 0
@@ -60,7 +63,7 @@ typedef struct {
     int      connect_timeout_ms; // default 200
     int      health_timeout_ms;  // default 150
     int      caps_timeout_ms;    // default 400
-    unsigned concurrency;        // default 16 (workers)
+    unsigned concurrency;        // default 128 (max in-flight probes)
     unsigned stale_max_misses;   // default 2 (prune if unseen for N scans)
 } scan_tuning_t;
 
@@ -91,10 +94,50 @@ void scan_get_status(scan_status_t *st);
 // Copy up to max nodes into dst; returns count copied.
 int  scan_get_nodes(scan_node_t *dst, int max);
 
+// Current number of cached nodes.
+int  scan_node_count(void);
+
+// Malloc'd snapshot of the whole cache (caller frees); NULL when empty.
+scan_node_t *scan_copy_nodes(int *count);
+
+// Monotonic counter bumped on every node-table mutation and scan start/finish.
+// Lets callers cache derived views (e.g. serialized /nodes responses) and
+// revalidate them cheaply.
+unsigned scan_table_generation(void);
+
+// O(1) lookup by exact ip:port via the hash index. Returns 0 and fills *out
+// (if non-NULL) on a hit, -1 on a miss.
+int  scan_find_node(const char *ip, int port, scan_node_t *out);
+
+// Back the node store with a memory-mapped cache file so a restarted daemon
+// comes up warm. Creates/validates the file and adopts any persisted entries
+// (self flags and staleness counters are reset). Call before seeding/scans.
+// Returns 0 on success, -1 on error (store stays in-memory).
+int  scan_cache_attach(const char *path);
+
 // Probe a specific host:port once and refresh the node cache if it responds.
 // Returns 0 on success, non-zero on failure.
 int  scan_probe_node(const char *ip, int port);
 
+// ---- UDP announce discovery (optional, complements the sweep) ----
+
+#ifndef SCAN_ANNOUNCE_GROUP
+#define SCAN_ANNOUNCE_GROUP "239.255.77.67"
+#endif
+#ifndef SCAN_ANNOUNCE_PORT
+#define SCAN_ANNOUNCE_PORT 47800
+#endif
+
+// Start the periodic announce sender and listener threads. Each node emits a
+// small datagram with the same identity fields /caps carries; received
+// announces feed the node cache directly, so peers appear in /nodes within
+// one interval instead of one full sweep.
+// Returns 0 = started, 1 = already running, -1 = error.
+int  scan_announce_start(const scan_config_t *cfg, int announce_port, int interval_s);
+
+// Stop announce threads (blocks until both exit). Safe if not running.
+void scan_announce_stop(void);
+
 #ifdef __cplusplus
 }
 #endif
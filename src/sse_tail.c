@@ -32,6 +32,8 @@
 #include <unistd.h>
 
 #define MAX_CLIENTS    64
+#define CLIENT_QUEUE_CAP 64   // frames buffered per client before drop-oldest
+#define WRITEV_BATCH   16     // queued frames coalesced into one sendmsg
 #define REQ_BUFSZ      2048
 #define LINE_BUFSZ     4096
 #define OUT_BUFSZ      8192
@@ -149,11 +151,133 @@ static size_t json_escape(const char *in, size_t inlen, char *out, size_t outcap
     return o;
 }
 
+// A line is formatted into one refcounted frame and shared by every client;
+// each client keeps a small queue of frame pointers with drop-oldest
+// backpressure so one stalled viewer can't block or bloat the others.
+struct frame {
+    char *data;
+    size_t len;
+    int refs;
+};
+
+static struct frame *frame_new(const char *buf, size_t len) {
+    struct frame *f = malloc(sizeof(*f));
+    if (!f) return NULL;
+    f->data = malloc(len);
+    if (!f->data) { free(f); return NULL; }
+    memcpy(f->data, buf, len);
+    f->len = len;
+    f->refs = 1;
+    return f;
+}
+
+static struct frame *frame_ref(struct frame *f) { f->refs++; return f; }
+
+static void frame_unref(struct frame *f) {
+    if (f && --f->refs == 0) {
+        free(f->data);
+        free(f);
+    }
+}
+
+static struct frame *frame_format(const char *event, uint64_t id, const char *json) {
+    char buf[OUT_BUFSZ];
+    int fl = snprintf(buf, sizeof(buf),
+                      "event: %s\n"
+                      "id: %llu\n"
+                      "data: %s\n"
+                      "\n",
+                      event, (unsigned long long)id, json);
+    if (fl < 0) fl = 0;
+    if ((size_t)fl >= sizeof(buf)) fl = (int)sizeof(buf) - 1;
+    return frame_new(buf, (size_t)fl);
+}
+
 struct client {
     int fd;
     uint64_t last_send_ms;
+    struct frame *q[CLIENT_QUEUE_CAP];
+    size_t qhead;
+    size_t qcount;
+    size_t qoff;       // bytes of the front frame already sent
+    uint64_t dropped;  // frames discarded by drop-oldest backpressure
 };
 
+static void client_queue_clear(struct client *c) {
+    for (size_t i = 0; i < c->qcount; i++) {
+        frame_unref(c->q[(c->qhead + i) % CLIENT_QUEUE_CAP]);
+    }
+    c->qhead = c->qcount = c->qoff = 0;
+}
+
+// Takes ownership of one reference to f.
+static void client_enqueue(struct client *c, struct frame *f) {
+    if (c->qcount == CLIENT_QUEUE_CAP) {
+        if (c->qoff > 0 && c->qcount > 1) {
+            // front frame is partially on the wire: dropping it would corrupt
+            // SSE framing, so drop the next-oldest instead
+            size_t idx = (c->qhead + 1) % CLIENT_QUEUE_CAP;
+            frame_unref(c->q[idx]);
+            for (size_t i = 1; i + 1 < c->qcount; i++) {
+                size_t a = (c->qhead + i) % CLIENT_QUEUE_CAP;
+                size_t b = (c->qhead + i + 1) % CLIENT_QUEUE_CAP;
+                c->q[a] = c->q[b];
+            }
+            c->qcount--;
+        } else {
+            frame_unref(c->q[c->qhead]);
+            c->qhead = (c->qhead + 1) % CLIENT_QUEUE_CAP;
+            c->qcount--;
+            c->qoff = 0;
+        }
+        c->dropped++;
+    }
+    c->q[(c->qhead + c->qcount) % CLIENT_QUEUE_CAP] = f;
+    c->qcount++;
+}
+
+// Flush as much queued data as the socket accepts, batching several frames
+// into one sendmsg. Returns -1 on hard error (caller drops the client).
+static int client_flush(struct client *c) {
+    while (c->qcount > 0) {
+        struct iovec iov[WRITEV_BATCH];
+        int n = 0;
+        for (; n < WRITEV_BATCH && (size_t)n < c->qcount; n++) {
+            struct frame *f = c->q[(c->qhead + (size_t)n) % CLIENT_QUEUE_CAP];
+            size_t skip = (n == 0) ? c->qoff : 0;
+            iov[n].iov_base = f->data + skip;
+            iov[n].iov_len  = f->len - skip;
+        }
+        struct msghdr mh; memset(&mh, 0, sizeof(mh));
+        mh.msg_iov = iov;
+        mh.msg_iovlen = (size_t)n;
+        ssize_t w = sendmsg(c->fd, &mh, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+            return -1;
+        }
+        c->last_send_ms = now_ms();
+        size_t left = (size_t)w;
+        while (left > 0 && c->qcount > 0) {
+            struct frame *f = c->q[c->qhead];
+            size_t remain = f->len - c->qoff;
+            if (left >= remain) {
+                left -= remain;
+                frame_unref(f);
+                c->q[c->qhead] = NULL;
+                c->qhead = (c->qhead + 1) % CLIENT_QUEUE_CAP;
+                c->qcount--;
+                c->qoff = 0;
+            } else {
+                c->qoff += left;
+                left = 0;
+            }
+        }
+    }
+    return 0;
+}
+
 static int send_str(int fd, const char *s) {
     size_t off = 0;
     size_t total = strlen(s);
@@ -171,9 +295,11 @@ static int send_str(int fd, const char *s) {
 
 static int send_heartbeat(struct client *c, uint64_t now) {
     // SSE comment line (just a colon) + blank line
-    static const char *hb = ":\n\n";
-    if (send_str(c->fd, hb) < 0) return -1;
-    c->last_send_ms = now;
+    struct frame *hb = frame_new(":\n\n", 3);
+    if (!hb) return 0;
+    client_enqueue(c, hb);
+    if (client_flush(c) < 0) return -1;
+    (void)now;
     return 0;
 }
 
@@ -224,6 +350,7 @@ static int open_listener(const char *host, uint16_t port) {
 
 static void drop_client(struct client *clients, int *nclients, int idx) {
     if (idx < 0 || idx >= *nclients) return;
+    client_queue_clear(&clients[idx]);
     close(clients[idx].fd);
     if (idx != *nclients - 1) clients[idx] = clients[*nclients - 1];
     (*nclients)--;
@@ -309,6 +436,7 @@ static int accept_http_or_404(int lfd, struct client *clients, int *nclients, in
         // Optional: advertise retry interval to EventSource clients
         (void)send_str(cfd, "retry: 2000\n\n");
         if (*nclients < MAX_CLIENTS) {
+            memset(&clients[*nclients], 0, sizeof(clients[*nclients]));
             clients[*nclients].fd = cfd;
             clients[*nclients].last_send_ms = now_ms();
             if (new_idx) *new_idx = *nclients;
@@ -328,30 +456,20 @@ static int accept_http_or_404(int lfd, struct client *clients, int *nclients, in
 
 
 
-static int send_event_frame(int fd, const char *event, uint64_t id, const char *json) {
-    char frame[OUT_BUFSZ];
-    int fl = snprintf(frame, sizeof(frame),
-                      "event: %s\n"
-                      "id: %llu\n"
-                      "data: %s\n"
-                      "\n",
-                      event, (unsigned long long)id, json);
-    if (fl < 0) fl = 0;
-    if ((size_t)fl >= sizeof(frame)) fl = (int)sizeof(frame) - 1;
-    frame[(size_t)fl] = '\0';
-    return send_str(fd, frame);
-}
-
 static void broadcast(struct client *clients, int *nclients,
                       const char *event, uint64_t id, const char *json) {
+    if (*nclients == 0) return;
+    struct frame *f = frame_format(event, id, json);
+    if (!f) return;
     for (int i = 0; i < *nclients; ) {
-        if (send_event_frame(clients[i].fd, event, id, json) < 0) {
+        client_enqueue(&clients[i], frame_ref(f));
+        if (client_flush(&clients[i]) < 0) {
             drop_client(clients, nclients, i);
             continue;
         }
-        clients[i].last_send_ms = now_ms();
         i++;
     }
+    frame_unref(f);
 }
 
 static void queue_drain_lifo(struct line_queue *q, const char *stream,
@@ -453,10 +571,12 @@ static void emit_status_snapshot(struct client *clients, int *nclients, int targ
 
     (*msg_id)++;
     if (target_idx >= 0 && target_idx < *nclients) {
-        if (send_event_frame(clients[target_idx].fd, stream_status, *msg_id, json) < 0) {
-            drop_client(clients, nclients, target_idx);
-        } else {
-            clients[target_idx].last_send_ms = now_ms();
+        struct frame *f = frame_format(stream_status, *msg_id, json);
+        if (f) {
+            client_enqueue(&clients[target_idx], f);
+            if (client_flush(&clients[target_idx]) < 0) {
+                drop_client(clients, nclients, target_idx);
+            }
         }
     } else {
         broadcast(clients, nclients, stream_status, *msg_id, json);
@@ -583,18 +703,33 @@ int main(int argc, char **argv) {
         if (g_stop) break;
 
         fd_set rfds; FD_ZERO(&rfds);
+        fd_set wfds; FD_ZERO(&wfds);
         int maxfd = lfd; FD_SET(lfd, &rfds);
         FD_SET(outp[0], &rfds); if (outp[0] > maxfd) maxfd = outp[0];
         FD_SET(errp[0], &rfds); if (errp[0] > maxfd) maxfd = errp[0];
+        for (int i = 0; i < nclients; i++) {
+            if (clients[i].qcount > 0) {
+                FD_SET(clients[i].fd, &wfds);
+                if (clients[i].fd > maxfd) maxfd = clients[i].fd;
+            }
+        }
 
         struct timeval tv; tv.tv_sec = 0; tv.tv_usec = 200 * 1000; // 200ms
-        int rv = select(maxfd + 1, &rfds, NULL, NULL, &tv);
+        int rv = select(maxfd + 1, &rfds, &wfds, NULL, &tv);
         if (rv < 0) {
             if (errno == EINTR) continue;
             perror("select");
             break;
         }
 
+        for (int i = 0; i < nclients; ) {
+            if (FD_ISSET(clients[i].fd, &wfds) && client_flush(&clients[i]) < 0) {
+                drop_client(clients, &nclients, i);
+                continue;
+            }
+            i++;
+        }
+
         if (FD_ISSET(lfd, &rfds)) {
             int added_idx = -1;
             while (accept_http_or_404(lfd, clients, &nclients, &added_idx) == 0) {
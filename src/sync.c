@@ -12,12 +12,15 @@
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <sys/time.h>
+#include <time.h>
 
 #include "civetweb.h"
 #include "parson.h"
 #include "scan.h"
 #include "autod.h"
 #include "sync.h"
+#include "http_pool.h"
+#include "metrics.h"
 
 extern volatile sig_atomic_t g_stop;
 
@@ -183,7 +186,14 @@ void sync_slave_state_init(sync_slave_state_t *state) {
 void sync_master_state_init(sync_master_state_t *state) {
     if (!state) return;
     pthread_mutex_init(&state->lock, NULL);
-    memset(state->records, 0, sizeof(state->records));
+    pthread_cond_init(&state->change_cond, NULL);
+    state->wait_count = 0;
+    state->records = NULL;
+    state->record_count = 0;
+    state->record_cap = 0;
+    state->id_idx = NULL;
+    state->id_idx_cap = 0;
+    state->last_prune_ms = 0;
     memset(state->slot_generation, 0, sizeof(state->slot_generation));
     memset(state->slot_assignees, 0, sizeof(state->slot_assignees));
     memset(state->slot_manual_overrides, 0, sizeof(state->slot_manual_overrides));
@@ -261,16 +271,90 @@ void sync_slave_get_current_slot_label(sync_slave_state_t *state, char *out, siz
     pthread_mutex_unlock(&state->lock);
 }
 
+// ---- master role ----
+// Everything from here through the /sync/* handlers is the master side of
+// the protocol; the slim profile (-DAUTOD_NO_SYNC_MASTER) compiles it out
+// and keeps only the slave role.
+#ifndef AUTOD_NO_SYNC_MASTER
+
+// ---- slave table: growable store + hash index on id (callers hold lock) ----
+
+static unsigned sync_id_hash(const char *id) {
+    unsigned h = 5381;
+    while (*id) h = h * 33u + (unsigned char)*id++;
+    return h;
+}
+
+static void sync_idx_insert(sync_master_state_t *state, int rec_index) {
+    if (!state->id_idx_cap) return;
+    unsigned mask = state->id_idx_cap - 1;
+    unsigned h = sync_id_hash(state->records[rec_index].id) & mask;
+    while (state->id_idx[h]) h = (h + 1) & mask;
+    state->id_idx[h] = rec_index + 1;
+}
+
+static void sync_idx_rebuild(sync_master_state_t *state) {
+    unsigned used = 0;
+    for (int i = 0; i < state->record_count; i++) {
+        if (state->records[i].in_use) used++;
+    }
+    unsigned want = 16;
+    while (want < used * 2u) want <<= 1;
+    if (want != state->id_idx_cap) {
+        int *n = realloc(state->id_idx, want * sizeof(int));
+        if (!n) return; // keep the old index; linear fallback still works
+        state->id_idx = n;
+        state->id_idx_cap = want;
+    }
+    memset(state->id_idx, 0, state->id_idx_cap * sizeof(int));
+    for (int i = 0; i < state->record_count; i++) {
+        if (state->records[i].in_use) sync_idx_insert(state, i);
+    }
+}
+
+static int sync_records_reserve(sync_master_state_t *state, int need) {
+    if (need <= state->record_cap) return 0;
+    int ncap = state->record_cap ? state->record_cap * 2 : SYNC_MAX_SLAVES;
+    while (ncap < need) ncap *= 2;
+    sync_slave_record_t *n = realloc(state->records, (size_t)ncap * sizeof(*n));
+    if (!n) return -1;
+    memset(n + state->record_cap, 0,
+           (size_t)(ncap - state->record_cap) * sizeof(*n));
+    state->records = n;
+    state->record_cap = ncap;
+    return 0;
+}
+
 static sync_slave_record_t *sync_master_find_record(sync_master_state_t *state, const char *id, int create) {
     if (!state || !id || !*id) return NULL;
-    sync_slave_record_t *slot = NULL;
-    for (int i = 0; i < SYNC_MAX_SLAVES; i++) {
-        if (state->records[i].in_use && strcmp(state->records[i].id, id) == 0) {
-            return &state->records[i];
+    if (state->id_idx_cap) {
+        unsigned mask = state->id_idx_cap - 1;
+        unsigned h = sync_id_hash(id) & mask;
+        while (state->id_idx[h]) {
+            int i = state->id_idx[h] - 1;
+            if (i < state->record_count && state->records[i].in_use &&
+                strcmp(state->records[i].id, id) == 0) {
+                return &state->records[i];
+            }
+            h = (h + 1) & mask;
+        }
+    } else {
+        for (int i = 0; i < state->record_count; i++) {
+            if (state->records[i].in_use && strcmp(state->records[i].id, id) == 0) {
+                return &state->records[i];
+            }
         }
-        if (!state->records[i].in_use && !slot) slot = &state->records[i];
     }
-    if (!create || !slot) return NULL;
+    if (!create) return NULL;
+    int idx = -1;
+    for (int i = 0; i < state->record_count; i++) {
+        if (!state->records[i].in_use) { idx = i; break; }
+    }
+    if (idx < 0) {
+        if (sync_records_reserve(state, state->record_count + 1) != 0) return NULL;
+        idx = state->record_count++;
+    }
+    sync_slave_record_t *slot = &state->records[idx];
     memset(slot, 0, sizeof(*slot));
     slot->in_use = 1;
     strncpy(slot->id, id, sizeof(slot->id) - 1);
@@ -278,6 +362,11 @@ static sync_slave_record_t *sync_master_find_record(sync_master_state_t *state,
     slot->slot_index = -1;
     slot->last_reported_slot_index = -1;
     slot->last_ack_generation = 0;
+    if ((unsigned)state->record_count * 2u > state->id_idx_cap) {
+        sync_idx_rebuild(state);
+    } else {
+        sync_idx_insert(state, idx);
+    }
     return slot;
 }
 
@@ -286,6 +375,7 @@ static int sync_master_mark_slot_generation(sync_master_state_t *state, int slot
     int gen = state->slot_generation[slot_index] + 1;
     if (gen < 1) gen = 1;
     state->slot_generation[slot_index] = gen;
+    pthread_cond_broadcast(&state->change_cond); // wake /sync/wait long-polls
     return gen;
 }
 
@@ -328,17 +418,23 @@ static int sync_master_delete_record_locked(sync_master_state_t *state,
         sync_master_release_slot_locked(state, rec->slot_index);
     }
     memset(rec, 0, sizeof(*rec));
+    sync_idx_rebuild(state); // drop the tombstone from the probe chains
     return 1;
 }
 
 static void sync_master_prune_locked(sync_master_state_t *state,
                                      const config_t *cfg) {
     if (!state) return;
+    // Called on every master request; the sweep itself only needs to run on
+    // the retention timescale, so gate it to once a second.
+    long long now = now_ms();
+    if (state->last_prune_ms && now - state->last_prune_ms < 1000) return;
+    state->last_prune_ms = now;
+
     long long retention_ms = 0;
     if (cfg && cfg->sync_slot_retention_s > 0) {
         retention_ms = (long long)cfg->sync_slot_retention_s * 1000LL;
     }
-    long long now = retention_ms > 0 ? now_ms() : 0;
     long long cutoff = retention_ms > 0 ? now - retention_ms : 0;
 
     for (int slot = 0; slot < SYNC_MAX_SLOTS; slot++) {
@@ -359,15 +455,18 @@ static void sync_master_prune_locked(sync_master_state_t *state,
 
     if (retention_ms <= 0) return;
 
-    for (int i = 0; i < SYNC_MAX_SLAVES; i++) {
+    int removed = 0;
+    for (int i = 0; i < state->record_count; i++) {
         sync_slave_record_t *rec = &state->records[i];
         if (!rec->in_use) continue;
         if (rec->slot_index >= 0) continue;
         if (rec->last_seen_ms <= 0) continue;
         if (rec->last_seen_ms < cutoff) {
             memset(rec, 0, sizeof(*rec));
+            removed++;
         }
     }
+    if (removed) sync_idx_rebuild(state);
 }
 
 static void sync_master_force_slot_replay_locked(sync_master_state_t *state,
@@ -588,6 +687,8 @@ static JSON_Value *sync_master_build_slot_commands(const config_t *cfg,
     return arr_v;
 }
 
+#endif /* AUTOD_NO_SYNC_MASTER */
+
 static int parse_http_url(const char *url, http_url_t *out) {
     if (!url || !out) return -1;
     memset(out, 0, sizeof(*out));
@@ -668,6 +769,7 @@ static int parse_sync_reference(const char *ref, char *id_out, size_t id_sz,
     return 0;
 }
 
+#ifndef AUTOD_NO_SYNC_MASTER
 static int sync_normalize_master_reference(const char *value, char *out, size_t out_sz) {
     if (!value || !*value || !out || out_sz == 0) return -1;
 
@@ -717,8 +819,8 @@ static int sync_normalize_master_reference(const char *value, char *out, size_t
         candidate_count = 1;
     }
 
-    scan_node_t nodes[SCAN_MAX_NODES];
-    int count = scan_get_nodes(nodes, SCAN_MAX_NODES);
+    int count = 0;
+    scan_node_t *nodes = scan_copy_nodes(&count);
     const char *matched_id = NULL;
     for (int i = 0; i < count && !matched_id; i++) {
         scan_node_t *node = &nodes[i];
@@ -732,13 +834,15 @@ static int sync_normalize_master_reference(const char *value, char *out, size_t
         }
     }
 
-    if (!matched_id) return -1;
+    if (!matched_id) { free(nodes); return -1; }
 
     const char *path = parsed.path[0] ? parsed.path : "/sync/register";
     int w = snprintf(out, out_sz, "sync://%s%s", matched_id, path);
+    free(nodes);
     if (w < 0 || (size_t)w >= out_sz) return -1;
     return 0;
 }
+#endif /* AUTOD_NO_SYNC_MASTER */
 
 static int http_post_json_simple(const http_url_t *url, const char *body,
                                  char **resp_body, size_t *resp_len,
@@ -747,127 +851,25 @@ static int http_post_json_simple(const http_url_t *url, const char *body,
     if (resp_body) *resp_body = NULL;
     if (resp_len) *resp_len = 0;
 
-    char portbuf[16];
-    snprintf(portbuf, sizeof(portbuf), "%d", url->port > 0 ? url->port : 80);
-
-    struct addrinfo hints; memset(&hints, 0, sizeof(hints));
-    hints.ai_family = AF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_protocol = IPPROTO_TCP;
-
-    struct addrinfo *res = NULL;
-    int gai = getaddrinfo(url->host, portbuf, &hints, &res);
-    if (gai != 0) return -1;
-
-    int fd = -1;
-    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
-        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
-        if (fd < 0) continue;
-        if (timeout_ms > 0) {
-            struct timeval tv;
-            tv.tv_sec = timeout_ms / 1000;
-            tv.tv_usec = (timeout_ms % 1000) * 1000;
-            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
-            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
-        }
-        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
-            break;
-        }
-        close(fd);
-        fd = -1;
-    }
-    freeaddrinfo(res);
-    if (fd < 0) return -1;
-
-    size_t body_len = body ? strlen(body) : 0;
-    char header[512];
-    int header_len = snprintf(header, sizeof(header),
-                              "POST %s HTTP/1.1\r\n"
-                              "Host: %s\r\n"
-                              "Content-Type: application/json\r\n"
-                              "Content-Length: %zu\r\n"
-                              "Connection: close\r\n\r\n",
-                              url->path[0] ? url->path : "/",
-                              url->host,
-                              body_len);
-    if (header_len <= 0 || header_len >= (int)sizeof(header)) {
-        close(fd);
+    // Registrations hit the same master every few seconds: reuse its
+    // keep-alive connection instead of paying the handshake each time.
+    http_pool_resp_t resp;
+    if (http_pool_request(url->host, url->port > 0 ? url->port : 80,
+                          "POST", url->path[0] ? url->path : "/",
+                          "Content-Type: application/json\r\n",
+                          body, body ? strlen(body) : 0,
+                          timeout_ms > 0 ? timeout_ms : 5000, 65536,
+                          &resp, NULL) != 0) {
         return -1;
     }
 
-    ssize_t sent = send(fd, header, (size_t)header_len, 0);
-    if (sent != header_len) {
-        close(fd);
-        return -1;
+    int status = resp.status;
+    if (resp_body) {
+        *resp_body = resp.body;
+        resp.body = NULL;
     }
-    if (body_len > 0) {
-        ssize_t bsent = send(fd, body, body_len, 0);
-        if (bsent != (ssize_t)body_len) {
-            close(fd);
-            return -1;
-        }
-    }
-
-    char *buffer = NULL;
-    size_t total = 0;
-    const size_t max_resp = 65536;
-    char tmpbuf[1024];
-    for (;;) {
-        ssize_t r = recv(fd, tmpbuf, sizeof(tmpbuf), 0);
-        if (r < 0) {
-            if (errno == EINTR) continue;
-            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
-            free(buffer);
-            close(fd);
-            return -1;
-        }
-        if (r == 0) break;
-        if (total + (size_t)r > max_resp) {
-            free(buffer);
-            close(fd);
-            return -1;
-        }
-        char *nbuf = (char *)realloc(buffer, total + (size_t)r + 1);
-        if (!nbuf) {
-            free(buffer);
-            close(fd);
-            return -1;
-        }
-        buffer = nbuf;
-        memcpy(buffer + total, tmpbuf, (size_t)r);
-        total += (size_t)r;
-        buffer[total] = '\0';
-    }
-    close(fd);
-
-    if (!buffer) return -1;
-
-    char *line_end = strstr(buffer, "\r\n");
-    if (!line_end) { free(buffer); return -1; }
-    int status = 0;
-    sscanf(buffer, "HTTP/%*s %d", &status);
-
-    char *body_start = strstr(buffer, "\r\n\r\n");
-    if (!body_start) body_start = line_end;
-    if (body_start) {
-        body_start += 4;
-    } else {
-        body_start = buffer;
-    }
-    size_t body_size = total - (size_t)(body_start - buffer);
-    char *body_copy = (char *)malloc(body_size + 1);
-    if (!body_copy) {
-        free(buffer);
-        return -1;
-    }
-    memcpy(body_copy, body_start, body_size);
-    body_copy[body_size] = '\0';
-
-    if (resp_body) *resp_body = body_copy;
-    else free(body_copy);
-    if (resp_len) *resp_len = body_size;
-
-    free(buffer);
+    if (resp_len) *resp_len = resp.body_len;
+    http_pool_resp_free(&resp);
     return status;
 }
 
@@ -890,8 +892,8 @@ static int sync_slave_resolve_target(app_t *app, const config_t *cfg,
         return -1;
     }
 
-    scan_node_t nodes[SCAN_MAX_NODES];
-    int count = scan_get_nodes(nodes, SCAN_MAX_NODES);
+    int count = 0;
+    scan_node_t *nodes = scan_copy_nodes(&count);
     for (int i = 0; i < count; i++) {
         scan_node_t *node = &nodes[i];
         if (!node->sync_id[0]) continue;
@@ -911,9 +913,11 @@ static int sync_slave_resolve_target(app_t *app, const config_t *cfg,
             strncpy(resolved_id, sync_id, resolved_sz - 1);
             resolved_id[resolved_sz - 1] = '\0';
         }
+        free(nodes);
         return 0;
     }
 
+    free(nodes);
     (void)app;
     return -1;
 }
@@ -1057,7 +1061,9 @@ static void *sync_slave_thread_main(void *arg) {
 
         char *resp_body = NULL;
         int timeout_ms = cfg.sync_register_interval_s > 0 ? cfg.sync_register_interval_s * 1000 : 5000;
+        long long reg_t0 = metrics_now_us();
         int http_status = http_post_json_simple(&target, body, &resp_body, NULL, timeout_ms);
+        metrics_record_sync_register(metrics_now_us() - reg_t0);
         json_free_serialized_string(body);
 
         if (http_status != 200 || !resp_body) {
@@ -1144,9 +1150,70 @@ static void *sync_slave_thread_main(void *arg) {
         }
         json_value_free(resp);
 
+        /* Between heartbeats, park a long-poll on the master's /sync/wait so
+           slot reassignments apply immediately instead of at the next
+           register. Masters without the endpoint (or with all wait slots
+           taken) drop us back to the plain 1 s sleep loop for this round. */
         sleep_seconds = cfg.sync_register_interval_s > 0 ? cfg.sync_register_interval_s : 15;
-        for (int i = 0; i < sleep_seconds && !app->slave.stop && !g_stop; i++) {
-            sleep(1);
+        http_url_t wait_target = target;
+        {
+            const char *rpath = target.path[0] ? target.path : "/sync/register";
+            size_t rlen = strlen(rpath);
+            const char *suffix = "/register";
+            size_t slen = strlen(suffix);
+            if (rlen >= slen && strcmp(rpath + rlen - slen, suffix) == 0) {
+                snprintf(wait_target.path, sizeof(wait_target.path), "%.*s/wait",
+                         (int)(rlen - slen), rpath);
+            } else {
+                snprintf(wait_target.path, sizeof(wait_target.path), "/sync/wait");
+            }
+        }
+        long long wait_deadline = now_ms() + (long long)sleep_seconds * 1000;
+        int wait_supported = 1;
+        while (!app->slave.stop && !g_stop) {
+            long long left = wait_deadline - now_ms();
+            if (left <= 0) break;
+            if (!wait_supported) { sleep(1); continue; }
+            int chunk_ms = left > 10000 ? 10000 : (int)left;
+            if (chunk_ms < 250) break;
+
+            JSON_Value *wreq = json_value_init_object();
+            JSON_Object *wo = json_object(wreq);
+            json_object_set_string(wo, "id", cfg.sync_id);
+            json_object_set_number(wo, "slot", sync_slave_get_current_slot(&app->slave));
+            json_object_set_number(wo, "ack_generation",
+                                   sync_slave_get_applied_generation(&app->slave));
+            json_object_set_number(wo, "timeout_ms", chunk_ms);
+            char *wbody = json_serialize_to_string(wreq);
+            json_value_free(wreq);
+            if (!wbody) { sleep(1); continue; }
+
+            char *wresp = NULL;
+            int wstatus = http_post_json_simple(&wait_target, wbody, &wresp, NULL,
+                                                chunk_ms + 2000);
+            json_free_serialized_string(wbody);
+            if (wstatus == 404 || wstatus == 405) {
+                // pre-/sync/wait master: periodic register only
+                wait_supported = 0;
+                if (wresp) free(wresp);
+                continue;
+            }
+            if (wstatus != 200 || !wresp) {
+                if (wresp) free(wresp);
+                sleep(1);
+                continue;
+            }
+            int changed = 0, backoff = 0;
+            JSON_Value *wv = json_parse_string(wresp);
+            free(wresp);
+            if (wv) {
+                JSON_Object *ro2 = json_object(wv);
+                changed = (int)json_object_get_number(ro2, "changed");
+                backoff = (int)json_object_get_number(ro2, "backoff");
+                json_value_free(wv);
+            }
+            if (changed) break; // re-register right away to fetch commands
+            if (backoff) { wait_supported = 0; continue; }
         }
     }
 
@@ -1156,6 +1223,8 @@ static void *sync_slave_thread_main(void *arg) {
     return NULL;
 }
 
+#ifndef AUTOD_NO_SYNC_MASTER
+
 static int h_sync_register(struct mg_connection *c, void *ud) {
     app_t *app = (app_t *)ud;
     config_t cfg; app_config_snapshot(app, &cfg);
@@ -1392,10 +1461,29 @@ static int h_sync_slaves(struct mg_connection *c, void *ud) {
     JSON_Value *arr_v = json_value_init_array();
     JSON_Array *arr = json_array(arr_v);
 
+    /* Snapshot the table under the lock and build the JSON outside it, so a
+       slow status poll cannot convoy concurrent registrations. */
     pthread_mutex_lock(&app->master.lock);
     sync_master_prune_locked(&app->master, &cfg);
-    for (int i = 0; i < SYNC_MAX_SLAVES; i++) {
-        sync_slave_record_t *rec = &app->master.records[i];
+    int snap_count = app->master.record_count;
+    sync_slave_record_t *snap = NULL;
+    if (snap_count > 0) {
+        snap = malloc((size_t)snap_count * sizeof(*snap));
+        if (snap) {
+            memcpy(snap, app->master.records,
+                   (size_t)snap_count * sizeof(*snap));
+        } else {
+            snap_count = 0;
+        }
+    }
+    int snap_generation[SYNC_MAX_SLOTS];
+    char snap_assignees[SYNC_MAX_SLOTS][64];
+    memcpy(snap_generation, app->master.slot_generation, sizeof(snap_generation));
+    memcpy(snap_assignees, app->master.slot_assignees, sizeof(snap_assignees));
+    pthread_mutex_unlock(&app->master.lock);
+
+    for (int i = 0; i < snap_count; i++) {
+        sync_slave_record_t *rec = &snap[i];
         if (!rec->in_use) continue;
         JSON_Value *item = json_value_init_object();
         JSON_Object *io = json_object(item);
@@ -1411,7 +1499,7 @@ static int h_sync_slaves(struct mg_connection *c, void *ud) {
         if (rec->slot_index >= 0 && rec->slot_index < SYNC_MAX_SLOTS) {
             json_object_set_number(io, "slot", rec->slot_index + 1);
             json_object_set_number(io, "slot_generation",
-                                   app->master.slot_generation[rec->slot_index]);
+                                   snap_generation[rec->slot_index]);
             if (cfg.sync_slots[rec->slot_index].name[0]) {
                 json_object_set_string(io, "slot_label",
                                        cfg.sync_slots[rec->slot_index].name);
@@ -1437,13 +1525,12 @@ static int h_sync_slaves(struct mg_connection *c, void *ud) {
             json_object_set_string(so, "prefer_id",
                                    cfg.sync_slots[slot].prefer_id);
         }
-        if (app->master.slot_assignees[slot][0]) {
-            json_object_set_string(so, "assigned_id",
-                                   app->master.slot_assignees[slot]);
+        if (snap_assignees[slot][0]) {
+            json_object_set_string(so, "assigned_id", snap_assignees[slot]);
         }
         json_array_append_value(slots_arr, slot_v);
     }
-    pthread_mutex_unlock(&app->master.lock);
+    free(snap);
 
     json_object_set_value(ro, "slaves", arr_v);
     json_object_set_value(ro, "slots", slots_v);
@@ -1990,6 +2077,9 @@ static int h_sync_bind(struct mg_connection *c, void *ud) {
     json_value_free(root);
     return 1;
 }
+
+#endif /* AUTOD_NO_SYNC_MASTER */
+
 void sync_append_capabilities(const config_t *cfg, JSON_Array *caps_arr) {
     if (!cfg || !caps_arr) return;
     if (!cfg->sync_role[0]) return;
@@ -2030,12 +2120,115 @@ JSON_Value *sync_build_status_json(const config_t *cfg, sync_slave_state_t *stat
     return sync_v;
 }
 
+// Long-poll companion to /sync/register: the request parks until the caller's
+// slot assignment or slot generation moves past what it reported, then returns
+// a tiny {"changed":1} so the slave re-registers immediately. Changes reach
+// the fleet in tens of milliseconds while the periodic register stays the
+// heartbeat and the only path that carries commands.
+#ifndef AUTOD_NO_SYNC_MASTER
+
+static int h_sync_wait(struct mg_connection *c, void *ud) {
+    app_t *app = (app_t *)ud;
+    config_t cfg; app_config_snapshot(app, &cfg);
+    if (strcasecmp(cfg.sync_role, "master") != 0) {
+        send_plain(c, 404, "not_found", 1);
+        return 1;
+    }
+
+    const struct mg_request_info *ri = mg_get_request_info(c);
+    if (!ri || strcmp(ri->request_method, "POST") != 0) {
+        send_plain(c, 405, "method_not_allowed", 1);
+        return 1;
+    }
+
+    upload_t u = {0};
+    if (read_body(c, &u) != 0) {
+        if (u.body) free(u.body);
+        send_plain(c, 400, "body_read_failed", 1);
+        return 1;
+    }
+    JSON_Value *root = json_parse_string(u.body ? u.body : "{}");
+    free(u.body);
+    if (!root) {
+        send_plain(c, 400, "bad_json", 1);
+        return 1;
+    }
+    JSON_Object *obj = json_object(root);
+    const char *id = json_object_get_string(obj, "id");
+    if (!id || !*id) {
+        json_value_free(root);
+        send_plain(c, 400, "missing_id", 1);
+        return 1;
+    }
+    int ack_generation = (int)json_object_get_number(obj, "ack_generation");
+    int reported_slot = (int)json_object_get_number(obj, "slot");
+    int timeout_ms = (int)json_object_get_number(obj, "timeout_ms");
+    if (timeout_ms <= 0) timeout_ms = 20000;
+    if (timeout_ms > 30000) timeout_ms = 30000;
+
+    // Each parked poll pins a CivetWeb worker; keep a couple free so the
+    // regular endpoints stay responsive on busy masters.
+    int max_waiters = cfg.http_threads - 2;
+    if (max_waiters < 1) max_waiters = 1;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec  += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    int changed = 0, backoff = 0, generation = 0, slot_number = 0;
+
+    pthread_mutex_lock(&app->master.lock);
+    if (app->master.wait_count >= max_waiters) {
+        backoff = 1;
+    } else {
+        app->master.wait_count++;
+        for (;;) {
+            sync_slave_record_t *rec = sync_master_find_record(&app->master, id, 0);
+            if (!rec) { changed = 1; break; } // pruned or unknown: re-register
+            slot_number = rec->slot_index >= 0 ? rec->slot_index + 1 : 0;
+            generation = rec->slot_index >= 0
+                             ? app->master.slot_generation[rec->slot_index]
+                             : 0;
+            if (slot_number != reported_slot) { changed = 1; break; }
+            if (generation > ack_generation) { changed = 1; break; }
+            int rc = pthread_cond_timedwait(&app->master.change_cond,
+                                            &app->master.lock, &deadline);
+            if (rc == ETIMEDOUT) break;
+        }
+        app->master.wait_count--;
+    }
+    pthread_mutex_unlock(&app->master.lock);
+    json_value_free(root);
+
+    JSON_Value *v = json_value_init_object();
+    JSON_Object *o = json_object(v);
+    json_object_set_number(o, "changed", changed);
+    if (backoff) json_object_set_number(o, "backoff", 1);
+    json_object_set_number(o, "generation", generation);
+    json_object_set_number(o, "slot", slot_number);
+    send_json(c, v, 200, 1);
+    json_value_free(v);
+    return 1;
+}
+
+#endif /* AUTOD_NO_SYNC_MASTER */
+
 void sync_register_http_handlers(struct mg_context *ctx, app_t *app) {
     if (!ctx) return;
+#ifndef AUTOD_NO_SYNC_MASTER
     mg_set_request_handler(ctx, "/sync/register", h_sync_register, app);
+    mg_set_request_handler(ctx, "/sync/wait", h_sync_wait, app);
     mg_set_request_handler(ctx, "/sync/slaves", h_sync_slaves, app);
     mg_set_request_handler(ctx, "/sync/push", h_sync_push, app);
     mg_set_request_handler(ctx, "/sync/bind", h_sync_bind, app);
+#else
+    (void)app;
+#endif
 }
 
 int sync_slave_start_thread(app_t *app) {
@@ -34,10 +34,22 @@ typedef struct {
 
 typedef struct {
     pthread_mutex_t lock;
-    sync_slave_record_t records[SYNC_MAX_SLAVES];
+    // Growable slave table with a hash index on id (records freed by pruning
+    // are reused via in_use). SYNC_MAX_SLAVES is only the initial capacity.
+    sync_slave_record_t *records;
+    int record_count;   // used length of the array, including free holes
+    int record_cap;
+    int *id_idx;        // hash slots: record index + 1, 0 = empty
+    unsigned id_idx_cap; // power of two
+    long long last_prune_ms;
     int slot_generation[SYNC_MAX_SLOTS];
     char slot_assignees[SYNC_MAX_SLOTS][64];
     unsigned char slot_manual_overrides[SYNC_MAX_SLOTS];
+    // Long-poll support (/sync/wait): broadcast on any slot change so parked
+    // slaves pick up reassignments immediately instead of at the next
+    // heartbeat. wait_count caps concurrent pollers to keep HTTP workers free.
+    pthread_cond_t change_cond;
+    int wait_count;
 } sync_master_state_t;
 
 typedef struct {
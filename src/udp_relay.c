@@ -16,7 +16,7 @@
  *      * For gzip UI: adds Content-Encoding: gzip
  *
  * Build:
- *   gcc -O2 -Wall -Wextra -std=gnu11 -o udp_relay udp_relay.c
+ *   gcc -O2 -Wall -Wextra -std=gnu11 -pthread -o udp_relay udp_relay.c
  *
  * Runtime:
  *   ./udp_relay [--ui /path/to/ui.html[.gz]]
@@ -31,6 +31,9 @@
  *   sndbuf=1048576
  *   bufsz=9000
  *   tos=0
+ *   busy_poll_us=0        # SO_BUSY_POLL on relay sockets (latency mode)
+ *   spin_us=0             # keep epoll spinning this long after the last rx
+ *   workers=0             # rx worker threads (SO_REUSEPORT per relay port); 0 = single loop
  *   bind=5700:5600
  *   bind=5701
  *   bind=5702
@@ -50,6 +53,8 @@
 #include <fcntl.h>
 #include <inttypes.h>
 #include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -63,6 +68,7 @@
 #include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <time.h>
 #include <unistd.h>
@@ -82,6 +88,8 @@
 #define MAX_UARTS       4
 #define MAX_LINE        1024
 #define MAX_EVENTS      128
+#define RX_BATCH        32   /* datagrams drained per recvmmsg call */
+#define MAX_WORKERS     8    /* rx worker threads (workers= in INI) */
 #define MAX_HTTP_CONN   64
 #define HTTP_BUF_MAX    65536
 #define STATUS_CAP      8192
@@ -90,6 +98,8 @@
 
 #define UART_TX_BUF_DEFAULT 4096
 #define UART_RX_BUF_DEFAULT 4096
+#define UART_TXQ_CAP    32   /* packets queued per UART under backpressure */
+#define UART_TX_IOV     8    /* packets coalesced per writev */
 
 /* Counter roll-over thresholds: when any hits these, all are halved */
 #define PKTS_ROLLOVER_LIMIT  ((uint64_t)1000000000ULL)  /* 1e9 pkts */
@@ -148,77 +158,6 @@ static int uart_token_parse(const char *token){
     return (int)idx;
 }
 
-/* ------------------- small ring buffer ---------------------- */
-
-typedef struct {
-    uint8_t *buf;
-    size_t   cap;
-    size_t   head;
-    size_t   tail;
-    size_t   len;
-} ringbuf_t;
-
-static int ring_init(ringbuf_t *r, size_t cap){
-    r->buf = NULL;
-    r->cap = r->head = r->tail = r->len = 0;
-    if (!cap) return 0;
-    r->buf = (uint8_t*)malloc(cap);
-    if (!r->buf){ errno = ENOMEM; return -1; }
-    r->cap = cap;
-    return 0;
-}
-
-static void ring_free(ringbuf_t *r){
-    free(r->buf);
-    r->buf = NULL;
-    r->cap = r->head = r->tail = r->len = 0;
-}
-
-static size_t ring_space(const ringbuf_t *r){
-    if (r->cap < r->len) return 0;
-    return r->cap - r->len;
-}
-
-static size_t ring_write(ringbuf_t *r, const uint8_t *src, size_t n){
-    if (!r->cap || !n) return 0;
-    size_t w = n;
-    if (w > ring_space(r)) w = ring_space(r);
-    size_t first = w > (r->cap - r->head) ? (r->cap - r->head) : w;
-    if (first) memcpy(r->buf + r->head, src, first);
-    size_t second = w - first;
-    if (second) memcpy(r->buf, src + first, second);
-    r->head = (r->head + w) % r->cap;
-    r->len += w;
-    return w;
-}
-
-static size_t ring_peek(const ringbuf_t *r, const uint8_t **p1, size_t *l1,
-                        const uint8_t **p2, size_t *l2){
-    if (!r->len){
-        if (p1) *p1 = NULL;
-        if (l1) *l1 = 0;
-        if (p2) *p2 = NULL;
-        if (l2) *l2 = 0;
-        return 0;
-    }
-    size_t first = r->len > (r->cap - r->tail) ? (r->cap - r->tail) : r->len;
-    if (p1) *p1 = r->buf + r->tail;
-    if (l1) *l1 = first;
-    if (p2) *p2 = NULL;
-    if (l2) *l2 = 0;
-    if (r->len > first){
-        if (p2) *p2 = r->buf;
-        if (l2) *l2 = r->len - first;
-    }
-    return r->len;
-}
-
-static void ring_consume(ringbuf_t *r, size_t n){
-    if (n > r->len) n = r->len;
-    r->tail = (r->tail + n) % r->cap;
-    r->len -= n;
-}
-
 /* ------------------- UART helpers --------------------------- */
 
 static speed_t baud_to_speed(int baud){
@@ -303,7 +242,9 @@ static void relay_id_format(const struct relay *r, char *out, size_t len){
     }
 }
 
+struct pkt;
 static void maybe_rollover_relay(struct relay *r);
+static void relay_forward_datagram(struct relay *r, int fd, struct pkt *p, size_t m);
 
 struct uart_cfg {
     char device[128];
@@ -323,6 +264,9 @@ struct config {
     int  rcvbuf, sndbuf; /* 0 = skip */
     int  bufsz;          /* default 9000 */
     int  tos;            /* 0 = skip */
+    int  busy_poll_us;   /* SO_BUSY_POLL microseconds, 0 = off */
+    int  spin_us;        /* spin window after last rx before epoll sleeps, 0 = off */
+    int  workers;        /* rx worker threads, 0 = everything on the main loop */
     int  bind_count;
     char bind_lines[MAX_BINDS][MAX_LINE];
     struct uart_cfg uart[MAX_UARTS];
@@ -332,13 +276,80 @@ static struct config G;                    /* current config */
 static struct relay REL[MAX_RELAYS];       /* active relays */
 static int REL_N = 0;
 
+/* Guards dest-list mutations vs. the per-datagram snapshot in
+   relay_forward_datagram. Only contended when workers > 0; uncontended
+   lock/unlock on the single-loop path is noise next to the syscalls. */
+static pthread_mutex_t REL_LOCK = PTHREAD_MUTEX_INITIALIZER;
+/* Serializes UART tx (queue + write) between rx workers and the main loop. */
+static pthread_mutex_t UART_IO_LOCK = PTHREAD_MUTEX_INITIALIZER;
+
+/* ---- refcounted packet pool ----
+   Every receive slot (main loop and workers) points into a pool packet, so
+   a datagram that has to wait on a UART is retained by reference instead of
+   being copied into a byte ring: the slot is detached and re-pointed at a
+   fresh pool packet, and the buffer recycles itself when the last consumer
+   unrefs it. Sized so that all rx slots plus all full UART queues can hold
+   a packet at once, which makes pkt_get() effectively infallible. */
+struct pkt {
+    uint8_t *data;   /* POOL_BUFSZ bytes */
+    int      refs;   /* atomic; 0 = on the free stack */
+};
+
+static struct pkt  *POOL = NULL;
+static struct pkt **POOL_FREE = NULL;   /* free stack */
+static int POOL_N = 0;
+static int POOL_FREE_N = 0;
+static int POOL_BUFSZ = 0;
+static pthread_mutex_t POOL_LOCK = PTHREAD_MUTEX_INITIALIZER;
+
+static struct pkt *pkt_get(void){
+    struct pkt *p = NULL;
+    pthread_mutex_lock(&POOL_LOCK);
+    if (POOL_FREE_N > 0) p = POOL_FREE[--POOL_FREE_N];
+    pthread_mutex_unlock(&POOL_LOCK);
+    if (p) p->refs = 1;
+    return p;
+}
+
+static void pkt_ref(struct pkt *p){
+    __sync_fetch_and_add(&p->refs, 1);
+}
+
+static void pkt_unref(struct pkt *p){
+    if (__sync_sub_and_fetch(&p->refs, 1) == 0){
+        pthread_mutex_lock(&POOL_LOCK);
+        POOL_FREE[POOL_FREE_N++] = p;
+        pthread_mutex_unlock(&POOL_LOCK);
+    }
+}
+
+/* After forwarding: if a UART queue retained the packet, hand the rx slot's
+   reference over and draw a fresh buffer for the slot. Returns the packet
+   the slot should keep. Pool sizing makes exhaustion unreachable, but if it
+   ever happens the slot keeps sharing the buffer — worst case a clobbered
+   queued frame, never a crash. */
+static struct pkt *pkt_detach_if_shared(struct pkt *p){
+    if (__sync_fetch_and_add(&p->refs, 0) <= 1) return p;
+    struct pkt *fresh = pkt_get();
+    if (!fresh) return p;
+    pkt_unref(p);
+    return fresh;
+}
+
 struct uart_runtime {
     int enabled;
     int index;
     char token[16];
     int fd;          /* UART file descriptor */
     int udp_fd;      /* UDP socket for UART->UDP forwarding */
-    ringbuf_t out;   /* pending bytes to write to UART */
+    /* pending UDP->UART packets: refcounted pool references, no byte copy.
+       txq_off is how much of the front packet has already been written;
+       txq_bytes tracks queued bytes against cfg.tx_buf. */
+    struct { struct pkt *p; size_t len; } txq[UART_TXQ_CAP];
+    int    txq_head;
+    int    txq_count;
+    size_t txq_off;
+    size_t txq_bytes;
     uint8_t *rx_buf; /* buffer for UART reads */
     size_t   rx_buf_cap;
     struct relay *relay;
@@ -370,6 +381,7 @@ static volatile sig_atomic_t WANT_RELOAD = 0;
 static volatile sig_atomic_t WANT_EXIT   = 0;
 
 static int EPFD = -1;                      /* epoll fd */
+static uint64_t LAST_RX_NS = 0;            /* spin-window anchor (spin_us) */
 static int HTTP_LFD = -1;                  /* http listen fd */
 
 /* ---- Optional UI asset loaded from file (via --ui) ---- */
@@ -377,8 +389,26 @@ static char   *UI_BUF = NULL;
 static size_t  UI_LEN = 0;
 static int     UI_IS_GZIP = 0;
 
-/* ---- UDP receive buffer (global so sync reload can resize) ---- */
-static char   *UDP_BUF = NULL;
+/* ---- UDP receive slots (global so sync reload can resize).
+   RX_PKT holds RX_BATCH pool packets; RX_MSGS/RX_IOV are the preallocated
+   recvmmsg batch pointing into them. ---- */
+static struct pkt    *RX_PKT[RX_BATCH];
+static struct mmsghdr RX_MSGS[RX_BATCH];
+static struct iovec   RX_IOV[RX_BATCH];
+static char           RX_CTRL[RX_BATCH][CMSG_SPACE(sizeof(uint32_t))];
+
+static void udp_rx_setup(void){
+    memset(RX_MSGS, 0, sizeof(RX_MSGS));
+    for (int i=0;i<RX_BATCH;i++){
+        if (!RX_PKT[i]) RX_PKT[i] = pkt_get();
+        RX_IOV[i].iov_base = RX_PKT[i] ? RX_PKT[i]->data : NULL;
+        RX_IOV[i].iov_len  = (size_t)POOL_BUFSZ;
+        RX_MSGS[i].msg_hdr.msg_iov = &RX_IOV[i];
+        RX_MSGS[i].msg_hdr.msg_iovlen = 1;
+        RX_MSGS[i].msg_hdr.msg_control = RX_CTRL[i];
+        RX_MSGS[i].msg_hdr.msg_controllen = sizeof(RX_CTRL[i]);
+    }
+}
 
 /* Forward decl */
 static int reload_from_disk(void);
@@ -391,6 +421,7 @@ static void cfg_defaults(struct config *c){
     c->control_port = 9000;
     snprintf(c->src_ip, sizeof(c->src_ip), "0.0.0.0");
     c->rcvbuf=0; c->sndbuf=0; c->bufsz=9000; c->tos=0;
+    c->busy_poll_us=0; c->spin_us=0; c->workers=0;
     c->bind_count=0;
     for (int i=0;i<MAX_UARTS;i++){
         struct uart_cfg *u = &c->uart[i];
@@ -454,6 +485,12 @@ static int load_ini_text(const char *text, struct config *c){
             int v=parse_int_bounded(val,512,64*1024); if(v>0) c->bufsz=v;
         } else if(!strcmp(key,"tos")){
             int v=parse_int_bounded(val,0,255); if(v>=0) c->tos=v;
+        } else if(!strcmp(key,"busy_poll_us")){
+            int v=parse_int_bounded(val,0,1000000); if(v>=0) c->busy_poll_us=v;
+        } else if(!strcmp(key,"spin_us")){
+            int v=parse_int_bounded(val,0,1000000); if(v>=0) c->spin_us=v;
+        } else if(!strcmp(key,"workers")){
+            int v=parse_int_bounded(val,0,MAX_WORKERS); if(v>=0) c->workers=v;
         } else if(!strcmp(key,"bind")){
             if(c->bind_count<MAX_BINDS){
                 snprintf(c->bind_lines[c->bind_count++],MAX_LINE,"%s",val);
@@ -701,23 +738,55 @@ static int uart_open_udp_socket(const char *ip, int port){
 static void uart_update_epoll_interest(struct uart_runtime *u){
     if (!u || u->fd < 0 || EPFD < 0) return;
     uint32_t events = EPOLLIN;
-    if (u->out.len > 0) events |= EPOLLOUT;
+    if (u->txq_count > 0) events |= EPOLLOUT;
     struct epoll_event ev={.events=events, .data.fd=u->fd};
     if (epoll_ctl(EPFD, EPOLL_CTL_MOD, u->fd, &ev)<0){
         /* best effort; ignore */
     }
 }
 
+static void uart_txq_clear(struct uart_runtime *u){
+    if (!u) return;
+    while (u->txq_count > 0){
+        pkt_unref(u->txq[u->txq_head].p);
+        u->txq[u->txq_head].p = NULL;
+        u->txq_head = (u->txq_head + 1) % UART_TXQ_CAP;
+        u->txq_count--;
+    }
+    u->txq_head = 0;
+    u->txq_off = 0;
+    u->txq_bytes = 0;
+}
+
 static void uart_flush_output(struct uart_runtime *u){
     if (!u || u->fd < 0) return;
-    while (u->out.len > 0){
-        const uint8_t *p1=NULL,*p2=NULL;
-        size_t l1=0,l2=0;
-        ring_peek(&u->out, &p1, &l1, &p2, &l2);
-        if (!l1) break;
-        ssize_t w = write(u->fd, p1, l1);
+    while (u->txq_count > 0){
+        struct iovec iov[UART_TX_IOV];
+        int n = 0;
+        for (int i = 0; i < u->txq_count && n < UART_TX_IOV; i++){
+            int s = (u->txq_head + i) % UART_TXQ_CAP;
+            size_t off = (i == 0) ? u->txq_off : 0;
+            iov[n].iov_base = u->txq[s].p->data + off;
+            iov[n].iov_len  = u->txq[s].len - off;
+            n++;
+        }
+        ssize_t w = writev(u->fd, iov, n);
         if (w > 0){
-            ring_consume(&u->out, (size_t)w);
+            u->txq_bytes -= (size_t)w;
+            while (w > 0 && u->txq_count > 0){
+                size_t front_rem = u->txq[u->txq_head].len - u->txq_off;
+                if ((size_t)w >= front_rem){
+                    w -= (ssize_t)front_rem;
+                    pkt_unref(u->txq[u->txq_head].p);
+                    u->txq[u->txq_head].p = NULL;
+                    u->txq_head = (u->txq_head + 1) % UART_TXQ_CAP;
+                    u->txq_count--;
+                    u->txq_off = 0;
+                } else {
+                    u->txq_off += (size_t)w;
+                    w = 0;
+                }
+            }
             continue;
         } else if (w < 0 && errno == EINTR){
             continue;
@@ -725,44 +794,54 @@ static void uart_flush_output(struct uart_runtime *u){
             break;
         } else {
             u->send_errs++;
-            size_t drop = u->out.len;
-            ring_consume(&u->out, drop);
+            uart_txq_clear(u);
             break;
         }
     }
 }
 
-static int uart_send_bytes(struct uart_runtime *u, const uint8_t *data, size_t len){
-    if (!u || u->fd < 0 || !data || !len) return -1;
+static int uart_send_pkt(struct uart_runtime *u, struct pkt *p, size_t len){
+    if (!u || u->fd < 0 || !p || !len) return -1;
 
     uart_flush_output(u);
 
+    /* with nothing queued ahead, write straight from the pool buffer */
     size_t done = 0;
-    while (done < len){
-        ssize_t w = write(u->fd, data + done, len - done);
-        if (w > 0){
-            done += (size_t)w;
-            continue;
-        } else if (w < 0 && errno == EINTR){
-            continue;
-        } else if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
-            break;
-        } else {
-            u->send_errs++;
-            return -1;
+    if (u->txq_count == 0){
+        while (done < len){
+            ssize_t w = write(u->fd, p->data + done, len - done);
+            if (w > 0){
+                done += (size_t)w;
+                continue;
+            } else if (w < 0 && errno == EINTR){
+                continue;
+            } else if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+                break;
+            } else {
+                u->send_errs++;
+                return -1;
+            }
         }
+        if (done == len) return 0;
     }
 
-    if (done < len){
-        size_t queued = ring_write(&u->out, data + done, len - done);
-        if (queued < len - done){
-            u->drops += (uint64_t)((len - done) - queued);
-            u->send_errs++;
-            return -1;
-        }
-        uart_update_epoll_interest(u);
+    /* queue the packet by reference; the flush path unrefs it when the
+       last byte has been written */
+    size_t rem = len - done;
+    size_t cap = (size_t)((u->cfg.tx_buf>0)?u->cfg.tx_buf:UART_TX_BUF_DEFAULT);
+    if (u->txq_count >= UART_TXQ_CAP || u->txq_bytes + rem > cap){
+        u->drops += (uint64_t)rem;
+        u->send_errs++;
+        return -1;
     }
-
+    int slot = (u->txq_head + u->txq_count) % UART_TXQ_CAP;
+    pkt_ref(p);
+    u->txq[slot].p = p;
+    u->txq[slot].len = len;
+    if (u->txq_count == 0) u->txq_off = done;
+    u->txq_count++;
+    u->txq_bytes += rem;
+    uart_update_epoll_interest(u);
     return 0;
 }
 
@@ -796,7 +875,7 @@ static void uart_close(struct uart_runtime *u){
     if (u->udp_fd >= 0){
         close(u->udp_fd);
     }
-    ring_free(&u->out);
+    uart_txq_clear(u);
     if (u->rx_buf){
         free(u->rx_buf);
         u->rx_buf = NULL;
@@ -829,16 +908,10 @@ static int uart_apply_one(int idx, const struct config *c){
     }
 
     size_t tx_cap = (size_t)((src->tx_buf>0)?src->tx_buf:UART_TX_BUF_DEFAULT);
-    ringbuf_t new_out;
-    if (ring_init(&new_out, tx_cap) < 0){
-        close(fd);
-        return -1;
-    }
 
     size_t rx_cap = (size_t)((src->rx_buf>0)?src->rx_buf:UART_RX_BUF_DEFAULT);
     uint8_t *rx_buf = malloc(rx_cap);
     if (!rx_buf){
-        ring_free(&new_out);
         close(fd);
         return -1;
     }
@@ -848,7 +921,6 @@ static int uart_apply_one(int idx, const struct config *c){
     if (udp_fd < 0){
         perror("uart udp bind");
         free(rx_buf);
-        ring_free(&new_out);
         close(fd);
         return -1;
     }
@@ -857,7 +929,6 @@ static int uart_apply_one(int idx, const struct config *c){
 
     u->fd = fd;
     u->udp_fd = udp_fd;
-    u->out = new_out;
     u->rx_buf = rx_buf;
     u->rx_buf_cap = rx_cap;
     u->cfg = *src;
@@ -892,20 +963,24 @@ static int uart_apply_config_all(const struct config *c){
     return rc;
 }
 
-static int uart_send_from_udp(struct uart_runtime *u, const uint8_t *data, size_t len){
+static int uart_send_from_udp(struct uart_runtime *u, struct pkt *p, size_t len){
     if (!u || !u->enabled || u->fd < 0) return -1;
-    if (uart_send_bytes(u, data, len) == 0){
+    pthread_mutex_lock(&UART_IO_LOCK);
+    int rc = uart_send_pkt(u, p, len);
+    if (rc == 0){
         u->pkts_out++;
         u->bytes_out += (uint64_t)len;
         uart_maybe_rollover(u);
-        return 0;
     }
-    return -1;
+    pthread_mutex_unlock(&UART_IO_LOCK);
+    return (rc == 0) ? 0 : -1;
 }
 
 static void uart_handle_write(struct uart_runtime *u){
+    pthread_mutex_lock(&UART_IO_LOCK);
     uart_flush_output(u);
     uart_update_epoll_interest(u);
+    pthread_mutex_unlock(&UART_IO_LOCK);
 }
 
 static void uart_handle_read(struct uart_runtime *u){
@@ -997,7 +1072,261 @@ static int make_udp_socket(const char *bind_ip, int port, int rcvbuf, int sndbuf
     return s;
 }
 
+
+/* ------------------- rx worker threads ---------------------- */
+/* With workers=N, every UDP relay port is opened N times with SO_REUSEPORT
+   (make_udp_socket always sets it) and each worker runs its own epoll loop
+   over its own socket set, so the kernel spreads flows across cores. Worker 0
+   adopts the socket apply_config_relays created; the rest bind their own.
+   UART relays and the HTTP/control plane stay on the main loop. */
+
+struct rx_worker {
+    pthread_t thread;
+    int index;
+    int started;
+    int epfd;
+    struct pkt *pkt[RX_BATCH]; /* worker-private receive slots from the pool */
+    int spin_us;
+    struct mmsghdr msgs[RX_BATCH];
+    struct iovec   iov[RX_BATCH];
+    char           ctrl[RX_BATCH][CMSG_SPACE(sizeof(uint32_t))];
+    uint64_t last_rx_ns;
+    int fds[MAX_RELAYS];
+    struct relay *owner[MAX_RELAYS];
+    unsigned char owns_fd[MAX_RELAYS]; /* 0: fd belongs to REL (worker 0) */
+    int nfds;
+};
+
+static struct rx_worker WORKERS[MAX_WORKERS];
+static int WORKERS_N = 0;
+static volatile int WORKERS_STOP = 0;
+
+static void *worker_main(void *arg){
+    struct rx_worker *w = arg;
+#ifdef __linux__
+    cpu_set_t cpus; CPU_ZERO(&cpus);
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu > 0){
+        CPU_SET((unsigned)(w->index % (int)ncpu), &cpus);
+        (void)pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+#endif
+    struct epoll_event events[MAX_EVENTS];
+    while (!WORKERS_STOP){
+        int timeout_ms = 1000;
+        if (w->spin_us > 0 && w->last_rx_ns &&
+            now_ns() - w->last_rx_ns < (uint64_t)w->spin_us * 1000ull){
+            timeout_ms = 0;
+        }
+        int n = epoll_wait(w->epfd, events, MAX_EVENTS, timeout_ms);
+        if (n < 0){
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i=0;i<n;i++){
+            if (!(events[i].events & EPOLLIN)) continue;
+            int slot = (int)events[i].data.u32;
+            if (slot < 0 || slot >= w->nfds) continue;
+            int fd = w->fds[slot];
+            struct relay *r = w->owner[slot];
+
+            while (1){
+                for (int b=0;b<RX_BATCH;b++){
+                    w->msgs[b].msg_hdr.msg_controllen = sizeof(w->ctrl[b]);
+                    w->msgs[b].msg_hdr.msg_flags = 0;
+                }
+                int got = recvmmsg(fd, w->msgs, RX_BATCH, 0, NULL);
+                if (got <= 0) break;
+                for (int b=0;b<got;b++){
+                    struct msghdr *mh = &w->msgs[b].msg_hdr;
+                    size_t m = w->msgs[b].msg_len;
+                    for (struct cmsghdr *cm = CMSG_FIRSTHDR(mh); cm; cm = CMSG_NXTHDR(mh, cm)){
+#ifdef SO_RXQ_OVFL
+                        if (cm->cmsg_level==SOL_SOCKET && cm->cmsg_type==SO_RXQ_OVFL){
+                            uint32_t dropped = 0;
+                            memcpy(&dropped, CMSG_DATA(cm), sizeof(dropped));
+                            __sync_fetch_and_add(&r->rx_drops, (uint64_t)dropped);
+                        }
+#endif
+                    }
+                    if (mh->msg_flags & MSG_TRUNC){
+                        __sync_fetch_and_add(&r->trunc_drops, 1);
+                        continue;
+                    }
+                    __sync_fetch_and_add(&r->pkts_in, 1);
+                    __sync_fetch_and_add(&r->bytes_in, (uint64_t)m);
+                    w->last_rx_ns = now_ns();
+                    r->last_rx_ns = w->last_rx_ns;
+                    relay_forward_datagram(r, fd, w->pkt[b], m);
+                    struct pkt *np = pkt_detach_if_shared(w->pkt[b]);
+                    if (np != w->pkt[b]){
+                        w->pkt[b] = np;
+                        w->iov[b].iov_base = np->data;
+                    }
+                    /* rollover is done from the main loop: halving here would
+                       race with the other workers' atomic adds */
+                }
+                if (got < RX_BATCH) break;
+            }
+        }
+    }
+    return NULL;
+}
+
+static void workers_stop(void){
+    if (WORKERS_N <= 0) return;
+    WORKERS_STOP = 1;
+    for (int w=0; w<WORKERS_N; w++){
+        struct rx_worker *wk = &WORKERS[w];
+        if (wk->started){ pthread_join(wk->thread, NULL); wk->started = 0; }
+        for (int si=0; si<wk->nfds; si++){
+            if (wk->epfd >= 0) epoll_ctl(wk->epfd, EPOLL_CTL_DEL, wk->fds[si], NULL);
+            if (wk->owns_fd[si]) close(wk->fds[si]);
+        }
+        wk->nfds = 0;
+        if (wk->epfd >= 0){ close(wk->epfd); wk->epfd = -1; }
+        for (int b=0;b<RX_BATCH;b++){
+            if (wk->pkt[b]){ pkt_unref(wk->pkt[b]); wk->pkt[b] = NULL; }
+        }
+    }
+    WORKERS_N = 0;
+    WORKERS_STOP = 0;
+}
+
+static void workers_start(const struct config *c){
+    int nw = c->workers;
+    if (nw <= 0) return;
+    if (nw > MAX_WORKERS) nw = MAX_WORKERS;
+    for (int w=0; w<nw; w++){
+        struct rx_worker *wk = &WORKERS[w];
+        memset(wk, 0, sizeof(*wk));
+        wk->index = w;
+        wk->spin_us = c->spin_us;
+        wk->epfd = epoll_create1(EPOLL_CLOEXEC);
+        if (wk->epfd < 0){ perror("epoll_create1 worker"); continue; }
+        int short_pool = 0;
+        for (int b=0;b<RX_BATCH;b++){
+            wk->pkt[b] = pkt_get();
+            if (!wk->pkt[b]) short_pool = 1;
+        }
+        if (short_pool){
+            fprintf(stderr,"worker %d: packet pool exhausted\n", w);
+            for (int b=0;b<RX_BATCH;b++){
+                if (wk->pkt[b]){ pkt_unref(wk->pkt[b]); wk->pkt[b]=NULL; }
+            }
+            close(wk->epfd); wk->epfd=-1;
+            continue;
+        }
+        for (int b=0;b<RX_BATCH;b++){
+            wk->iov[b].iov_base = wk->pkt[b]->data;
+            wk->iov[b].iov_len  = (size_t)POOL_BUFSZ;
+            wk->msgs[b].msg_hdr.msg_iov = &wk->iov[b];
+            wk->msgs[b].msg_hdr.msg_iovlen = 1;
+            wk->msgs[b].msg_hdr.msg_control = wk->ctrl[b];
+            wk->msgs[b].msg_hdr.msg_controllen = sizeof(wk->ctrl[b]);
+        }
+        for (int k=0;k<REL_N;k++){
+            struct relay *r = &REL[k];
+            if (r->kind != RELAY_KIND_UDP || r->fd < 0) continue;
+            int fd;
+            if (w == 0){
+                fd = r->fd; /* adopt; close_relays still owns it */
+            } else {
+                fd = make_udp_socket(c->src_ip, r->src_port, c->rcvbuf, c->sndbuf, c->tos);
+                if (fd < 0){
+                    fprintf(stderr,"worker %d: reuseport bind %d failed\n", w, r->src_port);
+                    continue;
+                }
+#ifdef SO_BUSY_POLL
+                if (c->busy_poll_us > 0){
+                    int bp = c->busy_poll_us;
+                    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &bp, sizeof(bp))<0)
+                        perror("setsockopt SO_BUSY_POLL");
+                }
+#endif
+            }
+            int slot = wk->nfds;
+            wk->fds[slot] = fd;
+            wk->owner[slot] = r;
+            wk->owns_fd[slot] = (unsigned char)(w != 0);
+            struct epoll_event ev={.events=EPOLLIN, .data.u32=(uint32_t)slot};
+            if (epoll_ctl(wk->epfd, EPOLL_CTL_ADD, fd, &ev)<0){
+                perror("epoll_ctl add worker udp");
+                if (w != 0) close(fd);
+                continue;
+            }
+            wk->nfds++;
+        }
+        if (pthread_create(&wk->thread, NULL, worker_main, wk)!=0){
+            perror("pthread_create worker");
+        } else {
+            wk->started = 1;
+        }
+        WORKERS_N = w + 1;
+    }
+    fprintf(stderr,"Started %d rx worker thread(s)\n", WORKERS_N);
+}
+
+/* ------------------- packet pool lifecycle ------------------ */
+/* (Re)size the pool for a config. Call BEFORE apply_config_relays so the
+   restarted workers draw their receive slots from the new pool. A resize
+   stops the workers and clears every UART queue first, which drains all
+   references; the old buffers are then freed wholesale. */
+static int pool_setup(int bufsz, int workers){
+    if (bufsz <= 0) bufsz = 9000;
+    if (workers < 0) workers = 0;
+    if (workers > MAX_WORKERS) workers = MAX_WORKERS;
+    int need = (workers + 1) * RX_BATCH + MAX_UARTS * UART_TXQ_CAP;
+    if (POOL && POOL_BUFSZ == bufsz && POOL_N >= need) return 0;
+
+    workers_stop();
+    pthread_mutex_lock(&UART_IO_LOCK);
+    for (int i=0;i<MAX_UARTS;i++) uart_txq_clear(&UARTS[i]);
+    pthread_mutex_unlock(&UART_IO_LOCK);
+    for (int i=0;i<RX_BATCH;i++) RX_PKT[i] = NULL;
+
+    if (POOL){
+        for (int i=0;i<POOL_N;i++) free(POOL[i].data);
+        free(POOL);
+        free(POOL_FREE);
+        POOL = NULL; POOL_FREE = NULL;
+        POOL_N = POOL_FREE_N = 0; POOL_BUFSZ = 0;
+    }
+
+    struct pkt *pool = calloc((size_t)need, sizeof(*pool));
+    struct pkt **stack = calloc((size_t)need, sizeof(*stack));
+    if (!pool || !stack){
+        free(pool); free(stack);
+        return -1;
+    }
+    for (int i=0;i<need;i++){
+        pool[i].data = malloc((size_t)bufsz);
+        if (!pool[i].data){
+            for (int j=0;j<i;j++) free(pool[j].data);
+            free(pool); free(stack);
+            return -1;
+        }
+        stack[i] = &pool[i];
+    }
+    POOL = pool;
+    POOL_FREE = stack;
+    POOL_N = need;
+    POOL_FREE_N = need;
+    POOL_BUFSZ = bufsz;
+    return 0;
+}
+
+static void pool_destroy(void){
+    if (!POOL) return;
+    for (int i=0;i<POOL_N;i++) free(POOL[i].data);
+    free(POOL);
+    free(POOL_FREE);
+    POOL = NULL; POOL_FREE = NULL;
+    POOL_N = POOL_FREE_N = 0; POOL_BUFSZ = 0;
+}
+
 static void close_relays(void){
+    workers_stop();
     for (int ui=0; ui<MAX_UARTS; ui++){
         UARTS[ui].relay = NULL;
     }
@@ -1058,9 +1387,21 @@ static int apply_config_relays(const struct config *c){
         r->src_port=sport;
         r->fd=make_udp_socket(c->src_ip, sport, c->rcvbuf, c->sndbuf, c->tos);
         if (r->fd<0){ fprintf(stderr,"Bind failed %d\n", sport); continue; }
+#ifdef SO_BUSY_POLL
+        if (c->busy_poll_us > 0){
+            int bp = c->busy_poll_us;
+            if (setsockopt(r->fd, SOL_SOCKET, SO_BUSY_POLL, &bp, sizeof(bp))<0)
+                perror("setsockopt SO_BUSY_POLL");
+        }
+#endif
 
-        struct epoll_event ev={.events=EPOLLIN, .data.fd=r->fd};
-        if (epoll_ctl(EPFD, EPOLL_CTL_ADD, r->fd, &ev)<0){ perror("epoll_ctl add udp"); close(r->fd); continue; }
+        if (c->workers <= 0){
+            /* worker mode keeps relay fds out of the main epoll: a bound but
+               never-read socket would still take its share of the reuseport
+               hash and blackhole those flows */
+            struct epoll_event ev={.events=EPOLLIN, .data.fd=r->fd};
+            if (epoll_ctl(EPFD, EPOLL_CTL_ADD, r->fd, &ev)<0){ perror("epoll_ctl add udp"); close(r->fd); continue; }
+        }
 
         if (list && *list){
             if (parse_dest_list(r->dests, &r->dest_cnt, MAX_DESTS, list, true, true)<0){
@@ -1072,6 +1413,7 @@ static int apply_config_relays(const struct config *c){
                 sport, r->dest_cnt, c->src_ip, c->bufsz, c->rcvbuf, c->sndbuf, c->tos);
         REL_N++;
     }
+    if (REL_N > 0 && c->workers > 0) workers_start(c);
     return (REL_N>0)?0:-1;
 }
 
@@ -1408,7 +1750,7 @@ static void http_handle_status(int fd){
            "Content-Type: application/json\r\n"
            "Connection: close\r\n"
            "\r\n");
-    APPEND("{\"relays\":[");
+    APPEND("{\"workers\":%d,\"relays\":[", WORKERS_N);
     for (int i=0;i<REL_N;i++){
         if (i) APPEND(",");
         struct relay *r=&REL[i];
@@ -1529,31 +1871,30 @@ static void http_handle_post_config(int fd, const char *body, size_t len){
         }
     }
 
-    char *new_udp = malloc((size_t)newc.bufsz);
-    if (!new_udp){
+    if (pool_setup(newc.bufsz, newc.workers)!=0){
         if (new_http_fd >= 0) close(new_http_fd);
         http_send(fd,"HTTP/1.0 500 Internal Server Error\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\noom\n");
         return;
     }
 
     if (apply_config_relays(&newc)!=0){
+        (void)pool_setup(oldc.bufsz, oldc.workers);
         if (apply_config_relays(&oldc)!=0){
             fprintf(stderr,"Failed to restore previous relay config after error\n");
         }
-        free(new_udp);
         if (new_http_fd >= 0) close(new_http_fd);
         http_send(fd,"HTTP/1.0 400 Bad Request\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\nno valid binds\n");
         return;
     }
 
     if (uart_apply_config_all(&newc)!=0){
+        (void)pool_setup(oldc.bufsz, oldc.workers);
         if (apply_config_relays(&oldc)!=0){
             fprintf(stderr,"Failed to restore previous relay config after UART error\n");
         }
         if (uart_apply_config_all(&oldc)!=0){
             fprintf(stderr,"Failed to restore previous UART config after error\n");
         }
-        free(new_udp);
         if (new_http_fd >= 0) close(new_http_fd);
         http_send(fd,"HTTP/1.0 400 Bad Request\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\nuart setup failed\n");
         return;
@@ -1563,10 +1904,10 @@ static void http_handle_post_config(int fd, const char *body, size_t len){
         struct epoll_event ev={.events=EPOLLIN, .data.fd=new_http_fd};
         if (epoll_ctl(EPFD, EPOLL_CTL_ADD, new_http_fd, &ev)<0){
             perror("epoll_ctl add http");
+            (void)pool_setup(oldc.bufsz, oldc.workers);
             if (apply_config_relays(&oldc)!=0){
                 fprintf(stderr,"Failed to restore previous relay config after error\n");
             }
-            free(new_udp);
             close(new_http_fd);
             http_send(fd,"HTTP/1.0 500 Internal Server Error\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\nhttp listen failed\n");
             return;
@@ -1579,25 +1920,21 @@ static void http_handle_post_config(int fd, const char *body, size_t len){
         new_http_fd = -1;
     }
 
-    char *old_udp = UDP_BUF;
-    UDP_BUF = new_udp;
-    new_udp = NULL;
-
     G = newc;
+    udp_rx_setup();
 
     if (save_file_atomic(CFG_TMP_PATH, CFG_PATH, body, len)!=0){
         http_send(fd,"HTTP/1.0 500 Internal Server Error\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\npersist failed\n");
         reload_from_disk();
-        if (old_udp) free(old_udp);
         if (new_http_fd >= 0) close(new_http_fd);
         return;
     }
 
-    if (old_udp) free(old_udp);
     http_send(fd,"HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nConnection: close\r\n\r\n{\"ok\":true}\n");
 }
 
 static void http_handle_action(int fd, const char *verb, const char *body){
+    pthread_mutex_lock(&REL_LOCK);
     int rc=-1;
     struct relay *r = NULL;
     if (!strcmp(verb,"set")){
@@ -1628,9 +1965,11 @@ static void http_handle_action(int fd, const char *verb, const char *body){
         r = json_find_relay(body);
         rc=apply_clear_to(r, body);
     } else {
+        pthread_mutex_unlock(&REL_LOCK);
         http_send(fd,"HTTP/1.0 404 Not Found\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\nunknown verb\n");
         return;
     }
+    pthread_mutex_unlock(&REL_LOCK);
     if (rc==0) http_send(fd,"HTTP/1.0 200 OK\r\nContent-Type: application/json\r\nConnection: close\r\n\r\n{\"ok\":true}\n");
     else       http_send(fd,"HTTP/1.0 400 Bad Request\r\nContent-Type: text/plain\r\nConnection: close\r\n\r\nbad action\n");
 }
@@ -1809,6 +2148,12 @@ static int reload_from_disk(void){
     struct epoll_event ev={.events=EPOLLIN, .data.fd=HTTP_LFD};
     epoll_ctl(EPFD, EPOLL_CTL_ADD, HTTP_LFD, &ev);
 
+    /* Resize the packet pool before the relays restart their workers */
+    if (pool_setup(G.bufsz, G.workers)!=0){
+        fprintf(stderr,"Reload failed: packet pool\n");
+        return -3;
+    }
+
     /* Re-apply relay sockets */
     if (apply_config_relays(&G)!=0){
         fprintf(stderr,"Reload warning: no valid binds\n");
@@ -1819,13 +2164,7 @@ static int reload_from_disk(void){
         fprintf(stderr,"Reload warning: UART setup failed\n");
     }
 
-    /* Resize UDP buffer */
-    if (UDP_BUF){ free(UDP_BUF); UDP_BUF=NULL; }
-    UDP_BUF = malloc((size_t)G.bufsz);
-    if (!UDP_BUF){
-        perror("malloc");
-        return -3;
-    }
+    udp_rx_setup();
 
     fprintf(stderr,"Reloaded config\n");
     return 0;
@@ -1839,6 +2178,89 @@ static void usage(const char *argv0){
         "  Serves /api/v1/* and optional /ui if --ui is given.\n", argv0);
 }
 
+/* Fan one received datagram out to the relay's destinations (UDP via
+   sendmmsg, UART via packet references). fd is the relay's own socket.
+   UART destinations that hit backpressure take a reference on the pool
+   packet; the caller checks refs afterwards and detaches its rx slot. */
+static void relay_forward_datagram(struct relay *r, int fd, struct pkt *p, size_t m){
+    /* snapshot addresses under REL_LOCK so HTTP mutations won't race
+       (workers call this concurrently with the control plane) */
+    struct dest snap[MAX_DESTS];
+    struct dest *dest_refs[MAX_DESTS];
+    pthread_mutex_lock(&REL_LOCK);
+    int cnt = r->dest_cnt;
+    if (cnt > MAX_DESTS) cnt = MAX_DESTS;
+    if (cnt > 0) memcpy(snap, r->dests, (size_t)cnt*sizeof(struct dest));
+    pthread_mutex_unlock(&REL_LOCK);
+    if (cnt <= 0) return;
+    for (int d=0; d<cnt; d++){
+        dest_refs[d] = &r->dests[d];
+    }
+
+    struct mmsghdr msgs[MAX_DESTS];
+    struct iovec   siov[MAX_DESTS];
+    struct dest   *udp_refs[MAX_DESTS];
+    int uart_seen[MAX_UARTS] = {0};
+    struct dest *uart_dest_for_idx[MAX_UARTS] = {0};
+    memset(msgs,0,sizeof(msgs));
+
+    int udp_cnt = 0;
+    for (int d=0; d<cnt; d++){
+        dest_refs[d] = &r->dests[d];
+        if (snap[d].type == DEST_UART){
+            int ui = snap[d].uart_idx;
+            if (ui >= 0 && ui < MAX_UARTS){
+                uart_seen[ui] = 1;
+                uart_dest_for_idx[ui] = dest_refs[d];
+            }
+            continue;
+        }
+        if (udp_cnt >= MAX_DESTS) continue;
+        udp_refs[udp_cnt] = dest_refs[d];
+        siov[udp_cnt].iov_base = p->data;
+        siov[udp_cnt].iov_len  = m;
+        msgs[udp_cnt].msg_hdr.msg_iov = &siov[udp_cnt];
+        msgs[udp_cnt].msg_hdr.msg_iovlen = 1;
+        msgs[udp_cnt].msg_hdr.msg_name = &snap[d].addr;
+        msgs[udp_cnt].msg_hdr.msg_namelen = sizeof(snap[d].addr);
+        udp_cnt++;
+    }
+
+    if (udp_cnt > 0){
+        int sent_total = 0;
+        while (sent_total < udp_cnt){
+            int rc = sendmmsg(fd, msgs + sent_total, (unsigned)(udp_cnt - sent_total), 0);
+            if (rc > 0){
+                for (int j=0; j<rc; j++){
+                    __sync_fetch_and_add(&r->bytes_out, (uint64_t)m);
+                    struct dest *dd = udp_refs[sent_total + j];
+                    if (dd){
+                        __sync_fetch_and_add(&dd->pkts_out, 1);
+                    }
+                }
+                sent_total += rc;
+            } else if (rc < 0 && (errno==EAGAIN || errno==EWOULDBLOCK)){
+                __sync_fetch_and_add(&r->send_errs, (uint64_t)(udp_cnt - sent_total));
+                break;
+            } else {
+                __sync_fetch_and_add(&r->send_errs, (uint64_t)(udp_cnt - sent_total));
+                break;
+            }
+        }
+    }
+
+    for (int ui=0; ui<MAX_UARTS; ui++){
+        if (!uart_seen[ui]) continue;
+        struct uart_runtime *u = &UARTS[ui];
+        if (uart_send_from_udp(u, p, m)==0){
+            __sync_fetch_and_add(&r->bytes_out, (uint64_t)m);
+            if (uart_dest_for_idx[ui]) __sync_fetch_and_add(&uart_dest_for_idx[ui]->pkts_out, 1);
+        } else {
+            __sync_fetch_and_add(&r->send_errs, 1);
+        }
+    }
+}
+
 int main(int argc, char **argv){
     const char *ui_path = NULL;
     for (int i=1;i<argc;i++){
@@ -1876,6 +2298,8 @@ int main(int argc, char **argv){
     if (load_ini_file(&G)!=0){ fprintf(stderr,"Bad INI, using defaults\n"); cfg_defaults(&G); }
     if (G.bufsz<=0) G.bufsz=9000;
 
+    if (pool_setup(G.bufsz, G.workers)!=0){ perror("malloc"); return 1; }
+
     HTTP_LFD = http_listen(G.http_bind, G.control_port);
     if (HTTP_LFD<0){ fprintf(stderr,"HTTP listen failed\n"); return 1; }
     struct epoll_event ev={.events=EPOLLIN, .data.fd=HTTP_LFD};
@@ -1891,8 +2315,7 @@ int main(int argc, char **argv){
         return 1;
     }
 
-    UDP_BUF = malloc((size_t)G.bufsz);
-    if (!UDP_BUF){ perror("malloc"); return 1; }
+    udp_rx_setup();
 
     struct epoll_event events[MAX_EVENTS];
 
@@ -1902,7 +2325,14 @@ int main(int argc, char **argv){
             (void)reload_from_disk();
         }
 
-        int n = epoll_wait(EPFD, events, MAX_EVENTS, 1000 /*ms*/);
+        /* spin-then-epoll: while traffic is fresh, poll without sleeping so
+           bursts are picked up with no wakeup latency */
+        int timeout_ms = 1000;
+        if (G.spin_us > 0 && LAST_RX_NS &&
+            now_ns() - LAST_RX_NS < (uint64_t)G.spin_us * 1000ull){
+            timeout_ms = 0;
+        }
+        int n = epoll_wait(EPFD, events, MAX_EVENTS, timeout_ms);
         if (n<0){
             if (errno==EINTR) continue;
             perror("epoll_wait");
@@ -1952,17 +2382,22 @@ int main(int argc, char **argv){
                 if (!r) continue;
 
                 while (1){
-                    /* recvmsg with SO_RXQ_OVFL accumulation and truncation detection */
-                    struct iovec iov = { .iov_base = UDP_BUF, .iov_len = (size_t)G.bufsz };
-                    char cbuf[CMSG_SPACE(sizeof(uint32_t))];
-                    struct msghdr msg = {0};
-                    msg.msg_iov = &iov; msg.msg_iovlen = 1;
-                    msg.msg_control = cbuf; msg.msg_controllen = sizeof(cbuf);
-
-                    ssize_t m = recvmsg(fd, &msg, 0);
-                    if (m>0){
+                    /* drain a whole burst per wakeup; control/flags fields are
+                       rewritten by the kernel, so re-arm them each call */
+                    for (int b=0;b<RX_BATCH;b++){
+                        RX_MSGS[b].msg_hdr.msg_controllen = sizeof(RX_CTRL[b]);
+                        RX_MSGS[b].msg_hdr.msg_flags = 0;
+                    }
+                    int got = recvmmsg(fd, RX_MSGS, RX_BATCH, 0, NULL);
+                    if (got <= 0){
+                        break; /* EAGAIN (drained) or error: back to epoll */
+                    }
+                    for (int b=0;b<got;b++){
+                        struct msghdr *mh = &RX_MSGS[b].msg_hdr;
+                        size_t m = RX_MSGS[b].msg_len;
+
                         /* count kernel drop cmsg (dropped since last packet) */
-                        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)){
+                        for (struct cmsghdr *cm = CMSG_FIRSTHDR(mh); cm; cm = CMSG_NXTHDR(mh, cm)){
 #ifdef SO_RXQ_OVFL
                             if (cm->cmsg_level==SOL_SOCKET && cm->cmsg_type==SO_RXQ_OVFL){
                                 uint32_t dropped = 0;
@@ -1973,103 +2408,39 @@ int main(int argc, char **argv){
                         }
 
                         /* drop & count truncated datagrams (avoid forwarding partial frames) */
-                        if (msg.msg_flags & MSG_TRUNC){
+                        if (mh->msg_flags & MSG_TRUNC){
                             r->trunc_drops++;
                             continue;
                         }
 
-                        r->pkts_in++; r->bytes_in += (uint64_t)m; r->last_rx_ns = now_ns();
-
-                        int cnt = r->dest_cnt;
-                        if (cnt <= 0){ maybe_rollover_relay(r); continue; }
-                        if (cnt > MAX_DESTS) cnt = MAX_DESTS;
-
-                        /* snapshot addresses so HTTP mutations won't race */
-                        struct dest snap[MAX_DESTS];
-                        struct dest *dest_refs[MAX_DESTS];
-                        memcpy(snap, r->dests, (size_t)cnt*sizeof(struct dest));
-                        for (int d=0; d<cnt; d++){
-                            dest_refs[d] = &r->dests[d];
+                        r->pkts_in++; r->bytes_in += (uint64_t)m;
+                        r->last_rx_ns = now_ns();
+                        LAST_RX_NS = r->last_rx_ns;
+                        relay_forward_datagram(r, fd, RX_PKT[b], m);
+                        struct pkt *np = pkt_detach_if_shared(RX_PKT[b]);
+                        if (np != RX_PKT[b]){
+                            RX_PKT[b] = np;
+                            RX_IOV[b].iov_base = np->data;
                         }
-
-                        struct mmsghdr msgs[MAX_DESTS];
-                        struct iovec   siov[MAX_DESTS];
-                        struct dest   *udp_refs[MAX_DESTS];
-                        int uart_seen[MAX_UARTS] = {0};
-                        struct dest *uart_dest_for_idx[MAX_UARTS] = {0};
-                        memset(msgs,0,sizeof(msgs));
-
-                        int udp_cnt = 0;
-                        for (int d=0; d<cnt; d++){
-                            dest_refs[d] = &r->dests[d];
-                            if (snap[d].type == DEST_UART){
-                                int ui = snap[d].uart_idx;
-                                if (ui >= 0 && ui < MAX_UARTS){
-                                    uart_seen[ui] = 1;
-                                    uart_dest_for_idx[ui] = dest_refs[d];
-                                }
-                                continue;
-                            }
-                            if (udp_cnt >= MAX_DESTS) continue;
-                            udp_refs[udp_cnt] = dest_refs[d];
-                            siov[udp_cnt].iov_base = UDP_BUF;
-                            siov[udp_cnt].iov_len  = (size_t)m;
-                            msgs[udp_cnt].msg_hdr.msg_iov = &siov[udp_cnt];
-                            msgs[udp_cnt].msg_hdr.msg_iovlen = 1;
-                            msgs[udp_cnt].msg_hdr.msg_name = &snap[d].addr;
-                            msgs[udp_cnt].msg_hdr.msg_namelen = sizeof(snap[d].addr);
-                            udp_cnt++;
-                        }
-
-                        if (udp_cnt > 0){
-                            int sent_total = 0;
-                            while (sent_total < udp_cnt){
-                                int rc = sendmmsg(fd, msgs + sent_total, (unsigned)(udp_cnt - sent_total), 0);
-                                if (rc > 0){
-                                    for (int j=0; j<rc; j++){
-                                        r->bytes_out += (uint64_t)m;
-                                        struct dest *dd = udp_refs[sent_total + j];
-                                        if (dd){
-                                            dd->pkts_out++;
-                                        }
-                                    }
-                                    sent_total += rc;
-                                } else if (rc < 0 && (errno==EAGAIN || errno==EWOULDBLOCK)){
-                                    r->send_errs += (uint64_t)(udp_cnt - sent_total);
-                                    break;
-                                } else {
-                                    r->send_errs += (uint64_t)(udp_cnt - sent_total);
-                                    break;
-                                }
-                            }
-                        }
-
-                        for (int ui=0; ui<MAX_UARTS; ui++){
-                            if (!uart_seen[ui]) continue;
-                            struct uart_runtime *u = &UARTS[ui];
-                            if (uart_send_from_udp(u, (const uint8_t*)UDP_BUF, (size_t)m)==0){
-                                r->bytes_out += (uint64_t)m;
-                                if (uart_dest_for_idx[ui]) uart_dest_for_idx[ui]->pkts_out++;
-                            } else {
-                                r->send_errs++;
-                            }
-                        }
-
                         maybe_rollover_relay(r);
-                    } else if (m<0){
-                        if (errno==EAGAIN||errno==EWOULDBLOCK) break;
-                        break;
-                    } else { break; }
+                    }
+                    if (got < RX_BATCH) break; /* socket drained */
                 }
             }
         }
+
+        if (WORKERS_N > 0){
+            /* workers leave counter rollover to us: halving in a worker would
+               race with the others' atomic adds (stats-only, approximate) */
+            for (int k=0;k<REL_N;k++) maybe_rollover_relay(&REL[k]);
+        }
     }
 
     if (HTTP_LFD>=0){ epoll_ctl(EPFD, EPOLL_CTL_DEL, HTTP_LFD, NULL); close(HTTP_LFD); }
     close_relays();
     for (int i=0;i<MAX_HTTP_CONN;i++) if (HC[i].fd) hc_del(HC[i].fd);
     for (int ui=0; ui<MAX_UARTS; ui++) uart_close(&UARTS[ui]);
-    if (UDP_BUF) free(UDP_BUF);
+    pool_destroy();
     if (UI_BUF) free(UI_BUF);
     if (EPFD>=0) close(EPFD);
     return 0;
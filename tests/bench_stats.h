@@ -0,0 +1,57 @@
+// Shared sample recorder + percentile helpers for the benchmark tools
+// (udp_bench.c, http_bench.c, crsf_source.c). Samples are appended to a
+// growable array and sorted once when percentiles are requested.
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    double *v;
+    size_t n, cap;
+} bstats_t;
+
+static inline void bstats_init(bstats_t *s) { memset(s, 0, sizeof(*s)); }
+
+static inline void bstats_free(bstats_t *s) {
+    free(s->v);
+    memset(s, 0, sizeof(*s));
+}
+
+static inline void bstats_add(bstats_t *s, double x) {
+    if (s->n == s->cap) {
+        size_t nc = s->cap ? s->cap * 2 : 4096;
+        double *nv = realloc(s->v, nc * sizeof(*nv));
+        if (!nv) return; // drop the sample rather than abort a long run
+        s->v = nv;
+        s->cap = nc;
+    }
+    s->v[s->n++] = x;
+}
+
+static inline int bstats_cmp(const void *a, const void *b) {
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static inline void bstats_sort(bstats_t *s) {
+    qsort(s->v, s->n, sizeof(*s->v), bstats_cmp);
+}
+
+// pct in [0,100]; call bstats_sort() first.
+static inline double bstats_percentile(const bstats_t *s, double pct) {
+    if (s->n == 0) return 0.0;
+    size_t idx = (size_t)((pct / 100.0) * (double)(s->n - 1) + 0.5);
+    if (idx >= s->n) idx = s->n - 1;
+    return s->v[idx];
+}
+
+static inline double bstats_mean(const bstats_t *s) {
+    if (s->n == 0) return 0.0;
+    double sum = 0.0;
+    for (size_t i = 0; i < s->n; i++) sum += s->v[i];
+    return sum / (double)s->n;
+}
+
+#endif
@@ -0,0 +1,162 @@
+// CRSF-rate UDP frame source, companion to crsf_dump.c. Streams packed RC
+// channel frames (type 0x16) at a configured rate with absolute-clock pacing
+// and reports achieved rate plus per-tick scheduling jitter p50/p99 — the
+// numbers that matter when validating a 250 Hz control chain end to end.
+//
+// Build:  gcc -O2 -Wall -Wextra -std=c11 crsf_source.c -o crsf_source
+// Run:    ./crsf_source [-H host] [-p port] [-r hz] [-d secs] [--sweep]
+//
+// Channels idle at mid-stick; --sweep ramps channel 1 so crsf_dump or a
+// downstream OSD visibly tracks the stream.
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench_stats.h"
+
+#define CRSF_DEST          0xC8
+#define CRSF_TYPE_CHANNELS 0x16
+#define CRSF_FRAME_LEN     24
+#define CRSF_MIN           172
+#define CRSF_MAX           1811
+#define CRSF_MID           ((CRSF_MIN + CRSF_MAX + 1) / 2)
+
+static volatile sig_atomic_t g_run = 1;
+static void on_sigint(int sig) { (void)sig; g_run = 0; }
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint8_t crc8(const uint8_t *d, size_t n) {
+    uint8_t c = 0;
+    while (n--) {
+        c ^= *d++;
+        for (int i = 0; i < 8; i++) {
+            c = (uint8_t)((c & 0x80U) ? ((unsigned)c << 1) ^ 0xD5U
+                                      : ((unsigned)c << 1));
+        }
+    }
+    return c;
+}
+
+// 16 channels x 11 bits into 22 payload bytes, LSB first.
+static void pack_channels(const uint16_t ch[16], uint8_t *out) {
+    memset(out, 0, 22);
+    int bit = 0;
+    for (int i = 0; i < 16; i++) {
+        uint32_t v = ch[i] & 0x7FF;
+        int byte = bit / 8, off = bit % 8;
+        out[byte] |= (uint8_t)(v << off);
+        out[byte + 1] |= (uint8_t)(v >> (8 - off));
+        if (off > 5) out[byte + 2] |= (uint8_t)(v >> (16 - off));
+        bit += 11;
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    int port = 14550, rate = 250, secs = 5, sweep = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-H") && i + 1 < argc) host = argv[++i];
+        else if (!strcmp(argv[i], "-p") && i + 1 < argc) port = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc) rate = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-d") && i + 1 < argc) secs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--sweep")) sweep = 1;
+        else {
+            fprintf(stderr,
+                    "Usage: %s [-H host] [-p port] [-r hz] [-d secs] [--sweep]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (rate < 1) rate = 1;
+    if (rate > 1000) rate = 1000;
+
+    // sigaction without SA_RESTART so a signal interrupts blocking recv/sleep
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigint;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    struct sockaddr_in dst;
+    memset(&dst, 0, sizeof(dst));
+    dst.sin_family = AF_INET;
+    dst.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &dst.sin_addr) != 1) {
+        fprintf(stderr, "bad host '%s' (IPv4 only)\n", host);
+        return 1;
+    }
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) { perror("socket"); return 1; }
+
+    uint16_t ch[16];
+    for (int i = 0; i < 16; i++) ch[i] = CRSF_MID;
+
+    uint8_t frame[CRSF_FRAME_LEN + 2];
+    frame[0] = CRSF_DEST;
+    frame[1] = CRSF_FRAME_LEN;
+    frame[2] = CRSF_TYPE_CHANNELS;
+
+    bstats_t jitter_us;
+    bstats_init(&jitter_us);
+
+    int64_t interval = 1000000000LL / rate;
+    int64_t t0 = now_ns();
+    int64_t t_end = t0 + (int64_t)secs * 1000000000LL;
+    int64_t next = t0 + interval;
+    uint64_t sent = 0, errs = 0;
+
+    while (g_run) {
+        if (sweep) {
+            ch[0] = (uint16_t)(CRSF_MIN + (sent % 100) * (CRSF_MAX - CRSF_MIN) / 99);
+        }
+        pack_channels(ch, frame + 3);
+        frame[CRSF_FRAME_LEN + 1] = crc8(frame + 2, CRSF_FRAME_LEN - 1);
+        if (sendto(fd, frame, sizeof(frame), 0,
+                   (struct sockaddr *)&dst, sizeof(dst)) < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != ECONNREFUSED) {
+                perror("sendto");
+                break;
+            }
+            errs++;
+        } else {
+            sent++;
+        }
+
+        if (next >= t_end) break;
+        struct timespec ts = {
+            .tv_sec = (time_t)(next / 1000000000LL),
+            .tv_nsec = (long)(next % 1000000000LL),
+        };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        int64_t woke = now_ns();
+        bstats_add(&jitter_us, (double)(woke - next) / 1000.0);
+        next += interval;
+    }
+
+    double el = (double)(now_ns() - t0) / 1e9;
+    bstats_sort(&jitter_us);
+    printf("crsf_source: rate=%dHz sent=%llu errs=%llu elapsed=%.2fs "
+           "achieved=%.1f fps jitter p50=%.1fus p99=%.1fus max=%.1fus\n",
+           rate, (unsigned long long)sent, (unsigned long long)errs, el,
+           (double)sent / el, bstats_percentile(&jitter_us, 50),
+           bstats_percentile(&jitter_us, 99), bstats_percentile(&jitter_us, 100));
+    bstats_free(&jitter_us);
+    close(fd);
+    return 0;
+}
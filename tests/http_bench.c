@@ -0,0 +1,240 @@
+// HTTP load driver for autod endpoints: keep-alive GET/POST loops over N
+// connections, reporting throughput and latency percentiles. Meant to put
+// numbers on /exec round-trips, /nodes serialization cost, and the cheap
+// endpoints' ceiling so regressions show up between releases.
+//
+// Build:  gcc -O2 -Wall -Wextra -std=c11 http_bench.c -o http_bench -lpthread
+// Run:    ./http_bench [-H host] [-p port] [-u path] [-c conns] [-d secs]
+//                      [-P json_body]
+//
+// Examples:
+//   ./http_bench -p 8080 -u /health -c 4 -d 5
+//   ./http_bench -p 8080 -u /nodes -c 2 -d 5
+//   ./http_bench -p 8080 -u /exec -P '{"path":"/sys/video/get","args":["mode"]}'
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench_stats.h"
+
+static volatile sig_atomic_t g_run = 1;
+static void on_sigint(int sig) { (void)sig; g_run = 0; }
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+typedef struct {
+    const char *host;
+    int port;
+    char request[4096];
+    size_t request_len;
+    int secs;
+    // results
+    bstats_t lat_us;
+    uint64_t ok, errs, non200;
+} worker_t;
+
+static int tcp_connect(const char *host, int port) {
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &a.sin_addr) != 1) return -1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, (struct sockaddr *)&a, sizeof(a)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Read one response; returns HTTP status, 0 on connection close before a
+// response, -1 on error. Only Content-Length framing is handled, which is
+// what autod's JSON responses use.
+static int read_response(int fd, char *buf, size_t bufsz) {
+    size_t have = 0;
+    long content_len = -1;
+    size_t header_end = 0;
+    int status = -1;
+
+    for (;;) {
+        if (header_end == 0) {
+            if (have + 1 >= bufsz) return -1;
+            ssize_t n = recv(fd, buf + have, bufsz - have - 1, 0);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            if (n == 0) return have ? -1 : 0;
+            have += (size_t)n;
+            buf[have] = '\0';
+            char *eoh = strstr(buf, "\r\n\r\n");
+            if (!eoh) continue;
+            header_end = (size_t)(eoh - buf) + 4;
+            if (sscanf(buf, "HTTP/1.%*c %d", &status) != 1) return -1;
+            char *cl = strcasestr(buf, "content-length:");
+            if (cl && cl < eoh) content_len = strtol(cl + 15, NULL, 10);
+            if (content_len < 0) return -1; // unframed; treat as error
+        }
+        size_t want = header_end + (size_t)content_len;
+        if (have >= want) return status;
+        char drain[8192];
+        size_t left = want - have;
+        ssize_t n = recv(fd, drain, left < sizeof(drain) ? left : sizeof(drain), 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        if (n == 0) return -1;
+        have += (size_t)n;
+    }
+}
+
+static void *worker_main(void *arg) {
+    worker_t *w = arg;
+    char rxbuf[65536];
+    int fd = -1;
+    int64_t t_end = now_ns() + (int64_t)w->secs * 1000000000LL;
+
+    while (g_run && now_ns() < t_end) {
+        if (fd < 0) {
+            fd = tcp_connect(w->host, w->port);
+            if (fd < 0) {
+                w->errs++;
+                struct timespec ts = { 0, 50000000 };
+                nanosleep(&ts, NULL);
+                continue;
+            }
+        }
+        int64_t t0 = now_ns();
+        ssize_t sn = send(fd, w->request, w->request_len, MSG_NOSIGNAL);
+        if (sn != (ssize_t)w->request_len) {
+            close(fd);
+            fd = -1;
+            w->errs++;
+            continue;
+        }
+        int status = read_response(fd, rxbuf, sizeof(rxbuf));
+        if (status <= 0) {
+            close(fd);
+            fd = -1;
+            if (status < 0) w->errs++;
+            continue;
+        }
+        bstats_add(&w->lat_us, (double)(now_ns() - t0) / 1000.0);
+        if (status == 200) w->ok++;
+        else w->non200++;
+    }
+    if (fd >= 0) close(fd);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    const char *host = "127.0.0.1";
+    const char *path = "/health";
+    const char *post_body = NULL;
+    int port = 8080, conns = 4, secs = 5;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "H:p:u:c:d:P:")) != -1) {
+        switch (opt) {
+        case 'H': host = optarg; break;
+        case 'p': port = atoi(optarg); break;
+        case 'u': path = optarg; break;
+        case 'c': conns = atoi(optarg); break;
+        case 'd': secs = atoi(optarg); break;
+        case 'P': post_body = optarg; break;
+        default:
+            fprintf(stderr,
+                    "Usage: %s [-H host] [-p port] [-u path] [-c conns] "
+                    "[-d secs] [-P json_body]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (conns < 1) conns = 1;
+    if (conns > 64) conns = 64;
+
+    signal(SIGINT, on_sigint);
+    signal(SIGPIPE, SIG_IGN);
+
+    worker_t *workers = calloc((size_t)conns, sizeof(*workers));
+    pthread_t *tids = calloc((size_t)conns, sizeof(*tids));
+    if (!workers || !tids) return 1;
+
+    for (int i = 0; i < conns; i++) {
+        worker_t *w = &workers[i];
+        w->host = host;
+        w->port = port;
+        w->secs = secs;
+        bstats_init(&w->lat_us);
+        int n;
+        if (post_body) {
+            n = snprintf(w->request, sizeof(w->request),
+                         "POST %s HTTP/1.1\r\nHost: %s:%d\r\n"
+                         "Content-Type: application/json\r\n"
+                         "Content-Length: %zu\r\nConnection: keep-alive\r\n\r\n%s",
+                         path, host, port, strlen(post_body), post_body);
+        } else {
+            n = snprintf(w->request, sizeof(w->request),
+                         "GET %s HTTP/1.1\r\nHost: %s:%d\r\n"
+                         "Connection: keep-alive\r\n\r\n",
+                         path, host, port);
+        }
+        if (n < 0 || (size_t)n >= sizeof(w->request)) {
+            fprintf(stderr, "request too large\n");
+            return 1;
+        }
+        w->request_len = (size_t)n;
+    }
+
+    int64_t t0 = now_ns();
+    for (int i = 0; i < conns; i++) {
+        pthread_create(&tids[i], NULL, worker_main, &workers[i]);
+    }
+    for (int i = 0; i < conns; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    double el = (double)(now_ns() - t0) / 1e9;
+
+    bstats_t all;
+    bstats_init(&all);
+    uint64_t ok = 0, errs = 0, non200 = 0;
+    for (int i = 0; i < conns; i++) {
+        worker_t *w = &workers[i];
+        ok += w->ok;
+        errs += w->errs;
+        non200 += w->non200;
+        for (size_t k = 0; k < w->lat_us.n; k++) bstats_add(&all, w->lat_us.v[k]);
+        bstats_free(&w->lat_us);
+    }
+    bstats_sort(&all);
+    printf("%s %s: conns=%d ok=%llu non200=%llu errs=%llu elapsed=%.2fs "
+           "%.0f req/s lat avg=%.0fus p50=%.0fus p99=%.0fus max=%.0fus\n",
+           post_body ? "POST" : "GET", path, conns,
+           (unsigned long long)ok, (unsigned long long)non200,
+           (unsigned long long)errs, el, (double)(ok + non200) / el,
+           bstats_mean(&all), bstats_percentile(&all, 50),
+           bstats_percentile(&all, 99), bstats_percentile(&all, 100));
+    bstats_free(&all);
+    free(workers);
+    free(tids);
+    return 0;
+}
@@ -0,0 +1,42 @@
+#!/bin/sh
+# Loopback benchmark pass for `make bench`. Prints throughput and p50/p99 for
+# the UDP path, round-trip latency, and CRSF-rate pacing; benches autod's HTTP
+# endpoints too when a daemon is reachable (AUTOD_HOST/AUTOD_PORT, default
+# 127.0.0.1:8080). Absolute numbers only mean something on the target
+# hardware — the point is comparing runs across releases on the same box.
+set -u
+
+DIR=$(dirname "$0")
+SECS=${BENCH_SECS:-3}
+PORT_SINK=47910
+PORT_REFLECT=47911
+AUTOD_HOST=${AUTOD_HOST:-127.0.0.1}
+AUTOD_PORT=${AUTOD_PORT:-8080}
+
+echo "== UDP throughput (flood -> sink, ${SECS}s, 64B) =="
+"$DIR/udp_bench" sink -b 127.0.0.1 -p $PORT_SINK -d $SECS &
+SINK=$!
+sleep 0.2
+"$DIR/udp_bench" flood -H 127.0.0.1 -p $PORT_SINK -d $SECS
+wait $SINK
+
+echo "== UDP round-trip latency (latency -> reflect, ${SECS}s, 1000pps) =="
+"$DIR/udp_bench" reflect -b 127.0.0.1 -p $PORT_REFLECT &
+REFLECT=$!
+sleep 0.2
+"$DIR/udp_bench" latency -H 127.0.0.1 -p $PORT_REFLECT -r 1000 -d $SECS
+kill $REFLECT 2>/dev/null
+wait $REFLECT 2>/dev/null
+
+echo "== CRSF pacing (250Hz, ${SECS}s) =="
+"$DIR/crsf_source" -H 127.0.0.1 -p $PORT_SINK -r 250 -d $SECS
+
+echo "== autod HTTP (${AUTOD_HOST}:${AUTOD_PORT}) =="
+if "$DIR/http_bench" -H "$AUTOD_HOST" -p "$AUTOD_PORT" -u /health -c 1 -d 1 2>/dev/null | grep -q "ok=[1-9]"; then
+    "$DIR/http_bench" -H "$AUTOD_HOST" -p "$AUTOD_PORT" -u /health -c 4 -d $SECS
+    "$DIR/http_bench" -H "$AUTOD_HOST" -p "$AUTOD_PORT" -u /nodes -c 2 -d $SECS
+    "$DIR/http_bench" -H "$AUTOD_HOST" -p "$AUTOD_PORT" -u /metrics -c 1 -d $SECS
+else
+    echo "skipped: no autod reachable at ${AUTOD_HOST}:${AUTOD_PORT}"
+    echo "  (start one, or set AUTOD_HOST/AUTOD_PORT, then rerun make bench)"
+fi
@@ -0,0 +1,312 @@
+// UDP flood / latency benchmark, companion to udp_counter.c.
+// Measures the relay pps ceiling (flood -> sink) and round-trip latency
+// (latency -> reflect) with p50/p99 output.
+//
+// Build:  gcc -O2 -Wall -Wextra -std=c11 udp_bench.c -o udp_bench
+// Modes:
+//   ./udp_bench flood   -H host -p port [-s size] [-r pps] [-d secs]
+//   ./udp_bench sink    [-b bind_ip] -p port [-d secs]
+//   ./udp_bench reflect [-b bind_ip] -p port
+//   ./udp_bench latency -H host -p port [-s size] [-r pps] [-d secs]
+//
+// flood:   send datagrams as fast as allowed (-r 0 = unpaced) and report
+//          achieved tx pps/Mbps. Point it at a relay input and run sink on
+//          the relay output to get the forwarded ceiling.
+// sink:    count received datagrams for the duration, report rx pps/Mbps.
+// reflect: echo every datagram back to its sender (peer for latency mode).
+// latency: paced probes carrying seq + send timestamp; reports RTT
+//          p50/p99/max and loss against a reflect peer.
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench_stats.h"
+
+static volatile sig_atomic_t g_run = 1;
+static void on_sigint(int sig) { (void)sig; g_run = 0; }
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int udp_socket_to(const char *host, int port, struct sockaddr_in *addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &addr->sin_addr) != 1) {
+        fprintf(stderr, "bad host '%s' (IPv4 only)\n", host);
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) perror("socket");
+    return fd;
+}
+
+static int udp_socket_bound(const char *bind_ip, int port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) { perror("socket"); return -1; }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a;
+    memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET;
+    a.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, bind_ip, &a.sin_addr) != 1) {
+        fprintf(stderr, "bad bind ip '%s'\n", bind_ip);
+        close(fd);
+        return -1;
+    }
+    if (bind(fd, (struct sockaddr *)&a, sizeof(a)) < 0) {
+        perror("bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Busy-accurate pacing: absolute deadline per packet, clock_nanosleep between.
+static void pace_until(int64_t deadline_ns) {
+    struct timespec ts = {
+        .tv_sec = (time_t)(deadline_ns / 1000000000LL),
+        .tv_nsec = (long)(deadline_ns % 1000000000LL),
+    };
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static int run_flood(const char *host, int port, int size, long pps, int secs) {
+    struct sockaddr_in dst;
+    int fd = udp_socket_to(host, port, &dst);
+    if (fd < 0) return 1;
+
+    char *buf = calloc(1, (size_t)size);
+    if (!buf) return 1;
+
+    int64_t t0 = now_ns();
+    int64_t t_end = t0 + (int64_t)secs * 1000000000LL;
+    int64_t interval = pps > 0 ? 1000000000LL / pps : 0;
+    int64_t next = t0;
+    uint64_t sent = 0, errs = 0;
+
+    while (g_run && now_ns() < t_end) {
+        if (interval) {
+            pace_until(next);
+            next += interval;
+        }
+        memcpy(buf, &sent, sizeof(sent));
+        if (sendto(fd, buf, (size_t)size, 0,
+                   (struct sockaddr *)&dst, sizeof(dst)) < 0) {
+            if (errno == EINTR) continue;
+            errs++;
+            if (errno != EAGAIN && errno != ECONNREFUSED) {
+                perror("sendto");
+                break;
+            }
+        } else {
+            sent++;
+        }
+    }
+    double el = (double)(now_ns() - t0) / 1e9;
+    printf("flood: sent=%llu errs=%llu elapsed=%.2fs tx=%.0f pps %.2f Mbit/s\n",
+           (unsigned long long)sent, (unsigned long long)errs, el,
+           (double)sent / el, (double)sent * size * 8.0 / el / 1e6);
+    free(buf);
+    close(fd);
+    return 0;
+}
+
+static int run_sink(const char *bind_ip, int port, int secs) {
+    int fd = udp_socket_bound(bind_ip, port);
+    if (fd < 0) return 1;
+
+    char buf[65536];
+    uint64_t pkts = 0, bytes = 0;
+    int64_t t0 = 0;
+    int64_t t_end = 0;
+
+    while (g_run) {
+        struct pollfd pf = { .fd = fd, .events = POLLIN };
+        int64_t now = now_ns();
+        if (t0 && now >= t_end) break;
+        int tmo = t0 ? (int)((t_end - now) / 1000000LL) + 1 : 1000;
+        int pr = poll(&pf, 1, tmo);
+        if (pr < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+        if (pr == 0) continue;
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            perror("recv");
+            break;
+        }
+        if (!t0) { // clock starts at the first datagram
+            t0 = now_ns();
+            t_end = t0 + (int64_t)secs * 1000000000LL;
+        }
+        pkts++;
+        bytes += (uint64_t)n;
+    }
+    double el = t0 ? (double)(now_ns() - t0) / 1e9 : 0.0;
+    if (el <= 0) el = 1e-9;
+    printf("sink: pkts=%llu bytes=%llu elapsed=%.2fs rx=%.0f pps %.2f Mbit/s\n",
+           (unsigned long long)pkts, (unsigned long long)bytes, el,
+           (double)pkts / el, (double)bytes * 8.0 / el / 1e6);
+    close(fd);
+    return 0;
+}
+
+static int run_reflect(const char *bind_ip, int port) {
+    int fd = udp_socket_bound(bind_ip, port);
+    if (fd < 0) return 1;
+    char buf[65536];
+    while (g_run) {
+        struct sockaddr_in from;
+        socklen_t flen = sizeof(from);
+        ssize_t n = recvfrom(fd, buf, sizeof(buf), 0,
+                             (struct sockaddr *)&from, &flen);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("recvfrom");
+            break;
+        }
+        (void)sendto(fd, buf, (size_t)n, 0, (struct sockaddr *)&from, flen);
+    }
+    close(fd);
+    return 0;
+}
+
+static int run_latency(const char *host, int port, int size, long pps, int secs) {
+    struct sockaddr_in dst;
+    int fd = udp_socket_to(host, port, &dst);
+    if (fd < 0) return 1;
+    if (size < (int)(sizeof(uint64_t) + sizeof(int64_t)))
+        size = (int)(sizeof(uint64_t) + sizeof(int64_t));
+
+    char *buf = calloc(1, (size_t)size);
+    char rxbuf[65536];
+    if (!buf) return 1;
+    if (pps <= 0) pps = 1000;
+
+    bstats_t rtt;
+    bstats_init(&rtt);
+
+    int64_t t0 = now_ns();
+    int64_t t_end = t0 + (int64_t)secs * 1000000000LL;
+    int64_t interval = 1000000000LL / pps;
+    int64_t next = t0;
+    uint64_t seq = 0, got = 0;
+
+    while (g_run) {
+        int64_t now = now_ns();
+        if (now >= t_end) break;
+        if (now >= next) {
+            memcpy(buf, &seq, sizeof(seq));
+            int64_t ts = now_ns();
+            memcpy(buf + sizeof(seq), &ts, sizeof(ts));
+            if (sendto(fd, buf, (size_t)size, 0,
+                       (struct sockaddr *)&dst, sizeof(dst)) >= 0) {
+                seq++;
+            }
+            next += interval;
+            continue;
+        }
+        struct pollfd pf = { .fd = fd, .events = POLLIN };
+        int tmo = (int)((next - now) / 1000000LL);
+        int pr = poll(&pf, 1, tmo > 0 ? tmo : 0);
+        if (pr <= 0) {
+            if (pr < 0 && errno != EINTR) { perror("poll"); break; }
+            continue;
+        }
+        ssize_t n = recv(fd, rxbuf, sizeof(rxbuf), 0);
+        if (n >= (ssize_t)(sizeof(uint64_t) + sizeof(int64_t))) {
+            int64_t ts;
+            memcpy(&ts, rxbuf + sizeof(uint64_t), sizeof(ts));
+            bstats_add(&rtt, (double)(now_ns() - ts) / 1000.0);
+            got++;
+        }
+    }
+    // drain straggler replies for a short grace period
+    int64_t grace_end = now_ns() + 200000000LL;
+    while (now_ns() < grace_end) {
+        struct pollfd pf = { .fd = fd, .events = POLLIN };
+        if (poll(&pf, 1, 20) <= 0) break;
+        ssize_t n = recv(fd, rxbuf, sizeof(rxbuf), 0);
+        if (n >= (ssize_t)(sizeof(uint64_t) + sizeof(int64_t))) {
+            int64_t ts;
+            memcpy(&ts, rxbuf + sizeof(uint64_t), sizeof(ts));
+            bstats_add(&rtt, (double)(now_ns() - ts) / 1000.0);
+            got++;
+        }
+    }
+
+    bstats_sort(&rtt);
+    double loss = seq ? 100.0 * (double)(seq - got) / (double)seq : 0.0;
+    printf("latency: sent=%llu recv=%llu loss=%.2f%% "
+           "rtt avg=%.1fus p50=%.1fus p99=%.1fus max=%.1fus\n",
+           (unsigned long long)seq, (unsigned long long)got, loss,
+           bstats_mean(&rtt), bstats_percentile(&rtt, 50),
+           bstats_percentile(&rtt, 99), bstats_percentile(&rtt, 100));
+    bstats_free(&rtt);
+    free(buf);
+    close(fd);
+    return 0;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "Usage: %s flood|sink|reflect|latency [-H host] [-b bind_ip] "
+            "[-p port] [-s size] [-r pps] [-d secs]\n", argv0);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) { usage(argv[0]); return 1; }
+    const char *mode = argv[1];
+    const char *host = "127.0.0.1";
+    const char *bind_ip = "0.0.0.0";
+    int port = 14550, size = 64, secs = 5;
+    long pps = 0;
+
+    int opt;
+    optind = 2;
+    while ((opt = getopt(argc, argv, "H:b:p:s:r:d:")) != -1) {
+        switch (opt) {
+        case 'H': host = optarg; break;
+        case 'b': bind_ip = optarg; break;
+        case 'p': port = atoi(optarg); break;
+        case 's': size = atoi(optarg); break;
+        case 'r': pps = atol(optarg); break;
+        case 'd': secs = atoi(optarg); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (size < 8) size = 8;
+
+    // sigaction without SA_RESTART so a signal interrupts blocking recv/sleep
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_sigint;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    if (!strcmp(mode, "flood")) return run_flood(host, port, size, pps, secs);
+    if (!strcmp(mode, "sink")) return run_sink(bind_ip, port, secs);
+    if (!strcmp(mode, "reflect")) return run_reflect(bind_ip, port);
+    if (!strcmp(mode, "latency")) return run_latency(host, port, size, pps, secs);
+    usage(argv[0]);
+    return 1;
+}